@@ -0,0 +1,76 @@
+#ifndef ANALYZER_H
+#define ANALYZER_H
+
+#include "LogicPublicTypes.h"
+#include "AnalyzerTypes.h"
+#include "AnalyzerSettings.h"
+#include "AnalyzerResults.h"
+#include "SimulationChannelDescriptor.h"
+#include <map>
+
+class AnalyzerChannelData;
+
+//thrown out of CheckIfThreadShouldExit() once KillThread() has been requested.
+struct AnalyzerThreadKilled
+{
+};
+
+class LOGICAPI Analyzer
+{
+public:
+	Analyzer();
+	virtual ~Analyzer() = 0;
+	virtual void WorkerThread() = 0;
+
+	//sample_rate: if there are multiple devices attached, and one is faster than the other,
+	//we can sample at the speed of the faster one; and pretend the slower one is the same speed.
+	virtual U32 GenerateSimulationData( U64 newest_sample_requested, U32 sample_rate, SimulationChannelDescriptor** simulation_channels ) = 0;
+	virtual U32 GetMinimumSampleRateHz() = 0;  //provide the sample rate required to generate good simulation data
+	virtual const char* GetAnalyzerName() const = 0;
+	virtual bool NeedsRerun() = 0;
+
+	//use, but don't override:
+	void SetAnalyzerSettings( AnalyzerSettings* settings );
+	void KillThread();
+	AnalyzerChannelData* GetAnalyzerChannelData( Channel& channel );
+	void ReportProgress( U64 sample_number );
+	void SetAnalyzerResults( AnalyzerResults* results );
+	U32 GetSimulationSampleRate();
+	U32 GetSampleRate();
+	U64 GetTriggerSample();
+	void CheckIfThreadShouldExit();
+
+public: //stand-in only: what Logic would normally provide, so the analyzer can run headless.
+	void SetSampleRate( U32 sample_rate_hz );
+	void SetSimulationSampleRate( U32 sample_rate_hz );
+	void SetTriggerSample( U64 trigger_sample );
+	void SetAnalyzerChannelData( const Channel& channel, AnalyzerChannelData* channel_data );
+	AnalyzerSettings* GetAnalyzerSettings();
+	AnalyzerResults* GetAnalyzerResults();
+	U64 GetProgress();
+
+	//runs WorkerThread() on the calling thread until the channel data is exhausted.
+	void StartProcessing();
+
+protected:
+	AnalyzerSettings* mAnalyzerSettings;
+	AnalyzerResults* mAnalyzerResults;
+	std::map<Channel, AnalyzerChannelData*> mChannelData;
+	U32 mSampleRateHz;
+	U32 mSimulationSampleRateHz;
+	U64 mTriggerSample;
+	U64 mProgress;
+	bool mKillThread;
+};
+
+class LOGICAPI Analyzer2 : public Analyzer
+{
+public:
+	Analyzer2();
+	virtual void SetupResults();
+
+	//stand-in only: calls SetupResults(), then runs the worker thread.
+	void StartProcessing();
+};
+
+#endif //ANALYZER_H
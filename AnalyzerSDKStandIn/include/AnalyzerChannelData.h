@@ -0,0 +1,61 @@
+#ifndef ANALYZER_CHANNEL_DATA
+#define ANALYZER_CHANNEL_DATA
+
+#include "LogicPublicTypes.h"
+#include <vector>
+
+//thrown by the stand-in when the decoder asks for samples past the end of the capture.
+//Logic would block the worker thread here until more data arrives (or the thread is killed).
+struct AnalyzerEndOfData
+{
+};
+
+class LOGICAPI AnalyzerChannelData
+{
+public:
+	//stand-in: the channel is described by its initial state, the sample numbers of every
+	//transition (strictly increasing) and the total number of samples captured.
+	AnalyzerChannelData( BitState initial_bit_state, const std::vector<U64>& transitions, U64 num_samples );
+	~AnalyzerChannelData();
+
+	//State
+	U64 GetSampleNumber();
+	BitState GetBitState();
+
+	//Basic:
+	U32 Advance( U32 num_samples ); //move forward the specified number of samples. Returns the number of times the bit changed state during the move.
+	U32 AdvanceToAbsPosition( U64 sample_number ); //move forward to the specified sample number. Returns the number of times the bit changed state during the move.
+	void AdvanceToNextEdge(); //move forward until the bit state changes from what it is now.
+
+	//Fancier
+	U64 GetSampleOfNextEdge(); //without moving, get the sample of the next transition.
+	bool WouldAdvancingCauseTransition( U32 num_samples ); //if we advanced, would we encounter any transitions?
+	bool WouldAdvancingToAbsPositionCauseTransition( U64 sample_number ); //if we advanced, would we encounter any transitions?
+
+	//minimum pulse tracking.  The serial analyzer uses this for auto-baud
+	void TrackMinimumPulseWidth(); //normally this is not enabled.
+	U64 GetMinimumPulseWidthSoFar();
+
+	//Fancier, part II
+	bool DoMoreTransitionsExistInCurrentData(); //use this when you have a situation where you have multiple lines, and you need to handle the case where one or the other of them may never change again, and you don't know which.
+
+	//stand-in only: number of the calls above made so far, for benchmarks.
+	U64 GetNumApiCalls();
+	void ResetNumApiCalls();
+
+protected:
+	U32 MoveTo( U64 sample_number );
+
+	BitState mInitialBitState;
+	const std::vector<U64>& mTransitions;
+	U64 mNumSamples;
+
+	U64 mSampleNumber;
+	U64 mNextTransition;  //index of the first transition after mSampleNumber
+
+	bool mTrackMinimumPulseWidth;
+	U64 mMinimumPulseWidth;
+	U64 mNumApiCalls;
+};
+
+#endif //ANALYZER_CHANNEL_DATA
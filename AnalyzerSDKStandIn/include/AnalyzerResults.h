@@ -0,0 +1,102 @@
+#ifndef ANALYZER_RESULTS
+#define ANALYZER_RESULTS
+
+#include "LogicPublicTypes.h"
+#include "AnalyzerTypes.h"
+#include <map>
+#include <string>
+#include <vector>
+
+#define DISPLAY_AS_ERROR_FLAG ( 1 << 7 )
+#define DISPLAY_AS_WARNING_FLAG ( 1 << 6 )
+
+#define INVALID_RESULT_INDEX 0xFFFFFFFFFFFFFFFFull
+
+class LOGICAPI Frame
+{
+public:
+	Frame();
+	Frame( const Frame& frame );
+	~Frame();
+
+	S64 mStartingSampleInclusive;
+	S64 mEndingSampleInclusive;
+	U64 mData1;
+	U64 mData2;
+	U8 mType;
+	U8 mFlags;
+
+	bool HasFlag( U8 flag );
+};
+
+class LOGICAPI AnalyzerResults
+{
+public:
+	enum MarkerType { Dot, ErrorDot, Square, ErrorSquare, UpArrow, DownArrow, X, ErrorX, Start, Stop, One, Zero };
+	AnalyzerResults();  //you must call the base class contructor in your constructor
+	virtual ~AnalyzerResults();
+
+	//override:
+	virtual void GenerateBubbleText( U64 frame_index, Channel& channel, DisplayBase display_base ) = 0;
+	virtual void GenerateExportFile( const char* file, DisplayBase display_base, U32 export_type_user_id ) = 0;
+	virtual void GenerateFrameTabularText( U64 frame_index, DisplayBase display_base ) = 0;
+	virtual void GeneratePacketTabularText( U64 packet_id, DisplayBase display_base ) = 0;
+	virtual void GenerateTransactionTabularText( U64 transaction_id, DisplayBase display_base ) = 0;
+
+public:  //adding/setting data
+	void AddMarker( U64 sample_number, MarkerType marker_type, Channel& channel );
+
+	U64 AddFrame( const Frame& frame );
+	U64 CommitPacketAndStartNewPacket();
+	void CancelPacketAndStartNewPacket();
+	void AddPacketToTransaction( U64 transaction_id, U64 packet_id );
+	void AddChannelBubblesWillAppearOn( const Channel& channel );
+
+	void CommitResults();
+
+public:  //data access
+	U64 GetNumFrames();
+	U64 GetNumPackets();
+	Frame GetFrame( U64 frame_id );
+
+	U64 GetPacketContainingFrame( U64 frame_id );
+	U64 GetPacketContainingFrameSequential( U64 frame_id );
+	void GetFramesContainedInPacket( U64 packet_id, U64* first_frame_id, U64* last_frame_id );
+
+	U32 GetNumMarkers( Channel& channel );
+	U64 GetMarkerSampleNumber( Channel& channel, U32 index );
+	MarkerType GetMarkerType( Channel& channel, U32 index );
+
+public:  //text results setting and access:
+	void ClearResultStrings();
+	void AddResultString( const char* str1, const char* str2 = NULL, const char* str3 = NULL, const char* str4 = NULL, const char* str5 = NULL, const char* str6 = NULL );  //multiple strings will be concatenated
+
+	void ClearTabularText();
+	void AddTabularText( const char* str1, const char* str2 = NULL, const char* str3 = NULL, const char* str4 = NULL, const char* str5 = NULL, const char* str6 = NULL );
+
+	bool UpdateExportProgressAndCheckForCancel( U64 completed_frames, U64 total_frames );
+
+public:  //stand-in only: inspection of generated strings and export cancellation, for tests and benchmarks.
+	U32 GetNumResultStrings();
+	const char* GetResultString( U32 index );
+	U32 GetNumTabularStrings();
+	const char* GetTabularString( U32 index );
+	void CancelExportAfter( U64 completed_frames );
+
+protected:
+	struct Marker
+	{
+		U64 mSample;
+		MarkerType mType;
+	};
+
+	std::vector<Frame> mFrames;
+	std::vector<U64> mPacketFirstFrames;  //first frame of every committed packet
+	U64 mPacketStartFrame;
+	std::map< Channel, std::vector<Marker> > mMarkers;	//per channel, so reading them back by index is quick
+	std::vector<std::string> mResultStrings;
+	std::vector<std::string> mTabularStrings;
+	U64 mCancelExportAfter;
+};
+
+#endif //ANALYZER_RESULTS
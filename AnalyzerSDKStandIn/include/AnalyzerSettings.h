@@ -0,0 +1,78 @@
+#ifndef ANALYZER_SETTINGS
+#define ANALYZER_SETTINGS
+
+#include "LogicPublicTypes.h"
+#include "AnalyzerTypes.h"
+#include "AnalyzerSettingInterface.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+class LOGICAPI AnalyzerSettings
+{
+public:
+	AnalyzerSettings();
+	virtual ~AnalyzerSettings();
+
+	//Implement
+	virtual bool SetSettingsFromInterfaces() = 0;
+	virtual void LoadSettings( const char* settings ) = 0;
+	virtual const char* SaveSettings() = 0;
+
+	//Do not override, only used by Logic
+	U32 GetSettingsInterfacesCount();
+	AnalyzerSettingInterface* GetSettingsInterface( U32 index );
+
+	U32 GetFileExtensionCount();
+	void GetFileExtension( U32 index, char const ** extension_name, char const ** extension );
+
+	U32 GetChannelsCount();
+	Channel GetChannel( U32 index, char const ** channel_label, bool* channel_is_used );
+
+	U32 GetExportOptionsCount();
+	void GetExportOption( U32 index, U32* user_id, char const ** menu_text );
+
+	const char* GetSaveErrorMessage();
+
+protected:
+	//Use, but don't override/implement
+	void ClearChannels();
+	void AddChannel( Channel& channel, const char* channel_label, bool is_used );
+
+	void SetErrorText( const char* error_text );
+	void AddInterface( AnalyzerSettingInterface* analyzer_setting_interface );
+
+	void AddExportOption( U32 user_id, const char* menu_text );
+	void AddExportExtension( U32 user_id, const char * extension_name, const char * extension );
+
+	const char* SetReturnString( const char* str );
+
+	struct ChannelEntry
+	{
+		Channel mChannel;
+		std::string mLabel;
+		bool mIsUsed;
+	};
+
+	struct ExportOption
+	{
+		U32 mUserId;
+		std::string mMenuText;
+	};
+
+	struct ExportExtension
+	{
+		U32 mUserId;
+		std::string mName;
+		std::string mExtension;
+	};
+
+	std::vector<AnalyzerSettingInterface*> mInterfaces;
+	std::vector<ChannelEntry> mChannels;
+	std::vector<ExportOption> mExportOptions;
+	std::vector<ExportExtension> mExportExtensions;
+	std::string mErrorText;
+	std::string mReturnString;
+};
+
+#endif //ANALYZER_SETTINGS
@@ -0,0 +1,36 @@
+#ifndef ANALYZER_TYPES
+#define ANALYZER_TYPES
+
+#include "LogicPublicTypes.h"
+
+class LOGICAPI Channel
+{
+public:
+	Channel();
+	Channel( const Channel& channel );
+	Channel( U64 device_id, U32 channel_index );
+	~Channel();
+
+	Channel& operator=( const Channel& channel );
+	bool operator==( const Channel& channel ) const;
+	bool operator!=( const Channel& channel ) const;
+	bool operator>( const Channel& channel ) const;
+	bool operator<( const Channel& channel ) const;
+
+	U64 mDeviceId;
+	U32 mChannelIndex;
+};
+
+#define UNDEFINED_CHANNEL Channel( 0xFFFFFFFFFFFFFFFFull, 0xFFFFFFFF )
+
+namespace AnalyzerEnums
+{
+	enum ShiftOrder { MsbFirst, LsbFirst };
+	enum EdgeDirection { PosEdge, NegEdge };
+	enum Edge { LeadingEdge, TrailingEdge };
+	enum Parity { None, Even, Odd };
+	enum Acknowledge { Ack, Nak };
+	enum Sign { UnsignedInteger, SignedInteger };
+};
+
+#endif //ANALYZER_TYPES
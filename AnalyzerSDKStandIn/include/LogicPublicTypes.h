@@ -0,0 +1,35 @@
+#ifndef LOGIC_PUBLIC_TYPES
+#define LOGIC_PUBLIC_TYPES
+
+// In-tree stand-in for the Saleae Analyzer SDK, for building and running the analyzer without
+// the vendor library (see build_analyzer.py).  Only the part of the API the analyzer in /source
+// uses is there, backed by in-memory edge arrays; it is not a plugin Logic can load.
+
+#ifdef WIN32
+	#define LOGICAPI
+	#define ANALYZER_EXPORT __declspec(dllexport)
+#else
+	#define LOGICAPI
+	#define ANALYZER_EXPORT __attribute__ ((visibility("default")))
+	#define __cdecl
+	#define __stdcall
+	#define __fastcall
+#endif
+
+typedef signed char S8;
+typedef short S16;
+typedef int S32;
+typedef long long int S64;
+
+typedef unsigned char U8;
+typedef unsigned short U16;
+typedef unsigned int U32;
+typedef unsigned long long int U64;
+
+enum DisplayBase { Binary, Decimal, Hexadecimal, ASCII, AsciiHex };
+enum BitState { BIT_LOW, BIT_HIGH };
+
+#define Toggle(x) ( x == BIT_LOW ? BIT_HIGH : BIT_LOW )
+#define Invert(x) ( x == BIT_LOW ? BIT_HIGH : BIT_LOW )
+
+#endif //LOGIC_PUBLIC_TYPES
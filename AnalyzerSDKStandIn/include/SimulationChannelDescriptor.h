@@ -0,0 +1,44 @@
+#ifndef SIMULATION_CHANNEL_DESCRIPTOR
+#define SIMULATION_CHANNEL_DESCRIPTOR
+
+#include "LogicPublicTypes.h"
+#include "AnalyzerTypes.h"
+#include <vector>
+
+class LOGICAPI SimulationChannelDescriptor
+{
+public:
+	void Transition();
+	void TransitionIfNeeded( BitState bit_state );
+	void Advance( U32 num_samples_to_advance );
+
+	BitState GetCurrentBitState();
+	U64 GetCurrentSampleNumber();
+
+public: //don't use
+	SimulationChannelDescriptor();
+	SimulationChannelDescriptor( const SimulationChannelDescriptor& other );
+	~SimulationChannelDescriptor();
+	SimulationChannelDescriptor& operator=( const SimulationChannelDescriptor& other );
+
+	void SetChannel( Channel& channel );
+	void SetSampleRate( U32 sample_rate_hz );
+	void SetInitialBitState( BitState intial_bit_state );
+
+	Channel GetChannel();
+	U32 GetSampleRate();
+	BitState GetInitialBitState();
+
+public: //stand-in only: the edges written so far, to feed an AnalyzerChannelData.
+	const std::vector<U64>& GetTransitions();
+
+protected:
+	Channel mChannel;
+	U32 mSampleRateHz;
+	BitState mInitialBitState;
+	BitState mCurrentBitState;
+	U64 mCurrentSampleNumber;
+	std::vector<U64> mTransitions;
+};
+
+#endif //SIMULATION_CHANNEL_DESCRIPTOR
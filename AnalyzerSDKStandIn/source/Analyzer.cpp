@@ -0,0 +1,132 @@
+#include "Analyzer.h"
+#include "AnalyzerChannelData.h"
+
+Analyzer::Analyzer()
+:	mAnalyzerSettings( NULL ),
+	mAnalyzerResults( NULL ),
+	mSampleRateHz( 0 ),
+	mSimulationSampleRateHz( 0 ),
+	mTriggerSample( 0 ),
+	mProgress( 0 ),
+	mKillThread( false )
+{
+}
+
+Analyzer::~Analyzer()
+{
+}
+
+void Analyzer::SetAnalyzerSettings( AnalyzerSettings* settings )
+{
+	mAnalyzerSettings = settings;
+}
+
+void Analyzer::KillThread()
+{
+	mKillThread = true;
+}
+
+AnalyzerChannelData* Analyzer::GetAnalyzerChannelData( Channel& channel )
+{
+	std::map<Channel, AnalyzerChannelData*>::iterator it = mChannelData.find( channel );
+	if( it == mChannelData.end() )
+		return NULL;
+	return it->second;
+}
+
+void Analyzer::ReportProgress( U64 sample_number )
+{
+	mProgress = sample_number;
+}
+
+void Analyzer::SetAnalyzerResults( AnalyzerResults* results )
+{
+	mAnalyzerResults = results;
+}
+
+U32 Analyzer::GetSimulationSampleRate()
+{
+	return mSimulationSampleRateHz;
+}
+
+U32 Analyzer::GetSampleRate()
+{
+	return mSampleRateHz;
+}
+
+U64 Analyzer::GetTriggerSample()
+{
+	return mTriggerSample;
+}
+
+void Analyzer::CheckIfThreadShouldExit()
+{
+	if( mKillThread == true )
+		throw AnalyzerThreadKilled();
+}
+
+void Analyzer::SetSampleRate( U32 sample_rate_hz )
+{
+	mSampleRateHz = sample_rate_hz;
+}
+
+void Analyzer::SetSimulationSampleRate( U32 sample_rate_hz )
+{
+	mSimulationSampleRateHz = sample_rate_hz;
+}
+
+void Analyzer::SetTriggerSample( U64 trigger_sample )
+{
+	mTriggerSample = trigger_sample;
+}
+
+void Analyzer::SetAnalyzerChannelData( const Channel& channel, AnalyzerChannelData* channel_data )
+{
+	mChannelData[ channel ] = channel_data;
+}
+
+AnalyzerSettings* Analyzer::GetAnalyzerSettings()
+{
+	return mAnalyzerSettings;
+}
+
+AnalyzerResults* Analyzer::GetAnalyzerResults()
+{
+	return mAnalyzerResults;
+}
+
+U64 Analyzer::GetProgress()
+{
+	return mProgress;
+}
+
+void Analyzer::StartProcessing()
+{
+	mKillThread = false;
+
+	try
+	{
+		WorkerThread();
+	}
+	catch( AnalyzerEndOfData& )
+	{
+	}
+	catch( AnalyzerThreadKilled& )
+	{
+	}
+}
+
+Analyzer2::Analyzer2()
+:	Analyzer()
+{
+}
+
+void Analyzer2::SetupResults()
+{
+}
+
+void Analyzer2::StartProcessing()
+{
+	SetupResults();
+	Analyzer::StartProcessing();
+}
@@ -0,0 +1,149 @@
+#include "AnalyzerChannelData.h"
+#include <algorithm>
+
+AnalyzerChannelData::AnalyzerChannelData( BitState initial_bit_state, const std::vector<U64>& transitions, U64 num_samples )
+:	mInitialBitState( initial_bit_state ),
+	mTransitions( transitions ),
+	mNumSamples( num_samples ),
+	mSampleNumber( 0 ),
+	mNextTransition( 0 ),
+	mTrackMinimumPulseWidth( false ),
+	mMinimumPulseWidth( 0 ),
+	mNumApiCalls( 0 )
+{
+	//a transition at sample 0 just changes the initial state.
+	while( mNextTransition < mTransitions.size() && mTransitions[ mNextTransition ] == 0 )
+		mNextTransition++;
+}
+
+AnalyzerChannelData::~AnalyzerChannelData()
+{
+}
+
+U64 AnalyzerChannelData::GetSampleNumber()
+{
+	mNumApiCalls++;
+	return mSampleNumber;
+}
+
+BitState AnalyzerChannelData::GetBitState()
+{
+	mNumApiCalls++;
+	if( ( mNextTransition & 1 ) == 0 )
+		return mInitialBitState;
+	return Invert( mInitialBitState );
+}
+
+U32 AnalyzerChannelData::Advance( U32 num_samples )
+{
+	mNumApiCalls++;
+	return MoveTo( mSampleNumber + num_samples );
+}
+
+U32 AnalyzerChannelData::AdvanceToAbsPosition( U64 sample_number )
+{
+	mNumApiCalls++;
+	if( sample_number < mSampleNumber )
+		return 0;
+	return MoveTo( sample_number );
+}
+
+void AnalyzerChannelData::AdvanceToNextEdge()
+{
+	mNumApiCalls++;
+	if( mNextTransition >= mTransitions.size() )
+		throw AnalyzerEndOfData();
+	MoveTo( mTransitions[ mNextTransition ] );
+}
+
+U64 AnalyzerChannelData::GetSampleOfNextEdge()
+{
+	mNumApiCalls++;
+	if( mNextTransition >= mTransitions.size() )
+		throw AnalyzerEndOfData();
+	return mTransitions[ mNextTransition ];
+}
+
+bool AnalyzerChannelData::WouldAdvancingCauseTransition( U32 num_samples )
+{
+	mNumApiCalls++;
+	U64 target = mSampleNumber + num_samples;
+	if( mNextTransition < mTransitions.size() && mTransitions[ mNextTransition ] <= target )
+		return true;
+	if( target >= mNumSamples )
+		throw AnalyzerEndOfData();
+	return false;
+}
+
+bool AnalyzerChannelData::WouldAdvancingToAbsPositionCauseTransition( U64 sample_number )
+{
+	mNumApiCalls++;
+	if( mNextTransition < mTransitions.size() && mTransitions[ mNextTransition ] <= sample_number )
+		return true;
+	if( sample_number >= mNumSamples )
+		throw AnalyzerEndOfData();
+	return false;
+}
+
+void AnalyzerChannelData::TrackMinimumPulseWidth()
+{
+	mNumApiCalls++;
+	mTrackMinimumPulseWidth = true;
+}
+
+U64 AnalyzerChannelData::GetMinimumPulseWidthSoFar()
+{
+	mNumApiCalls++;
+	return mMinimumPulseWidth;
+}
+
+bool AnalyzerChannelData::DoMoreTransitionsExistInCurrentData()
+{
+	mNumApiCalls++;
+	return mNextTransition < mTransitions.size();
+}
+
+U64 AnalyzerChannelData::GetNumApiCalls()
+{
+	return mNumApiCalls;
+}
+
+void AnalyzerChannelData::ResetNumApiCalls()
+{
+	mNumApiCalls = 0;
+}
+
+U32 AnalyzerChannelData::MoveTo( U64 sample_number )
+{
+	if( sample_number >= mNumSamples )
+		throw AnalyzerEndOfData();
+
+	U64 first = mNextTransition;
+	U64 count = mTransitions.size();
+
+	//short hops are the common case; fall back to a binary search for long ones.
+	U32 steps = 0;
+	while( mNextTransition < count && mTransitions[ mNextTransition ] <= sample_number && steps < 8 )
+	{
+		mNextTransition++;
+		steps++;
+	}
+
+	if( mNextTransition < count && mTransitions[ mNextTransition ] <= sample_number )
+		mNextTransition = std::upper_bound( mTransitions.begin() + mNextTransition, mTransitions.end(), sample_number ) - mTransitions.begin();
+
+	if( mTrackMinimumPulseWidth == true )
+	{
+		for( U64 i = first; i < mNextTransition; i++ )
+		{
+			if( i == 0 )
+				continue;
+			U64 width = mTransitions[ i ] - mTransitions[ i - 1 ];
+			if( mMinimumPulseWidth == 0 || width < mMinimumPulseWidth )
+				mMinimumPulseWidth = width;
+		}
+	}
+
+	mSampleNumber = sample_number;
+	return U32( mNextTransition - first );
+}
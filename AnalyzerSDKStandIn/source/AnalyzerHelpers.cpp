@@ -0,0 +1,403 @@
+#include "AnalyzerHelpers.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdexcept>
+
+bool AnalyzerHelpers::IsEven( U64 value )
+{
+	return ( value & 1 ) == 0;
+}
+
+bool AnalyzerHelpers::IsOdd( U64 value )
+{
+	return ( value & 1 ) != 0;
+}
+
+U32 AnalyzerHelpers::GetOnesCount( U64 value )
+{
+	U32 count = 0;
+	while( value != 0 )
+	{
+		value &= value - 1;
+		count++;
+	}
+	return count;
+}
+
+U32 AnalyzerHelpers::Diff32( U32 a, U32 b )
+{
+	if( a > b )
+		return a - b;
+	return b - a;
+}
+
+void AnalyzerHelpers::GetNumberString( U64 number, DisplayBase display_base, U32 num_data_bits, char* result_string, U32 result_string_max_length )
+{
+	if( num_data_bits == 0 || num_data_bits > 64 )
+		num_data_bits = 64;
+	if( num_data_bits < 64 )
+		number &= ( 1ull << num_data_bits ) - 1;
+
+	char buffer[ 128 ];
+	switch( display_base )
+	{
+	case Binary:
+	{
+		char* p = buffer;
+		*p++ = '0';
+		*p++ = 'b';
+		for( S32 i = num_data_bits - 1; i >= 0; i-- )
+		{
+			*p++ = ( ( number >> i ) & 1 ) ? '1' : '0';
+			if( i != 0 && ( i % 4 ) == 0 )
+				*p++ = ' ';
+		}
+		*p = 0;
+	}
+	break;
+	case Decimal:
+		snprintf( buffer, sizeof( buffer ), "%llu", number );
+		break;
+	case ASCII:
+		if( number >= 0x20 && number < 0x7F )
+			snprintf( buffer, sizeof( buffer ), "%c", char( number ) );
+		else
+			snprintf( buffer, sizeof( buffer ), "'%llu'", number );
+		break;
+	case AsciiHex:
+		if( number >= 0x20 && number < 0x7F )
+			snprintf( buffer, sizeof( buffer ), "'%c' (0x%0*llX)", char( number ), int( ( num_data_bits + 3 ) / 4 ), number );
+		else
+			snprintf( buffer, sizeof( buffer ), "0x%0*llX", int( ( num_data_bits + 3 ) / 4 ), number );
+		break;
+	case Hexadecimal:
+	default:
+		snprintf( buffer, sizeof( buffer ), "0x%0*llX", int( ( num_data_bits + 3 ) / 4 ), number );
+		break;
+	}
+
+	strncpy( result_string, buffer, result_string_max_length );
+	result_string[ result_string_max_length - 1 ] = 0;
+}
+
+void AnalyzerHelpers::GetTimeString( U64 sample, U64 trigger_sample, U32 sample_rate_hz, char* result_string, U32 result_string_max_length )
+{
+	double time_s = ( double( S64( sample ) - S64( trigger_sample ) ) ) / double( sample_rate_hz );
+	snprintf( result_string, result_string_max_length, "%.9f", time_s );
+}
+
+void AnalyzerHelpers::Assert( const char* message )
+{
+	throw std::runtime_error( message );
+}
+
+U64 AnalyzerHelpers::AdjustSimulationTargetSample( U64 target_sample, U32 sample_rate, U32 simulation_sample_rate )
+{
+	if( sample_rate == simulation_sample_rate )
+		return target_sample;
+	return U64( double( target_sample ) * double( simulation_sample_rate ) / double( sample_rate ) );
+}
+
+bool AnalyzerHelpers::DoChannelsOverlap( const Channel* channel_array, U32 num_channels )
+{
+	for( U32 i = 0; i < num_channels; i++ )
+		for( U32 j = i + 1; j < num_channels; j++ )
+			if( channel_array[ i ] == channel_array[ j ] )
+				return true;
+	return false;
+}
+
+void AnalyzerHelpers::SaveFile( const char* file_name, const U8* data, U32 data_length, bool is_binary )
+{
+	void* f = StartFile( file_name, is_binary );
+	AppendToFile( data, data_length, f );
+	EndFile( f );
+}
+
+S64 AnalyzerHelpers::ConvertToSignedNumber( U64 number, U32 num_bits )
+{
+	if( num_bits == 0 || num_bits >= 64 )
+		return S64( number );
+	U64 sign = 1ull << ( num_bits - 1 );
+	if( ( number & sign ) == 0 )
+		return S64( number );
+	return S64( number | ~( ( 1ull << num_bits ) - 1 ) );
+}
+
+void* AnalyzerHelpers::StartFile( const char* file_name, bool is_binary )
+{
+	FILE* f = fopen( file_name, is_binary ? "wb" : "w" );
+	if( f == NULL )
+		Assert( "unable to open export file" );
+	return f;
+}
+
+void AnalyzerHelpers::AppendToFile( const U8* data, U32 data_length, void* file )
+{
+	fwrite( data, 1, data_length, ( FILE* )file );
+}
+
+void AnalyzerHelpers::EndFile( void* file )
+{
+	fclose( ( FILE* )file );
+}
+
+ClockGenerator::ClockGenerator()
+:	mSamplesPerHalfPeriod( 1.0 ),
+	mSampleRateHz( 1.0 ),
+	mSamplesBehind( 0.0 )
+{
+}
+
+ClockGenerator::~ClockGenerator()
+{
+}
+
+//like the SDK, a "half period" is one period of target_frequency; a clock generated with
+//AdvanceByHalfPeriod() between transitions therefore toggles at target_frequency.
+void ClockGenerator::Init( double target_frequency, U32 sample_rate_hz )
+{
+	mSampleRateHz = double( sample_rate_hz );
+	mSamplesPerHalfPeriod = mSampleRateHz / target_frequency;
+	mSamplesBehind = 0.0;
+}
+
+U32 ClockGenerator::AdvanceByHalfPeriod( double multiple )
+{
+	double samples = mSamplesPerHalfPeriod * multiple + mSamplesBehind;
+	U32 whole_samples = U32( samples );
+	mSamplesBehind = samples - double( whole_samples );
+	return whole_samples;
+}
+
+U32 ClockGenerator::AdvanceByTimeS( double time_s )
+{
+	double samples = mSampleRateHz * time_s + mSamplesBehind;
+	U32 whole_samples = U32( samples );
+	mSamplesBehind = samples - double( whole_samples );
+	return whole_samples;
+}
+
+BitExtractor::BitExtractor( U64 data, AnalyzerEnums::ShiftOrder shift_order, U32 num_bits )
+:	mData( data ),
+	mShiftOrder( shift_order )
+{
+	if( shift_order == AnalyzerEnums::MsbFirst )
+		mMask = 1ull << ( num_bits - 1 );
+	else
+		mMask = 1;
+}
+
+BitExtractor::~BitExtractor()
+{
+}
+
+BitState BitExtractor::GetNextBit()
+{
+	BitState bit = ( mData & mMask ) != 0 ? BIT_HIGH : BIT_LOW;
+	if( mShiftOrder == AnalyzerEnums::MsbFirst )
+		mMask >>= 1;
+	else
+		mMask <<= 1;
+	return bit;
+}
+
+DataBuilder::DataBuilder()
+:	mData( NULL ),
+	mMask( 0 ),
+	mShiftOrder( AnalyzerEnums::MsbFirst )
+{
+}
+
+DataBuilder::~DataBuilder()
+{
+}
+
+void DataBuilder::Reset( U64* data, AnalyzerEnums::ShiftOrder shift_order, U32 num_bits )
+{
+	mData = data;
+	mShiftOrder = shift_order;
+	*mData = 0;
+	if( shift_order == AnalyzerEnums::MsbFirst )
+		mMask = 1ull << ( num_bits - 1 );
+	else
+		mMask = 1;
+}
+
+void DataBuilder::AddBit( BitState bit )
+{
+	if( bit == BIT_HIGH )
+		*mData |= mMask;
+	if( mShiftOrder == AnalyzerEnums::MsbFirst )
+		mMask >>= 1;
+	else
+		mMask <<= 1;
+}
+
+SimpleArchive::SimpleArchive()
+:	mReadPosition( 0 )
+{
+}
+
+SimpleArchive::~SimpleArchive()
+{
+}
+
+void SimpleArchive::SetString( const char* archive_string )
+{
+	mString = archive_string;
+	mReadPosition = 0;
+}
+
+const char* SimpleArchive::GetString()
+{
+	return mString.c_str();
+}
+
+bool SimpleArchive::NextToken( std::string& token )
+{
+	while( mReadPosition < mString.size() && mString[ mReadPosition ] == ' ' )
+		mReadPosition++;
+	if( mReadPosition >= mString.size() )
+		return false;
+
+	U64 end = mString.find( ' ', mReadPosition );
+	if( end == std::string::npos )
+		end = mString.size();
+	token = mString.substr( mReadPosition, end - mReadPosition );
+	mReadPosition = end;
+	return true;
+}
+
+static void AppendToken( std::string& archive, const std::string& token )
+{
+	if( archive.empty() == false )
+		archive += ' ';
+	archive += token;
+}
+
+bool SimpleArchive::operator<<( U64 data )
+{
+	AppendToken( mString, std::to_string( data ) );
+	return true;
+}
+
+bool SimpleArchive::operator<<( U32 data )
+{
+	AppendToken( mString, std::to_string( data ) );
+	return true;
+}
+
+bool SimpleArchive::operator<<( S64 data )
+{
+	AppendToken( mString, std::to_string( data ) );
+	return true;
+}
+
+bool SimpleArchive::operator<<( S32 data )
+{
+	AppendToken( mString, std::to_string( data ) );
+	return true;
+}
+
+bool SimpleArchive::operator<<( double data )
+{
+	char buffer[ 64 ];
+	snprintf( buffer, sizeof( buffer ), "%.17g", data );
+	AppendToken( mString, buffer );
+	return true;
+}
+
+bool SimpleArchive::operator<<( bool data )
+{
+	AppendToken( mString, data ? "1" : "0" );
+	return true;
+}
+
+bool SimpleArchive::operator<<( const char* data )
+{
+	AppendToken( mString, data );
+	return true;
+}
+
+bool SimpleArchive::operator<<( Channel& data )
+{
+	AppendToken( mString, std::to_string( data.mDeviceId ) );
+	AppendToken( mString, std::to_string( data.mChannelIndex ) );
+	return true;
+}
+
+bool SimpleArchive::operator>>( U64& data )
+{
+	std::string token;
+	if( NextToken( token ) == false )
+		return false;
+	data = strtoull( token.c_str(), NULL, 10 );
+	return true;
+}
+
+bool SimpleArchive::operator>>( U32& data )
+{
+	std::string token;
+	if( NextToken( token ) == false )
+		return false;
+	data = U32( strtoul( token.c_str(), NULL, 10 ) );
+	return true;
+}
+
+bool SimpleArchive::operator>>( S64& data )
+{
+	std::string token;
+	if( NextToken( token ) == false )
+		return false;
+	data = strtoll( token.c_str(), NULL, 10 );
+	return true;
+}
+
+bool SimpleArchive::operator>>( S32& data )
+{
+	std::string token;
+	if( NextToken( token ) == false )
+		return false;
+	data = S32( strtol( token.c_str(), NULL, 10 ) );
+	return true;
+}
+
+bool SimpleArchive::operator>>( double& data )
+{
+	std::string token;
+	if( NextToken( token ) == false )
+		return false;
+	data = strtod( token.c_str(), NULL );
+	return true;
+}
+
+bool SimpleArchive::operator>>( bool& data )
+{
+	std::string token;
+	if( NextToken( token ) == false )
+		return false;
+	data = token != "0";
+	return true;
+}
+
+bool SimpleArchive::operator>>( char const ** data )
+{
+	if( NextToken( mStringStorage ) == false )
+		return false;
+	*data = mStringStorage.c_str();
+	return true;
+}
+
+bool SimpleArchive::operator>>( Channel& data )
+{
+	U64 device_id;
+	U32 channel_index;
+	if( ( *this >> device_id ) == false )
+		return false;
+	if( ( *this >> channel_index ) == false )
+		return false;
+	data = Channel( device_id, channel_index );
+	return true;
+}
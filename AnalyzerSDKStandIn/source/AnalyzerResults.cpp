@@ -0,0 +1,214 @@
+#include "AnalyzerResults.h"
+#include <algorithm>
+
+Frame::Frame()
+:	mStartingSampleInclusive( 0 ),
+	mEndingSampleInclusive( 0 ),
+	mData1( 0 ),
+	mData2( 0 ),
+	mType( 0 ),
+	mFlags( 0 )
+{
+}
+
+Frame::Frame( const Frame& frame )
+:	mStartingSampleInclusive( frame.mStartingSampleInclusive ),
+	mEndingSampleInclusive( frame.mEndingSampleInclusive ),
+	mData1( frame.mData1 ),
+	mData2( frame.mData2 ),
+	mType( frame.mType ),
+	mFlags( frame.mFlags )
+{
+}
+
+Frame::~Frame()
+{
+}
+
+bool Frame::HasFlag( U8 flag )
+{
+	return ( mFlags & flag ) != 0;
+}
+
+AnalyzerResults::AnalyzerResults()
+:	mPacketStartFrame( 0 ),
+	mCancelExportAfter( INVALID_RESULT_INDEX )
+{
+}
+
+AnalyzerResults::~AnalyzerResults()
+{
+}
+
+void AnalyzerResults::AddMarker( U64 sample_number, MarkerType marker_type, Channel& channel )
+{
+	Marker marker;
+	marker.mSample = sample_number;
+	marker.mType = marker_type;
+	mMarkers[ channel ].push_back( marker );
+}
+
+U64 AnalyzerResults::AddFrame( const Frame& frame )
+{
+	mFrames.push_back( frame );
+	return mFrames.size() - 1;
+}
+
+U64 AnalyzerResults::CommitPacketAndStartNewPacket()
+{
+	if( mPacketStartFrame == mFrames.size() )
+		return INVALID_RESULT_INDEX;
+
+	mPacketFirstFrames.push_back( mPacketStartFrame );
+	mPacketStartFrame = mFrames.size();
+	return mPacketFirstFrames.size() - 1;
+}
+
+void AnalyzerResults::CancelPacketAndStartNewPacket()
+{
+	mPacketStartFrame = mFrames.size();
+}
+
+void AnalyzerResults::AddPacketToTransaction( U64 transaction_id, U64 packet_id )
+{
+}
+
+void AnalyzerResults::AddChannelBubblesWillAppearOn( const Channel& channel )
+{
+}
+
+void AnalyzerResults::CommitResults()
+{
+}
+
+U64 AnalyzerResults::GetNumFrames()
+{
+	return mFrames.size();
+}
+
+U64 AnalyzerResults::GetNumPackets()
+{
+	return mPacketFirstFrames.size();
+}
+
+Frame AnalyzerResults::GetFrame( U64 frame_id )
+{
+	return mFrames[ frame_id ];
+}
+
+U64 AnalyzerResults::GetPacketContainingFrame( U64 frame_id )
+{
+	if( frame_id >= mFrames.size() || mPacketFirstFrames.empty() == true )
+		return INVALID_RESULT_INDEX;
+
+	std::vector<U64>::iterator it = std::upper_bound( mPacketFirstFrames.begin(), mPacketFirstFrames.end(), frame_id );
+	if( it == mPacketFirstFrames.begin() )
+		return INVALID_RESULT_INDEX;
+
+	U64 packet_id = ( it - mPacketFirstFrames.begin() ) - 1;
+	U64 first_frame_id;
+	U64 last_frame_id;
+	GetFramesContainedInPacket( packet_id, &first_frame_id, &last_frame_id );
+	if( frame_id > last_frame_id )
+		return INVALID_RESULT_INDEX;
+
+	return packet_id;
+}
+
+U64 AnalyzerResults::GetPacketContainingFrameSequential( U64 frame_id )
+{
+	return GetPacketContainingFrame( frame_id );
+}
+
+void AnalyzerResults::GetFramesContainedInPacket( U64 packet_id, U64* first_frame_id, U64* last_frame_id )
+{
+	*first_frame_id = mPacketFirstFrames[ packet_id ];
+	if( packet_id + 1 < mPacketFirstFrames.size() )
+		*last_frame_id = mPacketFirstFrames[ packet_id + 1 ] - 1;
+	else
+		*last_frame_id = mPacketStartFrame - 1;
+}
+
+U32 AnalyzerResults::GetNumMarkers( Channel& channel )
+{
+	std::map< Channel, std::vector<Marker> >::iterator markers = mMarkers.find( channel );
+	if( markers == mMarkers.end() )
+		return 0;
+	return U32( markers->second.size() );
+}
+
+U64 AnalyzerResults::GetMarkerSampleNumber( Channel& channel, U32 index )
+{
+	std::map< Channel, std::vector<Marker> >::iterator markers = mMarkers.find( channel );
+	if( ( markers == mMarkers.end() ) || ( index >= markers->second.size() ) )
+		return INVALID_RESULT_INDEX;
+	return markers->second[ index ].mSample;
+}
+
+AnalyzerResults::MarkerType AnalyzerResults::GetMarkerType( Channel& channel, U32 index )
+{
+	std::map< Channel, std::vector<Marker> >::iterator markers = mMarkers.find( channel );
+	if( ( markers == mMarkers.end() ) || ( index >= markers->second.size() ) )
+		return Dot;
+	return markers->second[ index ].mType;
+}
+
+void AnalyzerResults::ClearResultStrings()
+{
+	mResultStrings.clear();
+}
+
+static std::string Concatenate( const char* str1, const char* str2, const char* str3, const char* str4, const char* str5, const char* str6 )
+{
+	std::string result( str1 );
+	const char* rest[] = { str2, str3, str4, str5, str6 };
+	for( U32 i = 0; i < 5; i++ )
+		if( rest[ i ] != NULL )
+			result += rest[ i ];
+	return result;
+}
+
+void AnalyzerResults::AddResultString( const char* str1, const char* str2, const char* str3, const char* str4, const char* str5, const char* str6 )
+{
+	mResultStrings.push_back( Concatenate( str1, str2, str3, str4, str5, str6 ) );
+}
+
+void AnalyzerResults::ClearTabularText()
+{
+	mTabularStrings.clear();
+}
+
+void AnalyzerResults::AddTabularText( const char* str1, const char* str2, const char* str3, const char* str4, const char* str5, const char* str6 )
+{
+	mTabularStrings.push_back( Concatenate( str1, str2, str3, str4, str5, str6 ) );
+}
+
+bool AnalyzerResults::UpdateExportProgressAndCheckForCancel( U64 completed_frames, U64 total_frames )
+{
+	return completed_frames >= mCancelExportAfter;
+}
+
+U32 AnalyzerResults::GetNumResultStrings()
+{
+	return mResultStrings.size();
+}
+
+const char* AnalyzerResults::GetResultString( U32 index )
+{
+	return mResultStrings[ index ].c_str();
+}
+
+U32 AnalyzerResults::GetNumTabularStrings()
+{
+	return mTabularStrings.size();
+}
+
+const char* AnalyzerResults::GetTabularString( U32 index )
+{
+	return mTabularStrings[ index ].c_str();
+}
+
+void AnalyzerResults::CancelExportAfter( U64 completed_frames )
+{
+	mCancelExportAfter = completed_frames;
+}
@@ -0,0 +1,102 @@
+#include "SimulationChannelDescriptor.h"
+
+SimulationChannelDescriptor::SimulationChannelDescriptor()
+:	mSampleRateHz( 0 ),
+	mInitialBitState( BIT_LOW ),
+	mCurrentBitState( BIT_LOW ),
+	mCurrentSampleNumber( 0 )
+{
+}
+
+SimulationChannelDescriptor::SimulationChannelDescriptor( const SimulationChannelDescriptor& other )
+:	mChannel( other.mChannel ),
+	mSampleRateHz( other.mSampleRateHz ),
+	mInitialBitState( other.mInitialBitState ),
+	mCurrentBitState( other.mCurrentBitState ),
+	mCurrentSampleNumber( other.mCurrentSampleNumber ),
+	mTransitions( other.mTransitions )
+{
+}
+
+SimulationChannelDescriptor::~SimulationChannelDescriptor()
+{
+}
+
+SimulationChannelDescriptor& SimulationChannelDescriptor::operator=( const SimulationChannelDescriptor& other )
+{
+	mChannel = other.mChannel;
+	mSampleRateHz = other.mSampleRateHz;
+	mInitialBitState = other.mInitialBitState;
+	mCurrentBitState = other.mCurrentBitState;
+	mCurrentSampleNumber = other.mCurrentSampleNumber;
+	mTransitions = other.mTransitions;
+	return *this;
+}
+
+void SimulationChannelDescriptor::Transition()
+{
+	mCurrentBitState = Invert( mCurrentBitState );
+
+	//two transitions on the same sample cancel out.
+	if( mTransitions.empty() == false && mTransitions.back() == mCurrentSampleNumber )
+		mTransitions.pop_back();
+	else
+		mTransitions.push_back( mCurrentSampleNumber );
+}
+
+void SimulationChannelDescriptor::TransitionIfNeeded( BitState bit_state )
+{
+	if( mCurrentBitState != bit_state )
+		Transition();
+}
+
+void SimulationChannelDescriptor::Advance( U32 num_samples_to_advance )
+{
+	mCurrentSampleNumber += num_samples_to_advance;
+}
+
+BitState SimulationChannelDescriptor::GetCurrentBitState()
+{
+	return mCurrentBitState;
+}
+
+U64 SimulationChannelDescriptor::GetCurrentSampleNumber()
+{
+	return mCurrentSampleNumber;
+}
+
+void SimulationChannelDescriptor::SetChannel( Channel& channel )
+{
+	mChannel = channel;
+}
+
+void SimulationChannelDescriptor::SetSampleRate( U32 sample_rate_hz )
+{
+	mSampleRateHz = sample_rate_hz;
+}
+
+void SimulationChannelDescriptor::SetInitialBitState( BitState intial_bit_state )
+{
+	mInitialBitState = intial_bit_state;
+	mCurrentBitState = intial_bit_state;
+}
+
+Channel SimulationChannelDescriptor::GetChannel()
+{
+	return mChannel;
+}
+
+U32 SimulationChannelDescriptor::GetSampleRate()
+{
+	return mSampleRateHz;
+}
+
+BitState SimulationChannelDescriptor::GetInitialBitState()
+{
+	return mInitialBitState;
+}
+
+const std::vector<U64>& SimulationChannelDescriptor::GetTransitions()
+{
+	return mTransitions;
+}
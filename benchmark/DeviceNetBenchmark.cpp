@@ -0,0 +1,504 @@
+//Decoder throughput benchmark.  Builds a capture with DeviceNetSimulationDataGenerator, then decodes it with the
+//pipeline cut off after each stage in turn:
+//
+//	idle skip		SkipBusIdle from frame to frame, nothing else
+//	bit sampling	+ reading every raw bit of the frame at its sample point (or run), up to END OF FRAME
+//	destuffing		+ taking the stuff bits out in bulk, until END OF FRAME shows up as a stuff error
+//	field parsing	+ the rest of DeviceNetDecoder: fields, CRC, error and overload frames; the records go nowhere
+//	result emission	+ DeviceNetAnalyzer on the SDK stand-in, adding the frames, markers and packets to its results
+//					  (decoding on as many threads as --threads says)
+//	cached rerun	the same analyzer run again after switching the result detail (the marker policy, in compact mode:
+//					  a compact decode can't be replayed as fields): it replays its decode cache
+//
+//Each run up to result emission includes the stages before it, so what a stage costs is the difference to the one above (stage ms);
+//the cached rerun isn't one more stage on top, so it leaves that column blank.  ns/bit is per bit time on the bus, idle included; the
+//heap peak is what the run allocated on top of the capture.
+//Build with build_benchmark.py, and run with --help for the options.
+
+#include "DeviceNetAnalyzer.h"
+#include "DeviceNetAnalyzerSettings.h"
+#include "DeviceNetDecoder.h"
+#include "DeviceNetEdgeSource.h"
+#include "DeviceNetSimulationDataGenerator.h"
+
+#include <AnalyzerChannelData.h>
+#include <SimulationChannelDescriptor.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+//heap accounting, for the peak memory of each stage (the analyzer's decoder threads allocate too)
+static std::atomic<U64> gHeapBytes( 0 );
+static std::atomic<U64> gHeapPeakBytes( 0 );
+
+void* operator new( size_t size )
+{
+	//the size goes in front of the block, so delete knows what it gives back.
+	U64* block = (U64*)malloc( size + sizeof( U64 ) * 2 );
+	if( block == NULL )
+		throw std::bad_alloc();
+
+	block[ 0 ] = size;
+	U64 heap_bytes = gHeapBytes += size;
+	U64 peak_bytes = gHeapPeakBytes;
+	while( ( heap_bytes > peak_bytes ) && ( gHeapPeakBytes.compare_exchange_weak( peak_bytes, heap_bytes ) == false ) )
+		;
+
+	return block + 2;
+}
+
+void operator delete( void* pointer ) noexcept
+{
+	if( pointer == NULL )
+		return;
+
+	U64* block = (U64*)pointer - 2;
+	gHeapBytes -= block[ 0 ];
+	free( block );
+}
+
+void operator delete( void* pointer, size_t /*size*/ ) noexcept
+{
+	operator delete( pointer );
+}
+
+void* operator new[]( size_t size )
+{
+	return operator new( size );
+}
+
+void operator delete[]( void* pointer ) noexcept
+{
+	operator delete( pointer );
+}
+
+void operator delete[]( void* pointer, size_t /*size*/ ) noexcept
+{
+	operator delete( pointer );
+}
+
+enum BenchmarkStage
+{
+	Stage_IdleSkip,
+	Stage_BitSampling,
+	Stage_Destuffing,
+	Stage_FieldParsing,
+	Stage_ResultEmission,
+	Stage_CachedRerun,
+	NumBenchmarkStages
+};
+
+static const char* gStageNames[ NumBenchmarkStages ] = { "idle skip", "bit sampling", "destuffing", "field parsing", "result emission", "cached rerun" };
+
+struct BenchmarkOptions
+{
+	std::vector<U32> mBitRates;
+	U32 mSampleRateHz;
+	U32 mBusLoadPercent;
+	U32 mMinDataBytes;
+	U32 mMaxDataBytes;
+	double mSeconds;
+	U32 mRepeat;
+	BitSampling mBitSampling;
+	MarkerPolicy mMarkerPolicy;
+	ResultDetail mResultDetail;
+	bool mPortableDestuffing;
+	U32 mDecoderThreads;
+	const char* mSaveFile;
+	const char* mBaselineFile;
+	double mTolerancePercent;
+};
+
+struct BenchmarkCapture
+{
+	BitState mInitialState;
+	std::vector<U64> mEdges;
+	U64 mNumSamples;
+	U64 mNumBits;
+};
+
+struct StageResult
+{
+	double mSeconds;
+	U64 mFrames;
+	U64 mPeakHeapBytes;
+};
+
+//the cut off pipelines: DeviceNetDecoder's own stages, run only as far as the stage asks for.
+class DeviceNetStageDecoder : public DeviceNetDecoder
+{
+public:
+	U64 Run( BenchmarkStage stage )
+	{
+		U64 frames = 0;
+
+		if( stage == Stage_FieldParsing )
+		{
+			while( DecodeNext() == true )
+				frames++;
+			return frames;
+		}
+
+		while( SkipBusIdle() == StartOfFrameEdge )
+		{
+			frames++;
+
+			if( stage == Stage_BitSampling )
+				SampleFrame();
+			else if( stage == Stage_Destuffing )
+				DestuffFrame();
+		}
+
+		return frames;
+	}
+
+protected:
+	void SampleFrame()
+	{
+		//raw bits up to the sixth identical one in a row: inside END OF FRAME, after the ACK delimiter.
+		StartFrame();
+		SampleRawFrameBits( BIT_BUFFER_MAX_BITS );
+
+		if( mRawBits.GetNumBits() >= 6 )
+			mIdleStart = GetSampleOfRawBit( mRawBits.GetNumBits() - 6 ) - mSampleOffsets[ 0 ];
+		mIdleStartIsDelimiter = false;
+	}
+
+	void DestuffFrame()
+	{
+		//all of those through the destuffer: the recessive bits at the end of the frame make a stuff error.
+		SampleFrame();
+		mDestuffer.Destuff( mRawBits, mFrameBits, mStuffBits );
+	}
+};
+
+class NullListener : public DeviceNetDecoderListener
+{
+public:
+	virtual void OnRecord( const DeviceNetRecord& /*record*/ ) {}
+	virtual void OnMarker( U64 /*sample*/, DeviceNetMarkerType /*type*/ ) {}
+};
+
+static void PrintUsage()
+{
+	printf( "usage: DeviceNetBenchmark [options]\n" );
+	printf( "  --bit-rate 125000|250000|500000|all   bit rate(s) to simulate (all)\n" );
+	printf( "  --sample-rate HZ                       capture sample rate (16000000)\n" );
+	printf( "  --load PERCENT                         bus load, 1..100 (50)\n" );
+	printf( "  --dlc MIN-MAX                          data bytes per frame (0-8)\n" );
+	printf( "  --seconds S                            bus time to simulate (10)\n" );
+	printf( "  --repeat N                             runs per stage, the fastest counts (3)\n" );
+	printf( "  --sampling points|runs                 bit sampling mode (runs)\n" );
+	printf( "  --markers none|stuff|all               marker policy (stuff)\n" );
+	printf( "  --compact                              one result frame per message\n" );
+	printf( "  --no-bmi2                              destuff without PEXT even if the CPU has it\n" );
+	printf( "  --threads N                            analyzer decoder threads for result emission, 0 for one per core (1)\n" );
+	printf( "  --save FILE                            write frames/s per bit rate and stage to FILE\n" );
+	printf( "  --baseline FILE                        fail if a stage got slower than in FILE\n" );
+	printf( "  --tolerance PERCENT                    how much slower is still fine (15)\n" );
+}
+
+static bool ParseOptions( int argc, char** argv, BenchmarkOptions& options )
+{
+	options.mBitRates.clear();
+	options.mSampleRateHz = 16000000;
+	options.mBusLoadPercent = 50;
+	options.mMinDataBytes = 0;
+	options.mMaxDataBytes = 8;
+	options.mSeconds = 10.0;
+	options.mRepeat = 3;
+	options.mBitSampling = BitSampling_EdgeRuns;
+	options.mMarkerPolicy = Markers_StuffBitsAndErrors;
+	options.mResultDetail = Results_Fields;
+	options.mPortableDestuffing = false;
+	options.mDecoderThreads = 1;
+	options.mSaveFile = NULL;
+	options.mBaselineFile = NULL;
+	options.mTolerancePercent = 15.0;
+
+	for( int i = 1; i < argc; i++ )
+	{
+		std::string option = argv[ i ];
+		const char* value = ( i + 1 < argc ) ? argv[ i + 1 ] : NULL;
+
+		if( option == "--compact" )
+		{
+			options.mResultDetail = Results_Compact;
+			continue;
+		}
+
+		if( option == "--no-bmi2" )
+		{
+			options.mPortableDestuffing = true;
+			continue;
+		}
+
+		if( ( option == "--help" ) || ( value == NULL ) )
+			return false;
+		i++;
+
+		if( option == "--bit-rate" )
+		{
+			if( strcmp( value, "all" ) == 0 )
+				options.mBitRates.clear();
+			else
+				options.mBitRates.push_back( atoi( value ) );
+		}
+		else if( option == "--sample-rate" )
+			options.mSampleRateHz = atoi( value );
+		else if( option == "--load" )
+			options.mBusLoadPercent = atoi( value );
+		else if( option == "--dlc" )
+		{
+			if( sscanf( value, "%u-%u", &options.mMinDataBytes, &options.mMaxDataBytes ) != 2 )
+				options.mMaxDataBytes = options.mMinDataBytes;
+		}
+		else if( option == "--seconds" )
+			options.mSeconds = atof( value );
+		else if( option == "--repeat" )
+			options.mRepeat = atoi( value );
+		else if( option == "--sampling" )
+			options.mBitSampling = ( strcmp( value, "points" ) == 0 ) ? BitSampling_SamplePoints : BitSampling_EdgeRuns;
+		else if( option == "--markers" )
+			options.mMarkerPolicy = ( strcmp( value, "none" ) == 0 ) ? Markers_None : ( ( strcmp( value, "all" ) == 0 ) ? Markers_EveryBit : Markers_StuffBitsAndErrors );
+		else if( option == "--threads" )
+			options.mDecoderThreads = atoi( value );
+		else if( option == "--save" )
+			options.mSaveFile = value;
+		else if( option == "--baseline" )
+			options.mBaselineFile = value;
+		else if( option == "--tolerance" )
+			options.mTolerancePercent = atof( value );
+		else
+			return false;
+	}
+
+	if( options.mBitRates.empty() == true )
+	{
+		options.mBitRates.push_back( BitRate_125K );
+		options.mBitRates.push_back( BitRate_250K );
+		options.mBitRates.push_back( BitRate_500K );
+	}
+
+	if( ( options.mBusLoadPercent == 0 ) || ( options.mBusLoadPercent > 100 ) || ( options.mRepeat == 0 ) )
+		return false;
+
+	for( U32 i = 0; i < options.mBitRates.size(); i++ )
+	{
+		if( ( options.mBitRates[ i ] != BitRate_125K ) && ( options.mBitRates[ i ] != BitRate_250K ) && ( options.mBitRates[ i ] != BitRate_500K ) )
+			return false;
+
+		if( options.mSampleRateHz < options.mBitRates[ i ] * 4 )
+			return false;
+	}
+
+	return true;
+}
+
+static void FillSettings( const BenchmarkOptions& options, U32 bit_rate, DeviceNetAnalyzerSettings* settings )
+{
+	settings->mDeviceNetChannel = Channel( 0, 0 );
+	settings->mBitRate = BitRate( bit_rate );
+	settings->mBitSampling = options.mBitSampling;
+	settings->mMarkerPolicy = options.mMarkerPolicy;
+	settings->mResultDetail = options.mResultDetail;
+	settings->mDecoderThreads = options.mDecoderThreads;
+}
+
+static void GenerateCapture( const BenchmarkOptions& options, U32 bit_rate, BenchmarkCapture& capture )
+{
+	DeviceNetAnalyzerSettings settings;
+	FillSettings( options, bit_rate, &settings );
+
+	DeviceNetSimulationDataGenerator generator;
+	generator.Initialize( options.mSampleRateHz, &settings );
+	generator.SetTraffic( options.mBusLoadPercent, options.mMinDataBytes, options.mMaxDataBytes, 1 );
+	generator.SetExplicitTraffic( 0, 0 );
+
+	SimulationChannelDescriptor* channels = NULL;
+	U64 num_samples = U64( options.mSeconds * double( options.mSampleRateHz ) );
+	generator.GenerateSimulationData( num_samples, options.mSampleRateHz, &channels );
+
+	capture.mInitialState = channels->GetInitialBitState();
+	capture.mEdges = channels->GetTransitions();
+	capture.mNumSamples = channels->GetCurrentSampleNumber() + U64( options.mSampleRateHz / bit_rate ) * 20;	//end on bus idle
+	capture.mNumBits = capture.mNumSamples * bit_rate / options.mSampleRateHz;
+}
+
+static StageResult RunStage( const BenchmarkOptions& options, U32 bit_rate, const BenchmarkCapture& capture, BenchmarkStage stage )
+{
+	StageResult result;
+	result.mSeconds = 0.0;
+	result.mFrames = 0;
+	result.mPeakHeapBytes = 0;
+
+	for( U32 run = 0; run < options.mRepeat; run++ )
+	{
+		U64 heap_start = gHeapBytes;
+		gHeapPeakBytes = U64( gHeapBytes );
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		U64 frames = 0;
+
+		if( stage == Stage_ResultEmission )
+		{
+			DeviceNetAnalyzer analyzer;
+			FillSettings( options, bit_rate, (DeviceNetAnalyzerSettings*)analyzer.GetAnalyzerSettings() );
+			analyzer.SetSampleRate( options.mSampleRateHz );
+
+			AnalyzerChannelData channel_data( capture.mInitialState, capture.mEdges, capture.mNumSamples );
+			analyzer.SetAnalyzerChannelData( Channel( 0, 0 ), &channel_data );
+			analyzer.StartProcessing();
+
+			frames = analyzer.GetAnalyzerResults()->GetNumPackets();
+		}
+		else if( stage == Stage_CachedRerun )
+		{
+			DeviceNetAnalyzer analyzer;
+			DeviceNetAnalyzerSettings* settings = (DeviceNetAnalyzerSettings*)analyzer.GetAnalyzerSettings();
+			FillSettings( options, bit_rate, settings );
+			analyzer.SetSampleRate( options.mSampleRateHz );
+
+			AnalyzerChannelData channel_data( capture.mInitialState, capture.mEdges, capture.mNumSamples );
+			analyzer.SetAnalyzerChannelData( Channel( 0, 0 ), &channel_data );
+			analyzer.StartProcessing();
+
+			//the first run isn't part of the stage; the heap it holds on to (the cache) is.
+			if( options.mResultDetail == Results_Compact )
+				settings->mMarkerPolicy = ( options.mMarkerPolicy == Markers_None ) ? Markers_StuffBitsAndErrors : Markers_None;
+			else
+				settings->mResultDetail = Results_Compact;
+			AnalyzerChannelData rerun_channel_data( capture.mInitialState, capture.mEdges, capture.mNumSamples );
+			analyzer.SetAnalyzerChannelData( Channel( 0, 0 ), &rerun_channel_data );
+
+			start = std::chrono::steady_clock::now();
+			analyzer.StartProcessing();
+
+			frames = analyzer.GetAnalyzerResults()->GetNumPackets();
+		}
+		else
+		{
+			DeviceNetEdgeArray edges;
+			edges.Clear( capture.mInitialState, 0 );
+			for( U32 i = 0; i < capture.mEdges.size(); i++ )
+				edges.AddEdge( capture.mEdges[ i ] );
+
+			DeviceNetDecoderSettings settings;
+			settings.mSampleRateHz = options.mSampleRateHz;
+			settings.mBitRate = BitRate( bit_rate );
+			settings.mBitSampling = options.mBitSampling;
+			settings.mMarkerPolicy = options.mMarkerPolicy;
+			settings.mResultDetail = options.mResultDetail;
+
+			//the copy into the edge array isn't part of any stage.
+			heap_start = gHeapBytes;
+			gHeapPeakBytes = U64( gHeapBytes );
+			start = std::chrono::steady_clock::now();
+
+			NullListener listener;
+			DeviceNetStageDecoder decoder;
+			decoder.Start( settings, &edges, &listener );
+			frames = decoder.Run( stage );
+		}
+
+		double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+		if( ( run == 0 ) || ( seconds < result.mSeconds ) )
+			result.mSeconds = seconds;
+		result.mFrames = frames;
+		result.mPeakHeapBytes = gHeapPeakBytes - heap_start;
+	}
+
+	return result;
+}
+
+static bool CheckBaseline( const BenchmarkOptions& options, U32 bit_rate, BenchmarkStage stage, double frames_per_second )
+{
+	FILE* file = fopen( options.mBaselineFile, "r" );
+	if( file == NULL )
+		return true;
+
+	bool ok = true;
+	char stage_name[ 64 ];
+	U32 baseline_bit_rate;
+	double baseline_frames_per_second;
+	while( fscanf( file, "%u %63[^\t] %lf\n", &baseline_bit_rate, stage_name, &baseline_frames_per_second ) == 3 )
+	{
+		if( ( baseline_bit_rate != bit_rate ) || ( strcmp( stage_name, gStageNames[ stage ] ) != 0 ) )
+			continue;
+
+		if( frames_per_second < baseline_frames_per_second * ( 1.0 - options.mTolerancePercent / 100.0 ) )
+		{
+			printf( "REGRESSION: %u bit/s %s: %.0f frames/s, baseline %.0f\n", bit_rate, gStageNames[ stage ], frames_per_second, baseline_frames_per_second );
+			ok = false;
+		}
+	}
+
+	fclose( file );
+	return ok;
+}
+
+int main( int argc, char** argv )
+{
+	BenchmarkOptions options;
+	if( ParseOptions( argc, argv, options ) == false )
+	{
+		PrintUsage();
+		return 2;
+	}
+
+	DeviceNetDestuffer::SetBmi2Enabled( options.mPortableDestuffing == false );
+
+	FILE* save_file = NULL;
+	if( options.mSaveFile != NULL )
+		save_file = fopen( options.mSaveFile, "w" );
+
+	bool ok = true;
+	for( U32 i = 0; i < options.mBitRates.size(); i++ )
+	{
+		U32 bit_rate = options.mBitRates[ i ];
+
+		BenchmarkCapture capture;
+		GenerateCapture( options, bit_rate, capture );
+
+		printf( "%u bit/s at %u Hz, %u%% load, %u-%u data bytes: %.1f s, %llu bits, %llu edges, %s, %s, %s, %u decoder thread(s)\n", bit_rate, options.mSampleRateHz,
+			options.mBusLoadPercent, options.mMinDataBytes, options.mMaxDataBytes, options.mSeconds, capture.mNumBits, U64( capture.mEdges.size() ),
+			( options.mBitSampling == BitSampling_EdgeRuns ) ? "edge runs" : "sample points", ( options.mResultDetail == Results_Compact ) ? "compact" : "fields",
+			( ( options.mPortableDestuffing == false ) && ( DeviceNetDestuffer::IsBmi2Available() == true ) ) ? "PEXT destuffing" : "portable destuffing",
+			( options.mDecoderThreads == 0 ) ? U32( std::thread::hardware_concurrency() ) : options.mDecoderThreads );
+		printf( "  %-16s %8s %10s %12s %10s %8s %12s\n", "stage", "frames", "total ms", "frames/s", "ns/bit", "stage ms", "peak heap" );
+
+		double last_seconds = 0.0;
+		for( U32 stage = 0; stage < NumBenchmarkStages; stage++ )
+		{
+			StageResult result = RunStage( options, bit_rate, capture, BenchmarkStage( stage ) );
+			double frames_per_second = double( result.mFrames ) / result.mSeconds;
+
+			char stage_ms[ 32 ] = "";
+			if( stage != Stage_CachedRerun )
+				snprintf( stage_ms, sizeof( stage_ms ), "%.2f", ( result.mSeconds - last_seconds ) * 1000.0 );
+
+			printf( "  %-16s %8llu %10.2f %12.0f %10.2f %8s %12llu\n", gStageNames[ stage ], result.mFrames, result.mSeconds * 1000.0,
+				frames_per_second, result.mSeconds * 1e9 / double( capture.mNumBits ), stage_ms, result.mPeakHeapBytes );
+			last_seconds = result.mSeconds;
+
+			if( save_file != NULL )
+				fprintf( save_file, "%u %s\t%.0f\n", bit_rate, gStageNames[ stage ], frames_per_second );
+
+			if( options.mBaselineFile != NULL )
+				ok = CheckBaseline( options, bit_rate, BenchmarkStage( stage ), frames_per_second ) && ok;
+		}
+	}
+
+	if( save_file != NULL )
+		fclose( save_file );
+
+	return ( ok == true ) ? 0 : 1;
+}
@@ -43,8 +43,21 @@ include_paths = [ "./AnalyzerSDK/include" ]
 link_paths = [ "./AnalyzerSDK/lib" ]
 link_dependencies = [ "-lAnalyzer" ] #refers to libAnalyzer.dylib or libAnalyzer.so
 
-debug_compile_flags = "-O0 -w -c -fpic -g"
-release_compile_flags = "-O3 -w -c -fpic"
+#without the AnalyzerSDK submodule, build against the in-tree stand-in: its sources are compiled in instead of linking libAnalyzer
+source_folders = [ "source" ]
+if not os.path.exists( "AnalyzerSDK/include/Analyzer.h" ):
+    print( "AnalyzerSDK not found, building against AnalyzerSDKStandIn" )
+    include_paths = [ "./AnalyzerSDKStandIn/include" ]
+    link_paths = []
+    link_dependencies = []
+    source_folders.append( "AnalyzerSDKStandIn/source" )
+
+cpp_paths = []
+for source_folder in source_folders:
+    cpp_paths.extend( sorted( glob.glob( source_folder + "/*.cpp" ) ) )
+
+debug_compile_flags = "-O0 -w -c -fpic -g -pthread"
+release_compile_flags = "-O3 -w -c -fpic -pthread"
 
 def run_command(cmd):
     "Display cmd, then run it in a subshell, raise if there's an error"
@@ -53,7 +66,8 @@ def run_command(cmd):
         raise Exception("Shell execution returned nonzero status")
 
 #loop through all the cpp files, build up the gcc command line, and attempt to compile each cpp file
-for cpp_file in cpp_files:
+for cpp_path in cpp_paths:
+    cpp_file = os.path.basename( cpp_path )
 
     #g++
     command = "g++ "
@@ -65,12 +79,12 @@ for cpp_file in cpp_files:
     release_command = command
     release_command  += release_compile_flags
     release_command += " -o\"release/" + cpp_file.replace( ".cpp", ".o" ) + "\" " #the output file
-    release_command += "\"" + "source/" + cpp_file + "\"" #the cpp file to compile
+    release_command += "\"" + cpp_path + "\"" #the cpp file to compile
 
     debug_command = command
     debug_command  += debug_compile_flags
     debug_command += " -o\"debug/" + cpp_file.replace( ".cpp", ".o" ) + "\" " #the output file
-    debug_command += "\"" + "source/" + cpp_file + "\"" #the cpp file to compile
+    debug_command += "\"" + cpp_path + "\"" #the cpp file to compile
 
     #run the commands from the command line
     run_command(release_command)
@@ -95,6 +109,8 @@ if dylib_ext == ".dylib":
 else:
     command += "-shared "
 
+command += "-pthread " #the decoder's worker threads
+
 #figgure out what the name of this analyzer is
 analyzer_name = ""
 for cpp_file in cpp_files:
@@ -111,7 +127,8 @@ else:
     debug_command = command + "-o\"debug/lib" + analyzer_name + "Analyzer.so\" "
 
 #add all the object files to link
-for cpp_file in cpp_files:
+for cpp_path in cpp_paths:
+    cpp_file = os.path.basename( cpp_path )
     release_command += "release/" + cpp_file.replace( ".cpp", ".o" ) + " "
     debug_command += "debug/" + cpp_file.replace( ".cpp", ".o" ) + " "
     
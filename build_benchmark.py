@@ -0,0 +1,30 @@
+# Python 3 script to build the decoder benchmark, release/DeviceNetBenchmark
+# It always builds against the in-tree SDK stand-in (AnalyzerSDKStandIn): the benchmark runs the analyzer headless.
+
+import os, glob
+
+if not os.path.exists( "release" ):
+    os.makedirs( "release" )
+
+cpp_paths = []
+for source_folder in [ "source", "AnalyzerSDKStandIn/source", "benchmark" ]:
+    cpp_paths.extend( sorted( glob.glob( source_folder + "/*.cpp" ) ) )
+
+include_paths = [ "./AnalyzerSDKStandIn/include", "./source" ]
+compile_flags = "-O3 -w -pthread"
+
+def run_command(cmd):
+    "Display cmd, then run it in a subshell, raise if there's an error"
+    print(cmd)
+    if os.system(cmd):
+        raise Exception("Shell execution returned nonzero status")
+
+command = "g++ " + compile_flags + " "
+for path in include_paths:
+    command += "-I\"" + path + "\" "
+
+command += "-o\"release/DeviceNetBenchmark\" "
+for cpp_path in cpp_paths:
+    command += "\"" + cpp_path + "\" "
+
+run_command(command)
@@ -0,0 +1,31 @@
+# Python 3 script to build and run the tests, release/DeviceNetTests
+# Like the benchmark, it always builds against the in-tree SDK stand-in (AnalyzerSDKStandIn).
+
+import os, glob
+
+if not os.path.exists( "release" ):
+    os.makedirs( "release" )
+
+cpp_paths = []
+for source_folder in [ "source", "AnalyzerSDKStandIn/source", "tests" ]:
+    cpp_paths.extend( sorted( glob.glob( source_folder + "/*.cpp" ) ) )
+
+include_paths = [ "./AnalyzerSDKStandIn/include", "./source" ]
+compile_flags = "-O3 -w -pthread"
+
+def run_command(cmd):
+    "Display cmd, then run it in a subshell, raise if there's an error"
+    print(cmd)
+    if os.system(cmd):
+        raise Exception("Shell execution returned nonzero status")
+
+command = "g++ " + compile_flags + " "
+for path in include_paths:
+    command += "-I\"" + path + "\" "
+
+command += "-o\"release/DeviceNetTests\" "
+for cpp_path in cpp_paths:
+    command += "\"" + cpp_path + "\" "
+
+run_command(command)
+run_command("release/DeviceNetTests")
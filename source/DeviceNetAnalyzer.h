@@ -4,28 +4,34 @@
 #include <Analyzer.h>
 #include "DeviceNetAnalyzerResults.h"
 #include "DeviceNetSimulationDataGenerator.h"
+#include "DeviceNetDecoder.h"
+#include "DeviceNetParallelDecoder.h"
+#include "DeviceNetDecodeCache.h"
+#include "DeviceNetReassembler.h"
+#include "DeviceNetConnectionTracker.h"
 
-enum CanBitType
-{
-	Standard,
-	BitStuff
-};
-
-class CanMarker
-{
-public:
-	CanMarker(U64 sample, enum CanBitType type)
-	{
-		mSample = sample;
-		mType = type;
-	}
-
-	U64 mSample;
-	enum CanBitType mType;
+//the analyzer's channel, as the decoder's edge source.
+class DeviceNetChannelEdgeSource : public DeviceNetEdgeSource
+{
+public:
+	DeviceNetChannelEdgeSource( AnalyzerChannelData* channel_data );
+	virtual ~DeviceNetChannelEdgeSource();
+
+	virtual U64 GetSampleNumber();
+	virtual BitState GetBitState();
+	virtual void AdvanceToAbsPosition( U64 sample_number );
+	virtual void AdvanceToNextEdge();
+	virtual U64 GetSampleOfNextEdge();
+	virtual bool WouldAdvancingToAbsPositionCauseTransition( U64 sample_number );
+	virtual bool DoMoreTransitionsExistInCurrentData();
+	virtual bool HasMoreEdges();
+
+protected:
+	AnalyzerChannelData* mChannelData;
 };
 
 class DeviceNetAnalyzerSettings;
-class ANALYZER_EXPORT DeviceNetAnalyzer : public Analyzer2
+class ANALYZER_EXPORT DeviceNetAnalyzer : public Analyzer2, public DeviceNetDecoderListener
 {
 public:
 	DeviceNetAnalyzer();
@@ -40,57 +46,29 @@ public:
 	virtual const char* GetAnalyzerName() const;
 	virtual bool NeedsRerun();
 
+	//DeviceNetDecoderListener: what the decoder finds goes into the results, by way of the decode cache and the
+	//reassembler.
+	virtual void OnRecord( const DeviceNetRecord& record );
+	virtual void OnMarker( U64 sample, DeviceNetMarkerType type );
+	virtual void OnEventEnd( const DeviceNetEventInfo& info );
+
 protected: //vars
 	std::auto_ptr< DeviceNetAnalyzerSettings > mSettings;
 	std::auto_ptr< DeviceNetAnalyzerResults > mResults;
 	AnalyzerChannelData* mDeviceNet;
 	U32 mSampleRateHz;
 
-	DeviceNetSimulationDataGenerator mSimulationDataGenerator;
-	bool mSimulationInitilized;
+	DeviceNetParallelDecoder mDecoder;
+
+	//what the last runs decoded, for the next one: kept as long as the analyzer is around.
+	DeviceNetDecodeCache mDecodeCache;
+	Channel mDecodeCacheChannel;
 
-protected: //analysis functions
-	void WaitFor7RecessiveBits();
-	void InitSampleOffsets();
-	void GetRawFrame();
-	void AnalizeRawFrame();
-	bool UnstuffRawFrameBit(BitState& result, U64& sample, bool reset = false);
-	bool GetFixedFormFrameBit(BitState& result, U64& sample);
-
-protected: //analysis vars:
-	//ChunkedArray<ResultBubble>* mFrameBubbles;
-
-	U32 mNumSamplesIn7Bits;
-	U32 mRecessiveCount;
-	U32 mDominantCount;
-	U32 mRawFrameIndex;
-	U64 mStartOfFrame;
-	U32 mIdentifier;
-	U32 mCrcValue;
-	bool mAck;
-
-	std::vector<U32> mSampleOffsets;
-	std::vector<BitState> mRawBitResults;
-	std::vector<BitState> mBitResults;
-
-	std::vector<CanMarker> mCanMarkers;
-
-	std::vector<BitState> mArbitrationField;
-	bool mStandardCan;
-	bool mRemoteFrame;
-	U32 mNumDataBytes;
-	std::vector<BitState> mControlField;
-	std::vector<BitState> mDataField;
-	std::vector<BitState> mCrcFieldWithoutDelimiter;
-	BitState mCrcDelimiter;
-	std::vector<BitState> mAckField;
-	std::vector<BitState> mEndOfFrame;
-
-	U32 mNumRawBits;
-	bool mCanError;
-	U64 mErrorStartingSample;
-	U64 mErrorEndingSample;
+	DeviceNetReassembler mReassembler;
+	DeviceNetConnectionTracker mConnectionTracker;
 
+	DeviceNetSimulationDataGenerator mSimulationDataGenerator;
+	bool mSimulationInitilized;
 };
 
 extern "C" ANALYZER_EXPORT const char* __cdecl GetAnalyzerName();
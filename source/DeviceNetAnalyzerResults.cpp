@@ -4,13 +4,20 @@
 #include "DeviceNetAnalyzerSettings.h"
 #include <iostream>
 #include <sstream>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
 
 #include "DeviceNetProtocol.h"
 
 DeviceNetAnalyzerResults::DeviceNetAnalyzerResults( DeviceNetAnalyzer* analyzer, DeviceNetAnalyzerSettings* settings )
 :	AnalyzerResults(),
 	mSettings( settings ),
-	mAnalyzer( analyzer )
+	mAnalyzer( analyzer ),
+	mExportType( Export_Csv ),
+	mExportDisplayBase( Decimal ),
+	mExportTriggerSample( 0 ),
+	mExportSampleRate( 0 )
 {
 }
 
@@ -31,9 +38,9 @@ void DeviceNetAnalyzerResults::GenerateBubbleText( U64 frame_index, Channel& cha
 		char number_str[128];
 
 		if (frame.mType == IdentifierField)
-			AnalyzerHelpers::GetNumberString(frame.mData1, display_base, 12, number_str, 128);
+			AnalyzerHelpers::GetNumberString(frame.mData1 & COMPACT_IDENTIFIER_MASK, display_base, 12, number_str, 128);
 		else
-			AnalyzerHelpers::GetNumberString(frame.mData1, display_base, 32, number_str, 128);
+			AnalyzerHelpers::GetNumberString(frame.mData1 & COMPACT_IDENTIFIER_MASK, display_base, 32, number_str, 128);
 
 		std::stringstream ss;
 
@@ -47,12 +54,23 @@ void DeviceNetAnalyzerResults::GenerateBubbleText( U64 frame_index, Channel& cha
 		AddResultString(ss.str().c_str());
 		ss.str("");
 
+		const char* connection = GetConnectionName(frame);
+		if (connection != NULL)
+		{
+			ss << "Id: " << number_str << " " << connection;
+			AddResultString(ss.str().c_str());
+			ss.str("");
+		}
+
 		if (frame.HasFlag(REMOTE_FRAME) == false)
 		{
 			if (frame.mType == IdentifierField)
 				ss << "Standard CAN Identifier: " << number_str;
 			else
 				ss << "Extended CAN Identifier: " << number_str;
+
+			if (connection != NULL)
+				ss << " (" << connection << ")";
 		}
 		else
 		{
@@ -98,6 +116,16 @@ void DeviceNetAnalyzerResults::GenerateBubbleText( U64 frame_index, Channel& cha
 
 		ss << "Data Field Byte: " << number_str;
 		AddResultString(ss.str().c_str());
+
+		//a byte of an explicit message: what it's for
+		U8 data[8];
+		U32 offset;
+		DeviceNetCipMessage message;
+		if (GetFieldsCipMessage(frame_index, data, offset, message) == true)
+		{
+			ss << " (" << GetCipByteText(message, offset, display_base) << ")";
+			AddResultString(ss.str().c_str());
+		}
 	}
 	break;
 	case CrcField:
@@ -105,15 +133,33 @@ void DeviceNetAnalyzerResults::GenerateBubbleText( U64 frame_index, Channel& cha
 		char number_str[128];
 		AnalyzerHelpers::GetNumberString(frame.mData1, display_base, 15, number_str, 128);
 
-		AddResultString("CRC");
+		if (frame.HasFlag(CRC_ERROR) == false)
+		{
+			AddResultString("CRC");
 
-		std::stringstream ss;
-		ss << "CRC: " << number_str;
-		AddResultString(ss.str().c_str());
-		ss.str("");
+			std::stringstream ss;
+			ss << "CRC: " << number_str;
+			AddResultString(ss.str().c_str());
+			ss.str("");
 
-		ss << "CRC value: " << number_str;
-		AddResultString(ss.str().c_str());
+			ss << "CRC value: " << number_str;
+			AddResultString(ss.str().c_str());
+		}
+		else
+		{
+			char expected_str[128];
+			AnalyzerHelpers::GetNumberString(frame.mData2, display_base, 15, expected_str, 128);
+
+			AddResultString("CRC!");
+
+			std::stringstream ss;
+			ss << "CRC: " << number_str << " (bad)";
+			AddResultString(ss.str().c_str());
+			ss.str("");
+
+			ss << "CRC value: " << number_str << " (CRC error, expected " << expected_str << ")";
+			AddResultString(ss.str().c_str());
+		}
 	}
 	break;
 	case AckField:
@@ -126,152 +172,1097 @@ void DeviceNetAnalyzerResults::GenerateBubbleText( U64 frame_index, Channel& cha
 	break;
 	case DeviceNetError:
 	{
-		AddResultString("E");
-		AddResultString("Error");
+		if ((frame.mData1 & 0xFF) == OverloadFrame)
+		{
+			AddResultString("O");
+			AddResultString("Overload");
+		}
+		else
+		{
+			AddResultString("E");
+			AddResultString("Error");
+		}
+
+		AddResultString(GetErrorFrameText(frame).c_str());
 	}
 	break;
-	}
+	case CanMessage:
+	{
+		//the field bubbles, cut down from the one frame we kept.
+		char number_str[128];
+		U32 bits = frame.HasFlag(EXTENDED_IDENTIFIER) ? 32 : 12;
+		AnalyzerHelpers::GetNumberString(frame.mData1 & COMPACT_IDENTIFIER_MASK, display_base, bits, number_str, 128);
+
+		std::stringstream ss;
+
+		AddResultString(number_str);
+
+		ss << "Id: " << number_str << " [" << ((frame.mData1 >> COMPACT_DLC_SHIFT) & COMPACT_DLC_MASK) << "]";
+		AddResultString(ss.str().c_str());
+		ss.str("");
+
+		ss << "Id: " << number_str << " Data: " << GetMessageDataString(frame, display_base);
+		AddResultString(ss.str().c_str());
+		ss.str("");
+
+		U8 data[8];
+		DeviceNetCipMessage message;
+		const char* connection = GetConnectionName(frame);
+		if (GetCipMessage(frame, data, message) == true)
+		{
+			ss << "Id: " << number_str << " " << GetCipServiceText(message, display_base);
+			AddResultString(ss.str().c_str());
+		}
+		else if (connection != NULL)
+		{
+			ss << "Id: " << number_str << " " << connection;
+			AddResultString(ss.str().c_str());
+		}
+
+		AddResultString(GetMessageText(frame, display_base).c_str());
+	}
+	break;
+	case ReassembledMessage:
+	{
+		std::stringstream ss;
+
+		AddResultString("Msg");
+
+		ss << "Msg: " << (frame.mData2 & REASSEMBLED_LENGTH_MASK) << " bytes";
+		AddResultString(ss.str().c_str());
+		ss.str("");
+
+		DeviceNetCipMessage message;
+		if (GetCipMessage(frame, NULL, message) == true)
+		{
+			ss << "Msg: " << GetCipServiceText(message, display_base);
+			AddResultString(ss.str().c_str());
+			ss.str("");
+		}
+
+		ss << "Msg: " << GetReassembledDataString(frame, display_base, REASSEMBLED_TEXT_MAX_BYTES);
+		AddResultString(ss.str().c_str());
+
+		AddResultString(GetReassembledText(frame, display_base).c_str());
+	}
+	break;
+	}
+}
+
+DeviceNetPayloadArena* DeviceNetAnalyzerResults::GetPayloads()
+{
+	return &mPayloads;
+}
+
+DeviceNetLatencyStats* DeviceNetAnalyzerResults::GetLatency()
+{
+	return &mLatency;
+}
+
+const char* DeviceNetAnalyzerResults::GetConnectionName( Frame& frame )
+{
+	enum DeviceNetConnection connection = DeviceNetConnection((frame.mData1 >> CONNECTION_SHIFT) & CONNECTION_MASK);
+	if (connection == NoConnection)
+		return NULL;
+
+	U32 identifier_class = DeviceNetProtocol::ClassifyIdentifier(U32(frame.mData1 & COMPACT_IDENTIFIER_MASK));
+	return DeviceNetConnectionTracker::GetConnectionMessageName(identifier_class, connection);
+}
+
+std::string DeviceNetAnalyzerResults::GetReassembledDataString( Frame& frame, DisplayBase display_base, U32 max_bytes )
+{
+	U32 num_bytes = U32(frame.mData2 & REASSEMBLED_LENGTH_MASK);
+	U64 offset = frame.mData2 >> REASSEMBLED_OFFSET_SHIFT;
+	if ((num_bytes == 0) || (offset == REASSEMBLED_NO_PAYLOAD))
+		return std::string();
+
+	return GetBytesString(mPayloads.Get(offset), num_bytes, display_base, max_bytes);
+}
+
+std::string DeviceNetAnalyzerResults::GetBytesString( const U8* data, U32 num_bytes, DisplayBase display_base, U32 max_bytes )
+{
+	std::stringstream ss;
+
+	for (U32 i = 0; (i < num_bytes) && (i < max_bytes); i++)
+	{
+		char number_str[128];
+		AnalyzerHelpers::GetNumberString(data[i], display_base, 8, number_str, 128);
+
+		if (i != 0)
+			ss << " ";
+		ss << number_str;
+	}
+
+	if (num_bytes > max_bytes)
+		ss << " ...";
+
+	return ss.str();
+}
+
+std::string DeviceNetAnalyzerResults::GetReassembledText( Frame& frame, DisplayBase display_base )
+{
+	char number_str[128];
+	std::stringstream ss;
+
+	AnalyzerHelpers::GetNumberString(frame.mData1 & 0x7FF, display_base, 12, number_str, 128);
+
+	U64 num_fragments = (frame.mData1 >> REASSEMBLED_FRAGMENTS_SHIFT) & REASSEMBLED_COUNT_MASK;
+	if (frame.HasFlag(EXPLICIT_MESSAGE) == true)
+	{
+		ss << "Explicit message on Identifier: " << number_str;
+		ss << " (MAC ID " << ((frame.mData1 >> REASSEMBLED_HEADER_MAC_ID_SHIFT) & EXPLICIT_HEADER_MAC_ID_MASK) << ")";
+		ss << ", " << (frame.mData2 & REASSEMBLED_LENGTH_MASK) << " bytes in " << num_fragments << " fragments";
+		ss << ", " << ((frame.mData1 >> REASSEMBLED_ACKS_SHIFT) & REASSEMBLED_COUNT_MASK) << " acknowledged";
+	}
+	else
+	{
+		ss << "I/O message on Identifier: " << number_str;
+		ss << ", " << (frame.mData2 & REASSEMBLED_LENGTH_MASK) << " bytes in " << num_fragments << " fragments";
+	}
+
+	DeviceNetCipMessage message;
+	if ((frame.mData2 >> REASSEMBLED_OFFSET_SHIFT) == REASSEMBLED_NO_PAYLOAD)
+		ss << " (not kept, too many messages)";
+	else if (GetCipMessage(frame, NULL, message) == true)
+		ss << ": " << GetCipText(message, display_base, true);
+	else if ((frame.mData2 & REASSEMBLED_LENGTH_MASK) > 0)
+		ss << ": " << GetReassembledDataString(frame, display_base, REASSEMBLED_TEXT_MAX_BYTES);
+
+	return ss.str();
+}
+
+bool DeviceNetAnalyzerResults::GetCipMessage( Frame& frame, U8* data, DeviceNetCipMessage& message )
+{
+	if (frame.mType == ReassembledMessage)
+	{
+		U32 num_bytes = U32(frame.mData2 & REASSEMBLED_LENGTH_MASK);
+		U64 offset = frame.mData2 >> REASSEMBLED_OFFSET_SHIFT;
+		if ((frame.HasFlag(EXPLICIT_MESSAGE) == false) || (num_bytes == 0) || (offset == REASSEMBLED_NO_PAYLOAD))
+			return false;
+
+		//the message is a view of the payload, where it is in the arena.
+		U32 identifier_class = DeviceNetProtocol::ClassifyIdentifier(U32(frame.mData1 & 0x7FF));
+		U32 header_mac_id = U32(frame.mData1 >> REASSEMBLED_HEADER_MAC_ID_SHIFT) & EXPLICIT_HEADER_MAC_ID_MASK;
+		return message.ParseBody(identifier_class, header_mac_id, mPayloads.Get(offset), num_bytes, CIP_BODY_FORMAT);
+	}
+
+	if (frame.mType != CanMessage)
+		return false;
+
+	if ((frame.HasFlag(EXTENDED_IDENTIFIER) == true) || (frame.HasFlag(CRC_ERROR) == true))
+		return false;
+
+	U32 identifier_class = DeviceNetProtocol::ClassifyIdentifier(U32(frame.mData1 & COMPACT_IDENTIFIER_MASK));
+	if (DeviceNetProtocol::IsExplicitConnection(identifier_class) == false)
+		return false;
+
+	//the frame has the bytes packed, the first one on top.
+	U32 num_bytes = GetMessageNumDataBytes(frame);
+	for (U32 i = 0; i < num_bytes; i++)
+		data[i] = U8(frame.mData2 >> (56 - 8 * i));
+
+	return message.ParseFrame(identifier_class, data, num_bytes, CIP_BODY_FORMAT);
+}
+
+bool DeviceNetAnalyzerResults::GetFieldsCipMessage( U64 frame_index, U8* data, U32& offset, DeviceNetCipMessage& message )
+{
+	//the data bytes of a message come right after its identifier and control field.
+	U64 first_data_frame = frame_index;
+	while ((first_data_frame > 0) && (frame_index - first_data_frame < 8) && (GetFrame(first_data_frame - 1).mType == DataField))
+		first_data_frame--;
+
+	if (first_data_frame < 2)
+		return false;
+
+	Frame control = GetFrame(first_data_frame - 1);
+	Frame identifier = GetFrame(first_data_frame - 2);
+	if ((control.mType != ControlField) || (identifier.mType != IdentifierField) || (identifier.HasFlag(REMOTE_FRAME) == true))
+		return false;
+
+	U32 identifier_class = DeviceNetProtocol::ClassifyIdentifier(U32(identifier.mData1 & COMPACT_IDENTIFIER_MASK));
+	if (DeviceNetProtocol::IsExplicitConnection(identifier_class) == false)
+		return false;
+
+	U32 num_bytes = 0;
+	U64 num_frames = GetNumFrames();
+	for (U64 i = first_data_frame; (i < num_frames) && (num_bytes < control.mData1) && (num_bytes < 8); i++)
+	{
+		Frame data_frame = GetFrame(i);
+		if (data_frame.mType != DataField)
+			break;
+
+		data[num_bytes++] = U8(data_frame.mData1);
+	}
+
+	offset = U32(frame_index - first_data_frame);
+	return message.ParseFrame(identifier_class, data, num_bytes, CIP_BODY_FORMAT);
+}
+
+std::string DeviceNetAnalyzerResults::GetCipServiceText( DeviceNetCipMessage& message, DisplayBase display_base )
+{
+	std::stringstream ss;
+
+	if (message.mErrorResponse == true)
+	{
+		ss << "Error_Response";
+
+		const char* status = DeviceNetCipMessage::GetGeneralStatusName(message.mGeneralStatus);
+		if (status != NULL)
+			ss << ": " << status;
+
+		return ss.str();
+	}
+
+	const char* name = message.GetServiceName();
+	if (name != NULL)
+	{
+		ss << name;
+	}
+	else
+	{
+		char number_str[128];
+		AnalyzerHelpers::GetNumberString(message.mServiceCode, display_base, 8, number_str, 128);
+		ss << "Service " << number_str << " (" << DeviceNetCipMessage::GetServiceRangeName(message.mServiceCode) << ")";
+	}
+
+	if (message.mResponse == true)
+		ss << " response";
+	else
+		ss << " request";
+
+	return ss.str();
+}
+
+std::string DeviceNetAnalyzerResults::GetCipText( DeviceNetCipMessage& message, DisplayBase display_base, bool service_data )
+{
+	char number_str[128];
+	std::stringstream ss;
+
+	ss << GetCipServiceText(message, display_base);
+
+	if (message.mHasPath == true)
+	{
+		AnalyzerHelpers::GetNumberString(message.mClassID, display_base, (message.mClassID > 0xFF) ? 16 : 8, number_str, 128);
+		ss << ", Class: " << number_str;
+		if (message.mClassID >= START_ADDR_CLASS_ID_VENDOR_1)
+			ss << " (" << DeviceNetCipMessage::GetClassRangeName(message.mClassID) << ")";
+
+		AnalyzerHelpers::GetNumberString(message.mInstanceID, display_base, (message.mInstanceID > 0xFF) ? 16 : 8, number_str, 128);
+		ss << ", Instance: " << number_str;
+	}
+
+	if (message.mHasAttribute == true)
+	{
+		AnalyzerHelpers::GetNumberString(message.mAttributeID, display_base, 8, number_str, 128);
+		ss << ", Attribute: " << number_str;
+		if (message.mAttributeID >= START_ADDR_ATTRIBUTE_ID_VENDOR)
+			ss << " (" << DeviceNetCipMessage::GetAttributeRangeName(message.mAttributeID) << ")";
+	}
+
+	if (message.mErrorResponse == true)
+	{
+		AnalyzerHelpers::GetNumberString(message.mGeneralStatus, display_base, 8, number_str, 128);
+		ss << ", General Status: " << number_str;
+
+		if (message.mAdditionalCode != CIP_NO_ADDITIONAL_CODE)
+		{
+			AnalyzerHelpers::GetNumberString(message.mAdditionalCode, display_base, 8, number_str, 128);
+			ss << ", Additional Code: " << number_str;
+		}
+	}
+
+	if ((service_data == true) && (message.mServiceDataBytes > 0))
+		ss << ", Service Data: " << GetBytesString(message.mServiceData, message.mServiceDataBytes, display_base, REASSEMBLED_TEXT_MAX_BYTES);
+
+	return ss.str();
+}
+
+std::string DeviceNetAnalyzerResults::GetCipByteText( DeviceNetCipMessage& message, U32 offset, DisplayBase display_base )
+{
+	std::stringstream ss;
+
+	switch (message.GetByteRole(offset))
+	{
+	case CipMessageHeader:
+		ss << "Message Header, MAC ID " << message.mHeaderMacID;
+		break;
+	case CipServiceCode:
+		//an error response's status has a byte of its own
+		if (message.mErrorResponse == true)
+			ss << "Service: Error_Response";
+		else
+			ss << "Service: " << GetCipServiceText(message, display_base);
+		break;
+	case CipClassID:
+		ss << "Class ID";
+		break;
+	case CipInstanceID:
+		ss << "Instance ID";
+		break;
+	case CipAttributeID:
+		ss << "Attribute ID";
+		break;
+	case CipGeneralStatus:
+		ss << "General Status";
+		if (DeviceNetCipMessage::GetGeneralStatusName(message.mGeneralStatus) != NULL)
+			ss << ": " << DeviceNetCipMessage::GetGeneralStatusName(message.mGeneralStatus);
+		break;
+	case CipAdditionalCode:
+		ss << "Additional Code";
+		break;
+	case CipServiceData:
+		ss << "Service Data";
+		break;
+	}
+
+	return ss.str();
+}
+
+void DeviceNetAnalyzerResults::WriteCipColumns( DeviceNetExportWriter& writer, DeviceNetCipMessage& message, DisplayBase display_base )
+{
+	//the service code as it went, with the R/R bit, and its name (if it has one)
+	U32 service_code = message.mServiceCode | ((message.mResponse == true) ? CIP_SERVICE_RESPONSE : 0);
+	writer.WriteChar(',');
+	writer.WriteNumber(service_code, display_base, 8);
+	writer.WriteChar(',');
+
+	const char* name = message.GetServiceName();
+	if (name != NULL)
+		writer.Write(name);
+
+	writer.WriteChar(',');
+	if (message.mHasPath == true)
+		writer.WriteNumber(message.mClassID, display_base, (message.mClassID > 0xFF) ? 16 : 8);
+
+	writer.WriteChar(',');
+	if (message.mHasPath == true)
+		writer.WriteNumber(message.mInstanceID, display_base, (message.mInstanceID > 0xFF) ? 16 : 8);
+
+	writer.WriteChar(',');
+	if (message.mHasAttribute == true)
+		writer.WriteNumber(message.mAttributeID, display_base, 8);
+
+	writer.WriteChar(',');
+	if (message.mErrorResponse == true)
+		writer.WriteNumber(message.mGeneralStatus, display_base, 8);
+}
+
+std::string DeviceNetAnalyzerResults::GetErrorFrameText( Frame& frame )
+{
+	std::stringstream ss;
+
+	switch (frame.mData1 & 0xFF)
+	{
+	case ActiveErrorFrame:
+		ss << "Active error frame";
+		break;
+	case PassiveErrorFrame:
+		ss << "Passive error frame";
+		break;
+	case OverloadFrame:
+		ss << "Overload frame";
+		break;
+	}
+
+	switch ((frame.mData1 >> ERROR_CAUSE_SHIFT) & 0xFF)
+	{
+	case StuffError:
+		ss << " (stuff error)";
+		break;
+	case FormError:
+		ss << " (form error)";
+		break;
+	case FrameTooLong:
+		ss << " (frame too long)";
+		break;
+	}
+
+	ss << ", flag: " << frame.mData2 << " bits";
+	if (frame.HasFlag(FLAG_SUPERPOSITION) == true)
+		ss << " (superposition)";
+
+	return ss.str();
+}
+
+U32 DeviceNetAnalyzerResults::GetMessageNumDataBytes( Frame& frame )
+{
+	if (frame.HasFlag(REMOTE_FRAME) == true)
+		return 0;
+
+	U32 num_bytes = U32(frame.mData1 >> COMPACT_DLC_SHIFT) & COMPACT_DLC_MASK;
+	if (num_bytes > 8)
+		num_bytes = 8;
+
+	return num_bytes;
+}
+
+std::string DeviceNetAnalyzerResults::GetMessageDataString( Frame& frame, DisplayBase display_base )
+{
+	std::stringstream ss;
+
+	U32 num_bytes = GetMessageNumDataBytes(frame);
+	for (U32 i = 0; i < num_bytes; i++)
+	{
+		char number_str[128];
+		AnalyzerHelpers::GetNumberString((frame.mData2 >> (56 - 8 * i)) & 0xFF, display_base, 8, number_str, 128);
+
+		if (i != 0)
+			ss << " ";
+		ss << number_str;
+	}
+
+	return ss.str();
+}
+
+std::string DeviceNetAnalyzerResults::GetMessageText( Frame& frame, DisplayBase display_base )
+{
+	char number_str[128];
+	std::stringstream ss;
+
+	if (frame.HasFlag(EXTENDED_IDENTIFIER) == false)
+	{
+		AnalyzerHelpers::GetNumberString(frame.mData1 & COMPACT_IDENTIFIER_MASK, display_base, 12, number_str, 128);
+		ss << "Standard CAN Identifier: " << number_str;
+	}
+	else
+	{
+		AnalyzerHelpers::GetNumberString(frame.mData1 & COMPACT_IDENTIFIER_MASK, display_base, 32, number_str, 128);
+		ss << "Extended CAN Identifier: " << number_str;
+	}
+
+	const char* connection = GetConnectionName(frame);
+	if (frame.HasFlag(REMOTE_FRAME) == true)
+		ss << " (RTR)";
+	else if (connection != NULL)
+		ss << " (" << connection << ")";
+
+	AnalyzerHelpers::GetNumberString((frame.mData1 >> COMPACT_DLC_SHIFT) & COMPACT_DLC_MASK, display_base, 4, number_str, 128);
+	ss << ", Control Field: " << number_str;
+
+	if (GetMessageNumDataBytes(frame) > 0)
+	{
+		ss << ", Data: " << GetMessageDataString(frame, display_base);
+
+		U8 data[8];
+		DeviceNetCipMessage message;
+		if (GetCipMessage(frame, data, message) == true)
+			ss << " (" << GetCipText(message, display_base, false) << ")";
+	}
+
+	AnalyzerHelpers::GetNumberString(frame.mData1 >> COMPACT_CRC_SHIFT, display_base, 15, number_str, 128);
+	ss << ", CRC value: " << number_str;
+	if (frame.HasFlag(CRC_ERROR) == true)
+		ss << " (CRC error)";
+
+	if (frame.HasFlag(ACK_RECEIVED) == true)
+		ss << ", ACK";
+	else
+		ss << ", NAK";
+
+	return ss.str();
 }
 
 void DeviceNetAnalyzerResults::GenerateExportFile( const char* file, DisplayBase display_base, U32 export_type_user_id )
 {
-	//export_type_user_id is only important if we have more than one export type.
-	std::stringstream ss;
+	if (export_type_user_id == Export_Latency)
+	{
+		GenerateLatencyExportFile(file, display_base);
+		return;
+	}
+
+	if (export_type_user_id == Export_Binary)
+	{
+		GenerateBinaryExportFile(file);
+		return;
+	}
+
+	if ((export_type_user_id == Export_Candump) || (export_type_user_id == Export_VectorAsc) || (export_type_user_id == Export_Pcap))
+	{
+		GenerateLogExportFile(file, export_type_user_id);
+		return;
+	}
+
 	void* f = AnalyzerHelpers::StartFile(file);
+	DeviceNetExportWriter writer(f);
 
-	U64 trigger_sample = mAnalyzer->GetTriggerSample();
-	U32 sample_rate = mAnalyzer->GetSampleRate();
+	writer.Write("Time [s],Packet,Type,Identifier,Connection,Control,Data,CRC,ACK,Service,Service Name,Class,Instance,Attribute,Status\n");
+	WriteExportPackets(writer, Export_Csv, display_base);
 
-	ss << "Time [s],Packet,Type,Identifier,Control,Data,CRC,ACK" << std::endl;
-	U64 num_frames = GetNumFrames();
+	writer.Flush();
+	AnalyzerHelpers::EndFile(f);
+}
+
+bool DeviceNetAnalyzerResults::WriteExportPackets( DeviceNetExportWriter& writer, U32 export_type_user_id, DisplayBase display_base )
+{
+	//every packet's row or record, formatted a round of packets at a time on the decoder threads (from frames read
+	//here first): false if the export was cancelled.
+	mExportType = export_type_user_id;
+	mExportDisplayBase = display_base;
+	mExportTriggerSample = mAnalyzer->GetTriggerSample();
+	mExportSampleRate = mAnalyzer->GetSampleRate();
+
+	DeviceNetParallelExport parallel_export(mSettings->mDecoderThreads, this, this);
 	U64 num_packets = GetNumPackets();
-	for (U32 i = 0; i < num_packets; i++)
+	for (U64 first_packet = 0; first_packet < num_packets; )
 	{
-		if (i != 0)
-		{
-			//below, we "continue" the loop rather than run to the end.  So we need to save to the file here.
-			ss << std::endl;
+		U64 end_packet = std::min(num_packets, first_packet + parallel_export.GetRoundPackets());
+		parallel_export.FormatPackets(writer, first_packet, end_packet);
+		first_packet = end_packet;
 
-			AnalyzerHelpers::AppendToFile((U8*)ss.str().c_str(), ss.str().length(), f);
-			ss.str(std::string());
+		if ((first_packet < num_packets) && (UpdateExportProgressAndCheckForCancel(first_packet, num_packets) == true))
+			return false;
+	}
 
+	UpdateExportProgressAndCheckForCancel(num_packets, num_packets);
+	return true;
+}
 
-			if (UpdateExportProgressAndCheckForCancel(i, num_packets) == true)
-			{
-				AnalyzerHelpers::EndFile(f);
-				return;
-			}
-		}
+void DeviceNetAnalyzerResults::FormatPacket( DeviceNetExportWriter& writer, U64 packet_id, Frame* frames, U32 num_frames )
+{
+	switch (mExportType)
+	{
+	case Export_Csv:
+		WriteCsvPacket(writer, packet_id, frames, num_frames, mExportDisplayBase, mExportTriggerSample, mExportSampleRate);
+		writer.WriteChar('\n');
+		break;
+	case Export_Binary:
+		WriteBinaryRecord(writer, frames, num_frames);
+		break;
+	case Export_Candump:
+	case Export_VectorAsc:
+	case Export_Pcap:
+		WriteLogMessage(writer, frames, num_frames);
+		break;
+	}
+}
 
+void DeviceNetAnalyzerResults::WriteCsvPacket( DeviceNetExportWriter& writer, U64 packet_id, Frame* frames, U32 num_frames, DisplayBase display_base, U64 trigger_sample, U32 sample_rate )
+{
+	//a row, without its line end.  A packet cut short by an error stops where it does.
+	Frame& frame = frames[0];
 
-		U64 first_frame_id;
-		U64 last_frame_id;
-		GetFramesContainedInPacket(i, &first_frame_id, &last_frame_id);
-		Frame frame = GetFrame(first_frame_id);
+	char time_str[128];
+	AnalyzerHelpers::GetTimeString(frame.mStartingSampleInclusive, trigger_sample, sample_rate, time_str, 128);
+	writer.Write(time_str);
+	writer.WriteChar(',');
+	writer.WriteDecimal(packet_id);
 
-		//static void GetTimeString( U64 sample, U64 trigger_sample, U32 sample_rate_hz, char* result_string, U32 result_string_max_length );
-		char time_str[128];
-		AnalyzerHelpers::GetTimeString(frame.mStartingSampleInclusive, trigger_sample, sample_rate, time_str, 128);
+	if (frame.mType == ReassembledMessage)
+	{
+		//a reassembled message: its length where the data length code goes, and all of it in the data column.
+		writer.Write(",MESSAGE,");
+		writer.WriteNumber(frame.mData1 & 0x7FF, display_base, 12);
+		writer.Write(",,");
+		writer.WriteDecimal(frame.mData2 & REASSEMBLED_LENGTH_MASK);
+		writer.WriteChar(',');
 
-		char packet_str[128];
-		AnalyzerHelpers::GetNumberString(i, Decimal, 0, packet_str, 128);
+		U32 num_bytes = U32(frame.mData2 & REASSEMBLED_LENGTH_MASK);
+		U64 offset = frame.mData2 >> REASSEMBLED_OFFSET_SHIFT;
+		if (offset != REASSEMBLED_NO_PAYLOAD)
+			WriteBytes(writer, mPayloads.Get(offset), num_bytes, display_base);
 
-		if (frame.HasFlag(REMOTE_FRAME) == false)
-			ss << time_str << "," << packet_str << ",DATA";
-		else
-			ss << time_str << "," << packet_str << ",REMOTE";
+		writer.Write(",,");
 
-		U64 frame_id = first_frame_id;
+		DeviceNetCipMessage message;
+		if (GetCipMessage(frame, NULL, message) == true)
+			WriteCipColumns(writer, message, display_base);
+		return;
+	}
 
-		frame = GetFrame(frame_id);
+	if (frame.HasFlag(REMOTE_FRAME) == false)
+		writer.Write(",DATA");
+	else
+		writer.Write(",REMOTE");
 
-		char number_str[128];
+	if (frame.mType == CanMessage)
+	{
+		//compact results: the whole row comes from the one frame.
+		writer.WriteChar(',');
+		writer.WriteNumber(frame.mData1 & COMPACT_IDENTIFIER_MASK, display_base, frame.HasFlag(EXTENDED_IDENTIFIER) ? 32 : 12);
 
-		if (frame.mType == IdentifierField)
-		{
-			AnalyzerHelpers::GetNumberString(frame.mData1, display_base, 12, number_str, 128);
-			ss << "," << number_str;
-			++frame_id;
-		}
-		else if (frame.mType == IdentifierFieldEx)
-		{
-			AnalyzerHelpers::GetNumberString(frame.mData1, display_base, 32, number_str, 128);
-			ss << "," << number_str;
-			++frame_id;
-		}
-		else
-		{
-			ss << ",";
-		}
+		writer.WriteChar(',');
+		const char* connection = GetConnectionName(frame);
+		if (connection != NULL)
+			writer.Write(connection);
 
-		if (frame_id > last_frame_id)
-			continue;
+		writer.WriteChar(',');
+		writer.WriteNumber((frame.mData1 >> COMPACT_DLC_SHIFT) & COMPACT_DLC_MASK, display_base, 4);
 
-		frame = GetFrame(frame_id);
-		if (frame.mType == ControlField)
-		{
-			AnalyzerHelpers::GetNumberString(frame.mData1, display_base, 4, number_str, 128);
-			ss << "," << number_str;
-			++frame_id;
-		}
+		U8 data[8];
+		U32 num_bytes = GetMessageNumDataBytes(frame);
+		for (U32 i = 0; i < num_bytes; i++)
+			data[i] = U8(frame.mData2 >> (56 - 8 * i));
+
+		writer.WriteChar(',');
+		WriteBytes(writer, data, num_bytes, display_base);
+
+		writer.WriteChar(',');
+		writer.WriteNumber(frame.mData1 >> COMPACT_CRC_SHIFT, display_base, 15);
+
+		if (frame.HasFlag(ACK_RECEIVED) == true)
+			writer.Write(",ACK");
 		else
-		{
-			ss << ",";
-		}
-		ss << ",";
-		if (frame_id > last_frame_id)
-			continue;
+			writer.Write(",NAK");
+
+		DeviceNetCipMessage message;
+		if (GetCipMessage(frame, data, message) == true)
+			WriteCipColumns(writer, message, display_base);
+		return;
+	}
+
+	//an explicit message gets its CIP columns: its identifier and data bytes, on the way.
+	bool explicit_message = false;
+	U32 identifier_class = 0;
+	U8 data[8];
+	U32 num_data_bytes = 0;
+
+	U32 frame_index = 0;
+
+	if (frame.mType == IdentifierField)
+	{
+		writer.WriteChar(',');
+		writer.WriteNumber(frame.mData1 & COMPACT_IDENTIFIER_MASK, display_base, 12);
+
+		writer.WriteChar(',');
+		const char* connection = GetConnectionName(frame);
+		if (connection != NULL)
+			writer.Write(connection);
+
+		identifier_class = DeviceNetProtocol::ClassifyIdentifier(U32(frame.mData1 & COMPACT_IDENTIFIER_MASK));
+		explicit_message = (frame.HasFlag(REMOTE_FRAME) == false) && (DeviceNetProtocol::IsExplicitConnection(identifier_class) == true);
+		++frame_index;
+	}
+	else if (frame.mType == IdentifierFieldEx)
+	{
+		writer.WriteChar(',');
+		writer.WriteNumber(frame.mData1 & COMPACT_IDENTIFIER_MASK, display_base, 32);
+		writer.WriteChar(',');
+		++frame_index;
+	}
+	else
+	{
+		writer.Write(",,");
+	}
 
-		for (; ; )
+	//the rest of the row: each field fills in the columns up to its own.  A row cut short after its data bytes
+	//still gets the (empty) CRC and ACK columns.
+	enum { ControlColumn, DataColumn, CrcColumn, AckColumn } column = ControlColumn;
+
+	for (; frame_index < num_frames; frame_index++)
+	{
+		Frame& field = frames[frame_index];
+
+		if (column == ControlColumn)
 		{
-			frame = GetFrame(frame_id);
-			if (frame.mType != DataField)
-				break;
-
-			AnalyzerHelpers::GetNumberString(frame.mData1, display_base, 8, number_str, 128);
-			ss << number_str;
-			if (frame_id == last_frame_id)
-				break;
-
-			++frame_id;
-			if (GetFrame(frame_id).mType == DataField)
-				ss << " ";
+			writer.WriteChar(',');
+			column = DataColumn;
+			if (field.mType == ControlField)
+			{
+				writer.WriteNumber(field.mData1, display_base, 4);
+				writer.WriteChar(',');
+				continue;
+			}
+			writer.WriteChar(',');
 		}
 
-		if (frame_id > last_frame_id)
-			continue;
-
-		frame = GetFrame(frame_id);
-		if (frame.mType == CrcField)
+		if (column == DataColumn)
 		{
-			AnalyzerHelpers::GetNumberString(frame.mData1, display_base, 15, number_str, 128);
-			ss << "," << number_str;
-			++frame_id;
+			if (field.mType == DataField)
+			{
+				if (num_data_bytes != 0)
+					writer.WriteChar(' ');
+				writer.WriteNumber(field.mData1, display_base, 8);
+				if (num_data_bytes < 8)
+					data[num_data_bytes] = U8(field.mData1);
+				num_data_bytes++;
+				continue;
+			}
+			column = CrcColumn;
 		}
-		else
+
+		if (column == CrcColumn)
 		{
-			ss << ",";
+			writer.WriteChar(',');
+			column = AckColumn;
+			if (field.mType == CrcField)
+			{
+				writer.WriteNumber(field.mData1, display_base, 15);
+				if (field.HasFlag(CRC_ERROR) == true)
+					explicit_message = false;
+				continue;
+			}
 		}
-		if (frame_id > last_frame_id)
-			continue;
 
-		frame = GetFrame(frame_id);
-		if (frame.mType == AckField)
+		if (field.mType == AckField)
 		{
-			if (bool(frame.mData1) == true)
-				ss << "," << "ACK";
+			if (bool(field.mData1) == true)
+				writer.Write(",ACK");
 			else
-				ss << "," << "NAK";
+				writer.Write(",NAK");
+
+			if (num_data_bytes > 8)
+				num_data_bytes = 8;
 
-			++frame_id;
+			DeviceNetCipMessage message;
+			if ((explicit_message == true) && (message.ParseFrame(identifier_class, data, num_data_bytes, CIP_BODY_FORMAT) == true))
+				WriteCipColumns(writer, message, display_base);
 		}
 		else
 		{
-			ss << ",";
+			writer.WriteChar(',');
 		}
+		return;
 	}
 
-	UpdateExportProgressAndCheckForCancel(num_frames, num_frames);
+	if ((column == DataColumn) && (num_data_bytes != 0))
+		writer.Write(",,");
+}
+
+void DeviceNetAnalyzerResults::WriteBytes( DeviceNetExportWriter& writer, const U8* data, U32 num_bytes, DisplayBase display_base )
+{
+	for (U32 i = 0; i < num_bytes; i++)
+	{
+		if (i != 0)
+			writer.WriteChar(' ');
+		writer.WriteNumber(data[i], display_base, 8);
+	}
+}
+
+void DeviceNetAnalyzerResults::GenerateBinaryExportFile( const char* file )
+{
+	void* f = AnalyzerHelpers::StartFile(file, true);
+	DeviceNetExportWriter writer(f);
+
+	//the header, and what's in a record
+	writer.Write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+	writer.WriteLittleEndian(BINARY_VERSION, 2);
+	writer.WriteLittleEndian(BINARY_NUM_FIELDS, 2);
+	writer.WriteLittleEndian(BINARY_HEADER_BYTES, 4);
+	writer.WriteLittleEndian(BINARY_RECORD_BYTES, 4);
+	writer.WriteLittleEndian(mAnalyzer->GetSampleRate(), 4);
+	writer.WriteLittleEndian(mAnalyzer->GetTriggerSample(), 8);
+
+	static const struct { char mName[12]; U16 mOffset; U8 mSize; U8 mType; } fields[BINARY_NUM_FIELDS] =
+	{
+		{ "sample", 0, 8, BINARY_FIELD_UNSIGNED },			//start of frame; the identifier's start in Fields mode
+		{ "identifier", 8, 4, BINARY_FIELD_UNSIGNED },
+		{ "dlc", 12, 1, BINARY_FIELD_UNSIGNED },
+		{ "ack", 13, 1, BINARY_FIELD_UNSIGNED },			//1 ACK, 0 NAK
+		{ "crc", 14, 2, BINARY_FIELD_UNSIGNED },
+		{ "data", 16, 8, BINARY_FIELD_BYTE_ARRAY },			//the first dlc bytes of it (8 at most)
+		{ "flags", 24, 1, BINARY_FIELD_UNSIGNED },
+		{ "connection", 25, 1, BINARY_FIELD_UNSIGNED }		//26..31 are 0
+	};
+
+	for (U32 i = 0; i < BINARY_NUM_FIELDS; i++)
+	{
+		writer.Write(fields[i].mName, sizeof(fields[i].mName));
+		writer.WriteLittleEndian(fields[i].mOffset, 2);
+		writer.WriteLittleEndian(fields[i].mSize, 1);
+		writer.WriteLittleEndian(fields[i].mType, 1);
+	}
+
+	WriteExportPackets(writer, Export_Binary, Decimal);
+
+	writer.Flush();
+	AnalyzerHelpers::EndFile(f);
+}
+
+void DeviceNetAnalyzerResults::WriteBinaryRecord( DeviceNetExportWriter& writer, Frame* frames, U32 num_frames )
+{
+	//a record per CAN frame: reassembled messages and error frames on their own aren't any.
+	DeviceNetPacketMessage message;
+	if (GetPacketMessage(frames, num_frames, message) == false)
+		return;
+
+	U8 flags = message.mFlags;
+	if (message.mComplete == false)
+		flags |= BINARY_INCOMPLETE;
+
+	U64 data = 0;
+	for (U32 i = 0; i < message.mNumDataBytes; i++)
+		data |= U64(message.mData[i]) << (8 * i);
+
+	writer.WriteLittleEndian(message.mStartingSample, 8);
+	writer.WriteLittleEndian(message.mIdentifier, 4);
+	writer.WriteLittleEndian(message.mDataLengthCode, 1);
+	writer.WriteLittleEndian(((message.mFlags & ACK_RECEIVED) != 0) ? 1 : 0, 1);
+	writer.WriteLittleEndian(message.mCrc, 2);
+	writer.WriteLittleEndian(data, 8);
+	writer.WriteLittleEndian(flags, 1);
+	writer.WriteLittleEndian(message.mConnection, 1);
+	writer.WriteLittleEndian(0, BINARY_RECORD_BYTES - 26);
+}
+
+bool DeviceNetAnalyzerResults::GetPacketMessage( Frame* frames, U32 num_frames, DeviceNetPacketMessage& message )
+{
+	Frame& frame = frames[0];
+
+	message.mStartingSample = frame.mStartingSampleInclusive;
+	message.mConnection = U8((frame.mData1 >> CONNECTION_SHIFT) & CONNECTION_MASK);
+
+	if (frame.mType == CanMessage)
+	{
+		message.mIdentifier = U32(frame.mData1 & COMPACT_IDENTIFIER_MASK);
+		message.mFlags = U8(frame.mData1 >> COMPACT_FLAGS_SHIFT) & (REMOTE_FRAME | CRC_ERROR | EXTENDED_IDENTIFIER | ACK_RECEIVED);
+		message.mDataLengthCode = U8(frame.mData1 >> COMPACT_DLC_SHIFT) & COMPACT_DLC_MASK;
+		message.mNumDataBytes = U8(GetMessageNumDataBytes(frame));
+		for (U32 i = 0; i < 8; i++)
+			message.mData[i] = (i < message.mNumDataBytes) ? U8(frame.mData2 >> (56 - 8 * i)) : 0;
+		message.mCrc = U16(frame.mData1 >> COMPACT_CRC_SHIFT) & 0x7FFF;
+		message.mComplete = true;
+		return true;
+	}
+
+	if ((frame.mType != IdentifierField) && (frame.mType != IdentifierFieldEx))
+		return false;
+
+	message.mIdentifier = U32(frame.mData1 & COMPACT_IDENTIFIER_MASK);
+	message.mFlags = frame.mFlags & REMOTE_FRAME;
+	if (frame.mType == IdentifierFieldEx)
+		message.mFlags |= EXTENDED_IDENTIFIER;
+	message.mDataLengthCode = 0;
+	message.mNumDataBytes = 0;
+	memset(message.mData, 0, sizeof(message.mData));
+	message.mCrc = 0;
+	message.mComplete = false;
+
+	for (U32 i = 1; i < num_frames; i++)
+	{
+		Frame& field = frames[i];
+		switch (field.mType)
+		{
+		case ControlField:
+			message.mDataLengthCode = U8(field.mData1);
+			break;
+		case DataField:
+			if (message.mNumDataBytes < 8)
+				message.mData[message.mNumDataBytes++] = U8(field.mData1);
+			break;
+		case CrcField:
+			message.mCrc = U16(field.mData1);
+			if (field.HasFlag(CRC_ERROR) == true)
+				message.mFlags |= CRC_ERROR;
+			break;
+		case AckField:
+			if (bool(field.mData1) == true)
+				message.mFlags |= ACK_RECEIVED;
+			message.mComplete = true;
+			break;
+		}
+	}
+
+	return true;
+}
+
+void DeviceNetAnalyzerResults::GenerateLogExportFile( const char* file, U32 export_type_user_id )
+{
+	void* f = AnalyzerHelpers::StartFile(file, export_type_user_id == Export_Pcap);
+	DeviceNetExportWriter writer(f);
+
+	if (export_type_user_id == Export_VectorAsc)
+	{
+		//the log doesn't know when the capture was made: it gets the time of the export.
+		char date_str[64];
+		time_t now = time(NULL);
+		strftime(date_str, sizeof(date_str), "%a %b %d %H:%M:%S.000 %Y", localtime(&now));
+
+		writer.Write("date ");
+		writer.Write(date_str);
+		writer.Write("\nbase hex  timestamps absolute\nno internal events logged\n");
+		writer.Write("Begin Triggerblock ");
+		writer.Write(date_str);
+		writer.Write("\n   0.000000 Start of measurement\n");
+	}
+	else if (export_type_user_id == Export_Pcap)
+	{
+		writer.WriteLittleEndian(PCAP_MAGIC_NANOSECONDS, 4);
+		writer.WriteLittleEndian(PCAP_VERSION_MAJOR, 2);
+		writer.WriteLittleEndian(PCAP_VERSION_MINOR, 2);
+		writer.WriteLittleEndian(0, 4);		//time zone
+		writer.WriteLittleEndian(0, 4);		//timestamp accuracy
+		writer.WriteLittleEndian(PCAP_SNAPLEN, 4);
+		writer.WriteLittleEndian(PCAP_LINKTYPE_CAN_SOCKETCAN, 4);
+	}
+
+	bool finished = WriteExportPackets(writer, export_type_user_id, Decimal);
+
+	if ((finished == true) && (export_type_user_id == Export_VectorAsc))
+		writer.Write("End TriggerBlock\n");
+
+	writer.Flush();
+	AnalyzerHelpers::EndFile(f);
+}
+
+void DeviceNetAnalyzerResults::WriteLogMessage( DeviceNetExportWriter& writer, Frame* frames, U32 num_frames )
+{
+	DeviceNetPacketMessage message;
+	if ((GetPacketMessage(frames, num_frames, message) == false) || (message.mComplete == false) || ((message.mFlags & CRC_ERROR) != 0))
+		return;
+
+	if (mExportType == Export_Candump)
+		WriteCandumpMessage(writer, message, mExportSampleRate);
+	else if (mExportType == Export_VectorAsc)
+		WriteAscMessage(writer, message, mExportSampleRate);
+	else
+		WritePcapMessage(writer, message, mExportSampleRate);
+}
+
+void DeviceNetAnalyzerResults::WriteCandumpMessage( DeviceNetExportWriter& writer, DeviceNetPacketMessage& message, U32 sample_rate )
+{
+	//(0000000000.004330) can0 32F#0001020304050607, 8 hex digits for an extended identifier, #R and the DLC for a
+	//remote frame
+	writer.WriteChar('(');
+	WriteSampleTime(writer, message.mStartingSample, sample_rate, 6, 17, '0');
+	writer.Write(") " LOG_INTERFACE_NAME " ");
+
+	writer.WriteHex(message.mIdentifier, ((message.mFlags & EXTENDED_IDENTIFIER) != 0) ? 8 : 3);
+	writer.WriteChar('#');
+
+	if ((message.mFlags & REMOTE_FRAME) != 0)
+	{
+		writer.WriteChar('R');
+		if ((message.mDataLengthCode != 0) && (message.mDataLengthCode <= 8))
+			writer.WriteHex(message.mDataLengthCode);
+	}
+	else
+	{
+		for (U32 i = 0; i < message.mNumDataBytes; i++)
+			writer.WriteHex(message.mData[i], 2);
+	}
+
+	writer.WriteChar('\n');
+}
+
+void DeviceNetAnalyzerResults::WriteAscMessage( DeviceNetExportWriter& writer, DeviceNetPacketMessage& message, U32 sample_rate )
+{
+	//   0.004330 1  32F             Rx   d 8 00 01 02 03 04 05 06 07, an x after an extended identifier
+	WriteSampleTime(writer, message.mStartingSample, sample_rate, 6, 11, ' ');
+	writer.Write(" " LOG_ASC_CHANNEL "  ");
+
+	U32 id_chars = writer.WriteHex(message.mIdentifier);
+	if ((message.mFlags & EXTENDED_IDENTIFIER) != 0)
+	{
+		writer.WriteChar('x');
+		id_chars++;
+	}
+	if (id_chars < 15)
+		writer.WriteRepeated(' ', 15 - id_chars);
+
+	if ((message.mFlags & REMOTE_FRAME) != 0)
+	{
+		writer.Write(" Rx   r ");
+		writer.WriteHex(message.mDataLengthCode);
+	}
+	else
+	{
+		writer.Write(" Rx   d ");
+		writer.WriteHex(message.mDataLengthCode);
+		for (U32 i = 0; i < message.mNumDataBytes; i++)
+		{
+			writer.WriteChar(' ');
+			writer.WriteHex(message.mData[i], 2);
+		}
+	}
+
+	writer.WriteChar('\n');
+}
+
+void DeviceNetAnalyzerResults::WritePcapMessage( DeviceNetExportWriter& writer, DeviceNetPacketMessage& message, U32 sample_rate )
+{
+	//the record header: seconds, nanoseconds, and the length captured and on the wire
+	U64 seconds = message.mStartingSample / sample_rate;
+	U64 nanoseconds = (message.mStartingSample % sample_rate) * 1000000000ull / sample_rate;
+	writer.WriteLittleEndian(seconds, 4);
+	writer.WriteLittleEndian(nanoseconds, 4);
+	writer.WriteLittleEndian(PCAP_CAN_FRAME_BYTES, 4);
+	writer.WriteLittleEndian(PCAP_CAN_FRAME_BYTES, 4);
+
+	//struct can_frame: CAN ID and flags, payload length, padding and reserved bytes, 8 data bytes
+	U32 can_id = message.mIdentifier;
+	if ((message.mFlags & EXTENDED_IDENTIFIER) != 0)
+		can_id |= SOCKETCAN_EFF_FLAG;
+	if ((message.mFlags & REMOTE_FRAME) != 0)
+		can_id |= SOCKETCAN_RTR_FLAG;
+
+	U32 length = ((message.mFlags & REMOTE_FRAME) != 0) ? message.mDataLengthCode : message.mNumDataBytes;
+	if (length > 8)
+		length = 8;
+
+	writer.WriteBigEndian(can_id, 4);
+	writer.WriteLittleEndian(length, 1);
+	writer.WriteLittleEndian(0, 3);
+	writer.Write((const char*)message.mData, 8);
+}
+
+void DeviceNetAnalyzerResults::WriteSampleTime( DeviceNetExportWriter& writer, U64 sample, U32 sample_rate, U32 num_decimals, U32 width, char fill )
+{
+	//seconds, with num_decimals digits after the point (cut off, not rounded), filled on the left to width
+	U64 scale = 1;
+	for (U32 i = 0; i < num_decimals; i++)
+		scale *= 10;
+
+	U64 seconds = sample / sample_rate;
+	U64 fraction = (sample % sample_rate) * scale / sample_rate;
+
+	U32 num_chars = 2 + num_decimals;
+	for (U64 s = seconds; s >= 10; s /= 10)
+		num_chars++;
+	if (num_chars < width)
+		writer.WriteRepeated(fill, width - num_chars);
+
+	writer.WriteDecimal(seconds);
+	writer.WriteChar('.');
+	writer.WriteDecimal(fraction, num_decimals);
+}
+
+void DeviceNetAnalyzerResults::GenerateLatencyExportFile( const char* file, DisplayBase display_base )
+{
+	//a row per MAC ID and kind of request that has been answered, or asked: the times in seconds.
+	void* f = AnalyzerHelpers::StartFile(file);
+	DeviceNetExportWriter writer(f);
+
+	U32 sample_rate = mAnalyzer->GetSampleRate();
+
+	writer.Write("MAC ID,Request,Responses,Unanswered,p50 [s],p99 [s],Max [s]\n");
+	for (U32 mac_id = 0; mac_id < NUM_MAC_IDS; mac_id++)
+	{
+		for (U32 kind = 0; kind < NumLatencyKinds; kind++)
+		{
+			DeviceNetLatencyHistogram& histogram = mLatency.GetHistogram(mac_id, DeviceNetLatencyKind(kind));
+			U64 num_unanswered = mLatency.GetNumUnanswered(mac_id, DeviceNetLatencyKind(kind));
+			if ((histogram.GetCount() == 0) && (num_unanswered == 0))
+				continue;
+
+			writer.WriteNumber(mac_id, display_base, 6);
+			writer.Write((kind == PollLatency) ? ",Poll," : ",Explicit,");
+			writer.WriteDecimal(histogram.GetCount());
+			writer.WriteChar(',');
+			writer.WriteDecimal(num_unanswered);
+
+			if (histogram.GetCount() != 0)
+			{
+				char time_str[128];
+				AnalyzerHelpers::GetTimeString(histogram.GetPercentile(50.0), 0, sample_rate, time_str, 128);
+				writer.WriteChar(',');
+				writer.Write(time_str);
+				AnalyzerHelpers::GetTimeString(histogram.GetPercentile(99.0), 0, sample_rate, time_str, 128);
+				writer.WriteChar(',');
+				writer.Write(time_str);
+				AnalyzerHelpers::GetTimeString(histogram.GetMax(), 0, sample_rate, time_str, 128);
+				writer.WriteChar(',');
+				writer.Write(time_str);
+			}
+			else
+			{
+				writer.Write(",,,");
+			}
+
+			writer.WriteChar('\n');
+		}
+	}
+
+	writer.Flush();
 	AnalyzerHelpers::EndFile(f);
 }
 
@@ -289,9 +1280,9 @@ void DeviceNetAnalyzerResults::GenerateFrameTabularText( U64 frame_index, Displa
 		char number_str[128];
 
 		if (frame.mType == IdentifierField)
-			AnalyzerHelpers::GetNumberString(frame.mData1, display_base, 12, number_str, 128);
+			AnalyzerHelpers::GetNumberString(frame.mData1 & COMPACT_IDENTIFIER_MASK, display_base, 12, number_str, 128);
 		else
-			AnalyzerHelpers::GetNumberString(frame.mData1, display_base, 32, number_str, 128);
+			AnalyzerHelpers::GetNumberString(frame.mData1 & COMPACT_IDENTIFIER_MASK, display_base, 32, number_str, 128);
 
 		std::stringstream ss;
 
@@ -302,6 +1293,10 @@ void DeviceNetAnalyzerResults::GenerateFrameTabularText( U64 frame_index, Displa
 				ss << "Standard CAN Identifier: " << number_str;
 			else
 				ss << "Extended CAN Identifier: " << number_str;
+
+			const char* connection = GetConnectionName(frame);
+			if (connection != NULL)
+				ss << " (" << connection << ")";
 		}
 		else
 		{
@@ -335,6 +1330,13 @@ void DeviceNetAnalyzerResults::GenerateFrameTabularText( U64 frame_index, Displa
 		std::stringstream ss;
 
 		ss << "Data Field Byte: " << number_str;
+
+		U8 data[8];
+		U32 offset;
+		DeviceNetCipMessage message;
+		if (GetFieldsCipMessage(frame_index, data, offset, message) == true)
+			ss << " (" << GetCipByteText(message, offset, display_base) << ")";
+
 		AddTabularText(ss.str().c_str());
 	}
 	break;
@@ -346,6 +1348,12 @@ void DeviceNetAnalyzerResults::GenerateFrameTabularText( U64 frame_index, Displa
 		std::stringstream ss;
 
 		ss << "CRC value: " << number_str;
+		if (frame.HasFlag(CRC_ERROR) == true)
+		{
+			char expected_str[128];
+			AnalyzerHelpers::GetNumberString(frame.mData2, display_base, 15, expected_str, 128);
+			ss << " (CRC error, expected " << expected_str << ")";
+		}
 		AddTabularText(ss.str().c_str());
 	}
 	break;
@@ -357,9 +1365,19 @@ void DeviceNetAnalyzerResults::GenerateFrameTabularText( U64 frame_index, Displa
 			AddTabularText("NAK");
 	}
 	break;
-	case CanError:
+	case DeviceNetError:
+	{
+		AddTabularText(GetErrorFrameText(frame).c_str());
+	}
+	break;
+	case CanMessage:
+	{
+		AddTabularText(GetMessageText(frame, display_base).c_str());
+	}
+	break;
+	case ReassembledMessage:
 	{
-		AddTabularText("Error");
+		AddTabularText(GetReassembledText(frame, display_base).c_str());
 	}
 	break;
 	}
@@ -2,11 +2,73 @@
 #define DEVICENET_ANALYZER_RESULTS
 
 #include <AnalyzerResults.h>
+#include <string>
+#include <sstream>
+#include "DeviceNetReassembler.h"
+#include "DeviceNetCip.h"
+#include "DeviceNetConnectionTracker.h"
+#include "DeviceNetLatency.h"
+#include "DeviceNetExportWriter.h"
+#include "DeviceNetParallelExport.h"
+
+//a reassembled message's bubble and table text stop after this many bytes; the export has all of them.
+#define REASSEMBLED_TEXT_MAX_BYTES	64
+
+//the class and instance IDs of explicit requests: the Predefined Master/Slave Connection Set's format.  What a UCMM
+//connection was opened with isn't known when a message is shown.
+#define CIP_BODY_FORMAT	CipBodyFormat_8_8
+
+// The binary export: a header, then a fixed-width record per CAN frame, everything little-endian.  The header is
+// BINARY_HEADER_BYTES: the magic, U16 version, U16 number of field descriptors, U32 header size (where the records
+// start), U32 record size, U32 sample rate in Hz and U64 trigger sample (time 0), then a 16-byte descriptor per
+// record field: its name (12 chars, zero padded), U16 offset, U8 size and U8 type (BINARY_FIELD_...).  Records are
+// BINARY_RECORD_BYTES, and start on a multiple of it, so the file can be mapped and read as an array.
+#define BINARY_MAGIC				"DNETCAN"	//and its zero: 8 bytes
+#define BINARY_VERSION				1
+#define BINARY_FIXED_HEADER_BYTES	32
+#define BINARY_FIELD_BYTES			16
+#define BINARY_NUM_FIELDS			8
+#define BINARY_HEADER_BYTES			( BINARY_FIXED_HEADER_BYTES + BINARY_NUM_FIELDS * BINARY_FIELD_BYTES )
+#define BINARY_RECORD_BYTES			32
+#define BINARY_FIELD_UNSIGNED		0
+#define BINARY_FIELD_BYTE_ARRAY		1
+
+//the record's flags: the CanMessage ones (REMOTE_FRAME, CRC_ERROR, EXTENDED_IDENTIFIER, ACK_RECEIVED) and this.
+#define BINARY_INCOMPLETE			( 1 << 4 )	// an error frame cut it short: what's missing is 0
+
+// The CAN logs other tools read (candump -l, Vector ASC, PCAP): the frames that went through whole and with the
+// right CRC, timed from the start of the capture -- the logs have no trigger.  The PCAP file has nanosecond
+// timestamps and the SocketCAN link type, its frames' CAN ID and flags big-endian, as Linux hands them out.
+#define LOG_INTERFACE_NAME			"can0"
+#define LOG_ASC_CHANNEL				"1"
+#define PCAP_MAGIC_NANOSECONDS		0xA1B23C4D
+#define PCAP_VERSION_MAJOR			2
+#define PCAP_VERSION_MINOR			4
+#define PCAP_SNAPLEN				65535
+#define PCAP_LINKTYPE_CAN_SOCKETCAN	227
+#define PCAP_CAN_FRAME_BYTES		16
+#define SOCKETCAN_EFF_FLAG			0x80000000	// extended frame format
+#define SOCKETCAN_RTR_FLAG			0x40000000	// remote transmission request
+
+//a CAN frame of the results, from one frame or from its fields: what the binary and log exports write.
+class DeviceNetPacketMessage
+{
+public:
+	U64 mStartingSample;
+	U32 mIdentifier;
+	U8 mFlags;			//REMOTE_FRAME, CRC_ERROR, EXTENDED_IDENTIFIER, ACK_RECEIVED
+	U8 mConnection;		//a DeviceNetConnection
+	U8 mDataLengthCode;
+	U8 mNumDataBytes;	//at most 8, 0 for a remote frame
+	U8 mData[8];
+	U16 mCrc;
+	bool mComplete;		//it got to the ACK field
+};
 
 class DeviceNetAnalyzer;
 class DeviceNetAnalyzerSettings;
 
-class DeviceNetAnalyzerResults : public AnalyzerResults
+class DeviceNetAnalyzerResults : public AnalyzerResults, public DeviceNetExportFormatter
 {
 public:
 	DeviceNetAnalyzerResults( DeviceNetAnalyzer* analyzer, DeviceNetAnalyzerSettings* settings );
@@ -19,11 +81,61 @@ public:
 	virtual void GeneratePacketTabularText( U64 packet_id, DisplayBase display_base );
 	virtual void GenerateTransactionTabularText( U64 transaction_id, DisplayBase display_base );
 
+	//where the reassembled messages' payloads go (see ReassembledMessage).
+	DeviceNetPayloadArena* GetPayloads();
+
+	//where the connection tracker puts the times devices take to answer.
+	DeviceNetLatencyStats* GetLatency();
+
+	//a packet's row or record of the export that's running, from a copy of its frames: on any of the export's
+	//threads, so it mustn't read the results themselves.
+	virtual void FormatPacket( DeviceNetExportWriter& writer, U64 packet_id, Frame* frames, U32 num_frames );
+
 protected: //functions
+	U32 GetMessageNumDataBytes( Frame& frame );
+	std::string GetMessageDataString( Frame& frame, DisplayBase display_base );
+	std::string GetMessageText( Frame& frame, DisplayBase display_base );
+	std::string GetErrorFrameText( Frame& frame );
+	void GenerateLatencyExportFile( const char* file, DisplayBase display_base );
+	void GenerateBinaryExportFile( const char* file );
+	void WriteBinaryRecord( DeviceNetExportWriter& writer, Frame* frames, U32 num_frames );
+	bool WriteExportPackets( DeviceNetExportWriter& writer, U32 export_type_user_id, DisplayBase display_base );
+	bool GetPacketMessage( Frame* frames, U32 num_frames, DeviceNetPacketMessage& message );
+	void GenerateLogExportFile( const char* file, U32 export_type_user_id );
+	void WriteLogMessage( DeviceNetExportWriter& writer, Frame* frames, U32 num_frames );
+	void WriteCandumpMessage( DeviceNetExportWriter& writer, DeviceNetPacketMessage& message, U32 sample_rate );
+	void WriteAscMessage( DeviceNetExportWriter& writer, DeviceNetPacketMessage& message, U32 sample_rate );
+	void WritePcapMessage( DeviceNetExportWriter& writer, DeviceNetPacketMessage& message, U32 sample_rate );
+	void WriteSampleTime( DeviceNetExportWriter& writer, U64 sample, U32 sample_rate, U32 num_decimals, U32 width, char fill );
+	void WriteCsvPacket( DeviceNetExportWriter& writer, U64 packet_id, Frame* frames, U32 num_frames, DisplayBase display_base, U64 trigger_sample, U32 sample_rate );
+	void WriteBytes( DeviceNetExportWriter& writer, const U8* data, U32 num_bytes, DisplayBase display_base );
+	std::string GetBytesString( const U8* data, U32 num_bytes, DisplayBase display_base, U32 max_bytes );
+	std::string GetReassembledDataString( Frame& frame, DisplayBase display_base, U32 max_bytes );
+	std::string GetReassembledText( Frame& frame, DisplayBase display_base );
+
+	//what the connection tracker labelled an IdentifierField or CanMessage frame ("Poll Command", ...), or NULL.
+	const char* GetConnectionName( Frame& frame );
+
+	//the CIP message of an explicit message: in a CanMessage (its bytes unpacked into data, 8 of them) or a
+	//ReassembledMessage frame, or in fields, the one whose data byte frame_index is (at offset, into data).
+	bool GetCipMessage( Frame& frame, U8* data, DeviceNetCipMessage& message );
+	bool GetFieldsCipMessage( U64 frame_index, U8* data, U32& offset, DeviceNetCipMessage& message );
+	std::string GetCipServiceText( DeviceNetCipMessage& message, DisplayBase display_base );
+	std::string GetCipText( DeviceNetCipMessage& message, DisplayBase display_base, bool service_data );
+	std::string GetCipByteText( DeviceNetCipMessage& message, U32 offset, DisplayBase display_base );
+	void WriteCipColumns( DeviceNetExportWriter& writer, DeviceNetCipMessage& message, DisplayBase display_base );
 
 protected:  //vars
 	DeviceNetAnalyzerSettings* mSettings;
 	DeviceNetAnalyzer* mAnalyzer;
+	DeviceNetPayloadArena mPayloads;
+	DeviceNetLatencyStats mLatency;
+
+	//what the export that's running writes: read by its threads, set before they start.
+	U32 mExportType;
+	DisplayBase mExportDisplayBase;
+	U64 mExportTriggerSample;
+	U32 mExportSampleRate;
 };
 
 #endif //DEVICENET_ANALYZER_RESULTS
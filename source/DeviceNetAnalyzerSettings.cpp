@@ -5,7 +5,12 @@
 DeviceNetAnalyzerSettings::DeviceNetAnalyzerSettings()
 :	mDeviceNetChannel( UNDEFINED_CHANNEL ),
 	mBitRate( BitRate_500K ),
-	mInverted(false)
+	mInverted(false),
+	mBitSampling( BitSampling_EdgeRuns ),
+	mMarkerPolicy( Markers_StuffBitsAndErrors ),
+	mResultDetail( Results_Fields ),
+	mDecoderThreads( 1 ),
+	mReassembly( Reassembly_ExplicitAndIO )
 {
 	mDeviceNetChannelInterface.reset( new AnalyzerSettingInterfaceChannel() );
 	mDeviceNetChannelInterface->SetTitleAndTooltip( "DeviceNet", "Standard DeviceNet (based on CAN2.0A)" );
@@ -16,19 +21,76 @@ DeviceNetAnalyzerSettings::DeviceNetAnalyzerSettings()
 	mBitRateInterface->AddNumber(BitRate_500K, "500000 Bits/s" , "High-Speed DeviceNet" );
 	mBitRateInterface->AddNumber(BitRate_250K, "250000 Bits/s" , "Middle-Speed DeviceNet" );
 	mBitRateInterface->AddNumber(BitRate_125K, "125000 Bits/s" , "Low-Speed DeviceNet" );
+	mBitRateInterface->AddNumber(BitRate_Auto, "Auto" , "Detect the bit rate from the pulse widths at the start of the capture" );
 	mBitRateInterface->SetNumber(mBitRate);
 
 	mDeviceNetChannelInvertedInterface.reset(new AnalyzerSettingInterfaceBool());
 	mDeviceNetChannelInvertedInterface->SetTitleAndTooltip("Inverted (CAN High)", "Use this option when recording CAN High directly");
 	mDeviceNetChannelInvertedInterface->SetValue(mInverted);
 
+	mBitSamplingInterface.reset( new AnalyzerSettingInterfaceNumberList() );
+	mBitSamplingInterface->SetTitleAndTooltip( "Bit Sampling", "How bits are read from the capture. Both decode the same bits on a clean signal, though they can differ around glitches; edge runs reads the channel far less often." );
+	mBitSamplingInterface->AddNumber( BitSampling_EdgeRuns, "Edge run-length", "Walk the edges and convert each run length into a number of bits" );
+	mBitSamplingInterface->AddNumber( BitSampling_SamplePoints, "Every bit", "Advance to every bit's sample point and read it" );
+	mBitSamplingInterface->SetNumber( mBitSampling );
+
+	mMarkerPolicyInterface.reset( new AnalyzerSettingInterfaceNumberList() );
+	mMarkerPolicyInterface->SetTitleAndTooltip( "Markers", "Which bits get a marker on the waveform. A marker on every bit takes more memory than the decoded frames on long captures." );
+	mMarkerPolicyInterface->AddNumber( Markers_StuffBitsAndErrors, "Stuff bits and errors", "Mark stuff bits and where errors were found" );
+	mMarkerPolicyInterface->AddNumber( Markers_EveryBit, "Every bit", "Mark every bit's sample point" );
+	mMarkerPolicyInterface->AddNumber( Markers_None, "None", "Don't add any markers" );
+	mMarkerPolicyInterface->SetNumber( mMarkerPolicy );
+
+	mResultDetailInterface.reset( new AnalyzerSettingInterfaceNumberList() );
+	mResultDetailInterface->SetTitleAndTooltip( "Results", "How much is stored per message. Compact uses a fraction of the memory on long captures." );
+	mResultDetailInterface->AddNumber( Results_Fields, "Every field", "A bubble for the identifier, control field, each data byte, CRC and ACK" );
+	mResultDetailInterface->AddNumber( Results_Compact, "One per message", "A single bubble holding the whole message" );
+	mResultDetailInterface->SetNumber( mResultDetail );
+
+	mDecoderThreadsInterface.reset( new AnalyzerSettingInterfaceNumberList() );
+	mDecoderThreadsInterface->SetTitleAndTooltip( "Decoder Threads", "How many threads decode a capture that's already recorded, and format its exports. The results are the same either way; a live capture is decoded on one as it comes in." );
+	mDecoderThreadsInterface->AddNumber( 0, "One per core", "Cut the capture at bus idle and decode the pieces on every core" );
+	mDecoderThreadsInterface->AddNumber( 1, "1", "Decode the whole capture on the analyzer's own thread" );
+	mDecoderThreadsInterface->AddNumber( 2, "2", "Decode on 2 threads" );
+	mDecoderThreadsInterface->AddNumber( 4, "4", "Decode on 4 threads" );
+	mDecoderThreadsInterface->AddNumber( 8, "8", "Decode on 8 threads" );
+	mDecoderThreadsInterface->AddNumber( 16, "16", "Decode on 16 threads" );
+	mDecoderThreadsInterface->SetNumber( mDecoderThreads );
+
+	mReassemblyInterface.reset( new AnalyzerSettingInterfaceNumberList() );
+	mReassemblyInterface->SetTitleAndTooltip( "Fragmented Messages", "Put messages sent in fragments back together, into a bubble after the last fragment." );
+	mReassemblyInterface->AddNumber( Reassembly_ExplicitAndIO, "Explicit and I/O", "Explicit messages by their header, and I/O messages of 8 bytes that run through a series of fragments" );
+	mReassemblyInterface->AddNumber( Reassembly_Explicit, "Explicit only", "Only explicit messages with the fragment bit of their header set" );
+	mReassemblyInterface->AddNumber( Reassembly_None, "Off", "Show every fragment on its own" );
+	mReassemblyInterface->SetNumber( mReassembly );
+
 	AddInterface( mDeviceNetChannelInterface.get() );
 	AddInterface( mBitRateInterface.get() );
 	AddInterface( mDeviceNetChannelInvertedInterface.get());
+	AddInterface( mBitSamplingInterface.get() );
+	AddInterface( mMarkerPolicyInterface.get() );
+	AddInterface( mResultDetailInterface.get() );
+	AddInterface( mDecoderThreadsInterface.get() );
+	AddInterface( mReassemblyInterface.get() );
+
+	AddExportOption( Export_Csv, "Export as text/csv file" );
+	AddExportExtension( Export_Csv, "text", "txt" );
+	AddExportExtension( Export_Csv, "csv", "csv" );
+
+	AddExportOption( Export_Latency, "Export response latency statistics as csv file" );
+	AddExportExtension( Export_Latency, "csv", "csv" );
+
+	AddExportOption( Export_Binary, "Export as binary file (fixed-width records)" );
+	AddExportExtension( Export_Binary, "binary", "bin" );
 
-	AddExportOption( 0, "Export as text/csv file" );
-	AddExportExtension( 0, "text", "txt" );
-	AddExportExtension( 0, "csv", "csv" );
+	AddExportOption( Export_Candump, "Export as candump log file" );
+	AddExportExtension( Export_Candump, "candump log", "log" );
+
+	AddExportOption( Export_VectorAsc, "Export as Vector ASC file" );
+	AddExportExtension( Export_VectorAsc, "Vector ASC", "asc" );
+
+	AddExportOption( Export_Pcap, "Export as PCAP file (SocketCAN)" );
+	AddExportExtension( Export_Pcap, "pcap", "pcap" );
 
 	ClearChannels();
 	AddChannel( mDeviceNetChannel, "DeviceNet", false );
@@ -43,6 +105,11 @@ bool DeviceNetAnalyzerSettings::SetSettingsFromInterfaces()
 	mDeviceNetChannel = mDeviceNetChannelInterface->GetChannel();
 	mBitRate = BitRate( U32 (mBitRateInterface->GetNumber() ) );
 	mInverted = mDeviceNetChannelInvertedInterface->GetValue();
+	mBitSampling = BitSampling( U32( mBitSamplingInterface->GetNumber() ) );
+	mMarkerPolicy = MarkerPolicy( U32( mMarkerPolicyInterface->GetNumber() ) );
+	mResultDetail = ResultDetail( U32( mResultDetailInterface->GetNumber() ) );
+	mDecoderThreads = U32( mDecoderThreadsInterface->GetNumber() );
+	mReassembly = Reassembly( U32( mReassemblyInterface->GetNumber() ) );
 
 	ClearChannels();
 	AddChannel( mDeviceNetChannel, "DeviceNet", true );
@@ -55,6 +122,11 @@ void DeviceNetAnalyzerSettings::UpdateInterfacesFromSettings()
 	mDeviceNetChannelInterface->SetChannel( mDeviceNetChannel );
 	mBitRateInterface->SetNumber( mBitRate );
 	mDeviceNetChannelInvertedInterface->SetValue(mInverted);
+	mBitSamplingInterface->SetNumber( mBitSampling );
+	mMarkerPolicyInterface->SetNumber( mMarkerPolicy );
+	mResultDetailInterface->SetNumber( mResultDetail );
+	mDecoderThreadsInterface->SetNumber( mDecoderThreads );
+	mReassemblyInterface->SetNumber( mReassembly );
 }
 
 void DeviceNetAnalyzerSettings::LoadSettings( const char* settings )
@@ -62,8 +134,27 @@ void DeviceNetAnalyzerSettings::LoadSettings( const char* settings )
 	SimpleArchive text_archive;
 	text_archive.SetString( settings );
 
+	//the enums go through a U32, each starting from what it is now: settings saved before it existed leave it be.
+	U32 number;
+
 	text_archive >> mDeviceNetChannel;
-	text_archive >> * (U32*) &mBitRate;
+	number = mBitRate;
+	text_archive >> number;
+	mBitRate = BitRate( number );
+	text_archive >> mInverted;
+	number = mBitSampling;
+	text_archive >> number;
+	mBitSampling = BitSampling( number );
+	number = mMarkerPolicy;
+	text_archive >> number;
+	mMarkerPolicy = MarkerPolicy( number );
+	number = mResultDetail;
+	text_archive >> number;
+	mResultDetail = ResultDetail( number );
+	text_archive >> mDecoderThreads;
+	number = mReassembly;
+	text_archive >> number;
+	mReassembly = Reassembly( number );
 
 	ClearChannels();
 	AddChannel( mDeviceNetChannel, "DeviceNet", true );
@@ -77,6 +168,12 @@ const char* DeviceNetAnalyzerSettings::SaveSettings()
 
 	text_archive << mDeviceNetChannel;
 	text_archive << mBitRate;
+	text_archive << mInverted;
+	text_archive << mBitSampling;
+	text_archive << mMarkerPolicy;
+	text_archive << mResultDetail;
+	text_archive << mDecoderThreads;
+	text_archive << mReassembly;
 
 	return SetReturnString( text_archive.GetString() );
 }
@@ -3,12 +3,18 @@
 
 #include <AnalyzerSettings.h>
 #include <AnalyzerTypes.h>
+#include "DeviceNetDecoder.h"
+#include "DeviceNetReassembler.h"
 
-enum BitRate
+// The export types, by export_type_user_id
+enum ExportType
 {
-	BitRate_500K = 500000,
-	BitRate_250K = 250000,
-	BitRate_125K = 125000
+	Export_Csv,
+	Export_Latency,
+	Export_Binary,
+	Export_Candump,
+	Export_VectorAsc,
+	Export_Pcap
 };
 
 class DeviceNetAnalyzerSettings : public AnalyzerSettings
@@ -25,7 +31,12 @@ public:
 	
 	Channel mDeviceNetChannel;
 	enum BitRate mBitRate;
-	bool mInverted;
+	bool mInverted;
+	enum BitSampling mBitSampling;
+	enum MarkerPolicy mMarkerPolicy;
+	enum ResultDetail mResultDetail;
+	U32 mDecoderThreads;	//0 for one per core
+	enum Reassembly mReassembly;
 
 	BitState Recessive();
 	BitState Dominant();
@@ -34,6 +45,11 @@ protected:
 	std::auto_ptr< AnalyzerSettingInterfaceChannel >	mDeviceNetChannelInterface;
 	std::auto_ptr< AnalyzerSettingInterfaceNumberList >	mBitRateInterface;
 	std::auto_ptr< AnalyzerSettingInterfaceBool > mDeviceNetChannelInvertedInterface;
+	std::auto_ptr< AnalyzerSettingInterfaceNumberList > mBitSamplingInterface;
+	std::auto_ptr< AnalyzerSettingInterfaceNumberList > mMarkerPolicyInterface;
+	std::auto_ptr< AnalyzerSettingInterfaceNumberList > mResultDetailInterface;
+	std::auto_ptr< AnalyzerSettingInterfaceNumberList > mDecoderThreadsInterface;
+	std::auto_ptr< AnalyzerSettingInterfaceNumberList > mReassemblyInterface;
 };
 
 #endif //DEVICENET_ANALYZER_SETTINGS
@@ -0,0 +1,118 @@
+#include "DeviceNetBitBuffer.h"
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+DeviceNetBitBuffer::DeviceNetBitBuffer()
+{
+	Clear();
+}
+
+void DeviceNetBitBuffer::Clear()
+{
+	for (U32 i = 0; i < BIT_BUFFER_NUM_WORDS; i++)
+		mWords[i] = 0;
+
+	mNumBits = 0;
+}
+
+void DeviceNetBitBuffer::Append(bool value, U32 num_bits)
+{
+	if (mNumBits + num_bits > BIT_BUFFER_MAX_BITS)
+		num_bits = BIT_BUFFER_MAX_BITS - mNumBits;
+
+	//the words start out cleared, so only ones need writing -- a whole run per word at a time.
+	U32 index = mNumBits;
+	U32 remaining = num_bits;
+	while ((value == true) && (remaining > 0))
+	{
+		U32 offset = index % 64;
+		U32 count = 64 - offset;
+		if (remaining < count)
+			count = remaining;
+
+		U64 mask = (count == 64) ? ~U64(0) : (((U64(1) << count) - 1) << (64 - offset - count));
+		mWords[index / 64] |= mask;
+
+		index += count;
+		remaining -= count;
+	}
+
+	mNumBits += num_bits;
+}
+
+void DeviceNetBitBuffer::AppendBits(U64 value, U32 num_bits)
+{
+	if (num_bits == 0)
+		return;
+
+	if (mNumBits + num_bits > BIT_BUFFER_MAX_BITS)
+	{
+		value >>= mNumBits + num_bits - BIT_BUFFER_MAX_BITS;	//keep the first ones
+		num_bits = BIT_BUFFER_MAX_BITS - mNumBits;
+		if (num_bits == 0)
+			return;
+	}
+
+	U64 bits = value << (64 - num_bits);
+	U32 word = mNumBits / 64;
+	U32 offset = mNumBits % 64;
+
+	mWords[word] |= bits >> offset;
+	if ((offset != 0) && (offset + num_bits > 64))
+		mWords[word + 1] |= bits << (64 - offset);
+
+	mNumBits += num_bits;
+}
+
+U64 DeviceNetBitBuffer::GetBits(U32 first_bit, U32 num_bits) const
+{
+	if (num_bits == 0)
+		return 0;
+
+	U32 word = first_bit / 64;
+	U32 offset = first_bit % 64;
+
+	U64 value = mWords[word] << offset;
+	if ((offset != 0) && (offset + num_bits > 64))
+		value |= mWords[word + 1] >> (64 - offset);
+
+	return value >> (64 - num_bits);
+}
+
+bool DeviceNetBitBuffer::GetBit(U32 index) const
+{
+	return ((mWords[index / 64] >> (63 - (index % 64))) & 1) != 0;
+}
+
+U32 DeviceNetBitBuffer::CountOnes(U64 word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_popcountll(word);
+#else
+	word = word - ((word >> 1) & 0x5555555555555555ull);
+	word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+	word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+	return U32((word * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+U32 DeviceNetBitBuffer::CountLeadingZeros(U64 word)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanReverse64(&index, word);
+	return 63 - index;
+#elif defined(__GNUC__) || defined(__clang__)
+	return __builtin_clzll(word);
+#else
+	U32 count = 0;
+	while ((word & 0x8000000000000000ull) == 0)
+	{
+		word <<= 1;
+		count++;
+	}
+	return count;
+#endif
+}
@@ -0,0 +1,35 @@
+#ifndef DEVICENET_BIT_BUFFER
+#define DEVICENET_BIT_BUFFER
+
+#include <LogicPublicTypes.h>
+
+//a classic CAN frame is at most 122 bits once the stuff bits are taken out (extended identifier,
+//8 data bytes, CRC and ACK fields).  With the stuff bits still in, we give up on a frame after 256 raw
+//bits (the sample offset table), so four words hold anything we decode.
+#define BIT_BUFFER_NUM_WORDS	4
+#define BIT_BUFFER_MAX_BITS		( BIT_BUFFER_NUM_WORDS * 64 )
+
+//fixed-capacity bit string, packed MSB-first: bit 63 of the first word is bit 0.
+class DeviceNetBitBuffer
+{
+public:
+	DeviceNetBitBuffer();
+
+	void Clear();
+	void Append(bool value, U32 num_bits);	//num_bits copies of the same bit
+	void AppendBits(U64 value, U32 num_bits);	//up to 64 bits, MSB-first, right aligned
+	U64 GetBits(U32 first_bit, U32 num_bits) const;	//up to 64 bits, MSB-first, right aligned
+	bool GetBit(U32 index) const;
+
+	U32 GetNumBits() const { return mNumBits; }
+	const U64* GetWords() const { return mWords; }
+
+	static U32 CountOnes(U64 word);
+	static U32 CountLeadingZeros(U64 word);	//word isn't 0
+
+protected:
+	U64 mWords[BIT_BUFFER_NUM_WORDS];
+	U32 mNumBits;
+};
+
+#endif //DEVICENET_BIT_BUFFER
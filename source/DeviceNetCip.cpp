@@ -0,0 +1,312 @@
+#include "DeviceNetCip.h"
+#include <stddef.h>
+#include "DeviceNetProtocol.h"
+#include "DeviceNetReassembler.h"
+
+//the common services (CIP Appendix A), by service code.
+static const char* const gCommonServiceNames[] =
+{
+	NULL,
+	"Get_Attributes_All",			// 0x01
+	"Set_Attributes_All",
+	"Get_Attribute_List",
+	"Set_Attribute_List",
+	"Reset",
+	"Start",
+	"Stop",
+	"Create",						// 0x08
+	"Delete",
+	"Multiple_Service_Packet",
+	NULL,
+	NULL,
+	"Apply_Attributes",
+	"Get_Attribute_Single",
+	NULL,
+	"Set_Attribute_Single",			// 0x10
+	"Find_Next_Object_Instance",
+	NULL,
+	NULL,
+	"Error_Response",
+	"Restore",
+	"Save",
+	"No_Operation",
+	"Get_Member",					// 0x18
+	"Set_Member",
+	"Insert_Member",
+	"Remove_Member",
+	"GroupSync"
+};
+
+//the general status codes (CIP Appendix B).
+static const char* const gGeneralStatusNames[] =
+{
+	"Success",						// 0x00
+	"Connection failure",
+	"Resource unavailable",
+	"Invalid parameter value",
+	"Path segment error",
+	"Path destination unknown",
+	"Partial transfer",
+	"Connection lost",
+	"Service not supported",		// 0x08
+	"Invalid attribute value",
+	"Attribute list error",
+	"Already in requested mode/state",
+	"Object state conflict",
+	"Object already exists",
+	"Attribute not settable",
+	"Privilege violation",
+	"Device state conflict",		// 0x10
+	"Reply data too large",
+	"Fragmentation of a primitive value",
+	"Not enough data",
+	"Attribute not supported",
+	"Too much data",
+	"Object does not exist",
+	"Service fragmentation sequence not in progress",
+	"No stored attribute data",		// 0x18
+	"Store operation failure",
+	"Routing failure, request packet too large",
+	"Routing failure, response packet too large",
+	"Missing attribute list entry data",
+	"Invalid attribute value list",
+	"Embedded service error",
+	"Vendor specific error",
+	"Invalid parameter",			// 0x20
+	"Write-once value or medium already written",
+	"Invalid reply received",
+	NULL,
+	NULL,
+	"Key failure in path",
+	"Path size invalid",
+	"Unexpected attribute in list",
+	"Invalid member ID",			// 0x28
+	"Member not settable",
+	"Group 2 only server general failure"
+};
+
+DeviceNetCipMessage::DeviceNetCipMessage()
+:	mHeaderMacID( 0 ),
+	mXid( false ),
+	mUnconnected( false ),
+	mResponse( false ),
+	mServiceCode( 0 ),
+	mHasPath( false ),
+	mClassID( 0 ),
+	mInstanceID( 0 ),
+	mHasAttribute( false ),
+	mAttributeID( 0 ),
+	mErrorResponse( false ),
+	mGeneralStatus( 0 ),
+	mAdditionalCode( CIP_NO_ADDITIONAL_CODE ),
+	mServiceData( NULL ),
+	mServiceDataBytes( 0 ),
+	mHeaderBytes( 0 ),
+	mClassBytes( 0 ),
+	mInstanceBytes( 0 )
+{
+}
+
+bool DeviceNetCipMessage::ParseFrame( U32 identifier_class, const U8* data, U32 num_bytes, enum CipBodyFormat body_format )
+{
+	if( num_bytes < 2 )
+		return false;
+
+	if( ( data[ 0 ] & EXPLICIT_HEADER_FRAG ) != 0 )
+		return false;
+
+	mHeaderMacID = data[ 0 ] & EXPLICIT_HEADER_MAC_ID_MASK;
+	mXid = ( ( data[ 0 ] & EXPLICIT_HEADER_XID ) != 0 );
+	mHeaderBytes = 1;
+
+	return Parse( identifier_class, data + 1, num_bytes - 1, body_format );
+}
+
+bool DeviceNetCipMessage::ParseBody( U32 identifier_class, U32 header_mac_id, const U8* body, U32 num_bytes, enum CipBodyFormat body_format )
+{
+	mHeaderMacID = header_mac_id & EXPLICIT_HEADER_MAC_ID_MASK;
+	mXid = false;
+	mHeaderBytes = 0;
+
+	return Parse( identifier_class, body, num_bytes, body_format );
+}
+
+bool DeviceNetCipMessage::Parse( U32 identifier_class, const U8* body, U32 num_bytes, enum CipBodyFormat body_format )
+{
+	if( num_bytes < 1 )
+		return false;
+
+	DeviceNetMessageKind kind = DeviceNetProtocol::GetIdentifierMessageKind( identifier_class );
+
+	mResponse = ( ( body[ 0 ] & CIP_SERVICE_RESPONSE ) != 0 );
+	mServiceCode = body[ 0 ] & CIP_SERVICE_CODE_MASK;
+	mUnconnected = ( ( kind == UnconnectedExplicitRequest ) || ( kind == UnconnectedExplicitResponse ) ) &&
+		( ( mServiceCode == CIP_SERVICE_OPEN_CONNECTION ) || ( mServiceCode == CIP_SERVICE_CLOSE_CONNECTION ) );
+	mHasPath = false;
+	mClassID = 0;
+	mInstanceID = 0;
+	mHasAttribute = false;
+	mAttributeID = 0;
+	mErrorResponse = false;
+	mGeneralStatus = 0;
+	mAdditionalCode = CIP_NO_ADDITIONAL_CODE;
+	mClassBytes = 0;
+	mInstanceBytes = 0;
+
+	U32 used = 1;
+	if( mResponse == true )
+	{
+		if( mServiceCode == CIP_SERVICE_ERROR_RESPONSE )
+		{
+			if( num_bytes < 2 )
+				return false;
+
+			mErrorResponse = true;
+			mGeneralStatus = body[ 1 ];
+			used = 2;
+			if( num_bytes > 2 )
+			{
+				mAdditionalCode = body[ 2 ];
+				used = 3;
+			}
+		}
+	}
+	else if( mUnconnected == false )
+	{
+		mClassBytes = ( ( body_format == CipBodyFormat_16_16 ) || ( body_format == CipBodyFormat_16_8 ) ) ? 2 : 1;
+		mInstanceBytes = ( ( body_format == CipBodyFormat_8_16 ) || ( body_format == CipBodyFormat_16_16 ) ) ? 2 : 1;
+		if( num_bytes < used + mClassBytes + mInstanceBytes )
+			return false;
+
+		//16 bit IDs go low byte first
+		mClassID = body[ used ];
+		if( mClassBytes == 2 )
+			mClassID |= U32( body[ used + 1 ] ) << 8;
+		used += mClassBytes;
+
+		mInstanceID = body[ used ];
+		if( mInstanceBytes == 2 )
+			mInstanceID |= U32( body[ used + 1 ] ) << 8;
+		used += mInstanceBytes;
+
+		mHasPath = true;
+
+		if( ( mServiceCode == CIP_SERVICE_GET_ATTRIBUTE_SINGLE ) || ( mServiceCode == CIP_SERVICE_SET_ATTRIBUTE_SINGLE ) )
+		{
+			if( num_bytes < used + 1 )
+				return false;
+
+			mAttributeID = body[ used ];
+			mHasAttribute = true;
+			used++;
+		}
+	}
+
+	mServiceData = body + used;
+	mServiceDataBytes = num_bytes - used;
+	return true;
+}
+
+enum CipByteRole DeviceNetCipMessage::GetByteRole( U32 offset )
+{
+	if( offset < mHeaderBytes )
+		return CipMessageHeader;
+	offset -= mHeaderBytes;
+
+	if( offset == 0 )
+		return CipServiceCode;
+	offset--;
+
+	if( mErrorResponse == true )
+	{
+		if( offset == 0 )
+			return CipGeneralStatus;
+		if( offset == 1 )
+			return CipAdditionalCode;
+		return CipServiceData;
+	}
+
+	if( mHasPath == true )
+	{
+		if( offset < mClassBytes )
+			return CipClassID;
+		offset -= mClassBytes;
+
+		if( offset < mInstanceBytes )
+			return CipInstanceID;
+		offset -= mInstanceBytes;
+
+		if( ( mHasAttribute == true ) && ( offset == 0 ) )
+			return CipAttributeID;
+	}
+
+	return CipServiceData;
+}
+
+const char* DeviceNetCipMessage::GetServiceName()
+{
+	//the object class specific ones we know: the UCMM's, and the DeviceNet object's for the Predefined
+	//Master/Slave Connection Set.  A response doesn't say what it's to, but the connection management one does.
+	if( ( mServiceCode == CIP_SERVICE_OPEN_CONNECTION ) || ( mServiceCode == CIP_SERVICE_CLOSE_CONNECTION ) )
+	{
+		bool open = ( mServiceCode == CIP_SERVICE_OPEN_CONNECTION );
+
+		if( mUnconnected == true )
+			return ( open == true ) ? "Open_Explicit_Messaging_Connection" : "Close_Connection";
+
+		if( ( ( mHasPath == true ) && ( mClassID == CIP_CLASS_DEVICENET ) ) || ( mResponse == true ) )
+			return ( open == true ) ? "Allocate_Master/Slave_Connection_Set" : "Release_Master/Slave_Connection_Set";
+
+		return NULL;
+	}
+
+	if( mServiceCode < sizeof( gCommonServiceNames ) / sizeof( gCommonServiceNames[ 0 ] ) )
+		return gCommonServiceNames[ mServiceCode ];
+
+	return NULL;
+}
+
+const char* DeviceNetCipMessage::GetServiceRangeName( U32 service_code )
+{
+	if( service_code < START_ADDR_SERVICE_CODE_VENDOR )
+		return "Open";
+	if( service_code < START_ADDR_SERVICE_CODE_OBJECT )
+		return "Vendor Specific";
+	if( service_code < START_ADDR_SERVICE_CODE_RESERVED )
+		return "Object Class Specific";
+	if( service_code < START_ADDR_SERVICE_CODE_INVALID )
+		return "Reserved";
+	return "Invalid";
+}
+
+const char* DeviceNetCipMessage::GetClassRangeName( U32 class_id )
+{
+	if( class_id < START_ADDR_CLASS_ID_VENDOR_1 )
+		return "Open";
+	if( class_id < START_ADDR_CLASS_ID_RESERVED_1 )
+		return "Vendor Specific";
+	if( class_id < START_ADDR_CLASS_ID_OPEN_2 )
+		return "Reserved";
+	if( class_id < START_ADDR_CLASS_ID_VENDOR_2 )
+		return "Open";
+	if( class_id < START_ADDR_CLASS_ID_RESERVED_2 )
+		return "Vendor Specific";
+	return "Reserved";
+}
+
+const char* DeviceNetCipMessage::GetAttributeRangeName( U32 attribute_id )
+{
+	if( attribute_id < START_ADDR_ATTRIBUTE_ID_VENDOR )
+		return "Open";
+	if( attribute_id < START_ADDR_ATTRIBUTE_ID_RESERVED )
+		return "Vendor Specific";
+	return "Reserved";
+}
+
+const char* DeviceNetCipMessage::GetGeneralStatusName( U32 general_status )
+{
+	if( general_status < sizeof( gGeneralStatusNames ) / sizeof( gGeneralStatusNames[ 0 ] ) )
+		return gGeneralStatusNames[ general_status ];
+
+	return NULL;
+}
@@ -0,0 +1,100 @@
+#ifndef DEVICENET_CIP
+#define DEVICENET_CIP
+
+#include <LogicPublicTypes.h>
+
+/*	The CIP message an explicit message carries
+
+	An explicit message starts with the message header (Frag, XID, and the MAC ID of the other end), then the
+	service code, with the R/R bit set in a response.  A request names the object it's for by class and instance
+	ID -- 8 or 16 bits each, the connection's message body format -- and Get_Attribute_Single and
+	Set_Attribute_Single the attribute after that; the rest is the service's data.  A response is the service
+	data only, but for the Error Response, which is the general status and an additional code.  The UCMM's own
+	services, opening and closing explicit messaging connections, don't go to an object: no class or instance.
+
+	DeviceNetCipMessage takes a message apart where it is: the service data is a view of the bytes it was given,
+	which have to stay put as long as it's used.  Nothing is copied, and the names it has are string constants.
+*/
+
+#define CIP_SERVICE_RESPONSE			0x80	// the R/R bit
+#define CIP_SERVICE_CODE_MASK			0x7F
+#define CIP_SERVICE_GET_ATTRIBUTE_SINGLE	0x0E
+#define CIP_SERVICE_SET_ATTRIBUTE_SINGLE	0x10
+#define CIP_SERVICE_ERROR_RESPONSE		0x14
+#define CIP_SERVICE_OPEN_CONNECTION		0x4B	// UCMM: Open Explicit Messaging Connection; DeviceNet object: Allocate
+#define CIP_SERVICE_CLOSE_CONNECTION	0x4C	// UCMM: Close Connection; DeviceNet object: Release
+#define CIP_CLASS_DEVICENET				0x03
+#define CIP_NO_ADDITIONAL_CODE			0xFF
+
+// How a request's class and instance ID go, as in the UCMM's Open request
+enum CipBodyFormat
+{
+	CipBodyFormat_8_8,		// the Predefined Master/Slave Connection Set's
+	CipBodyFormat_8_16,
+	CipBodyFormat_16_16,
+	CipBodyFormat_16_8
+};
+
+// What a byte of an explicit message is
+enum CipByteRole
+{
+	CipMessageHeader,
+	CipServiceCode,
+	CipClassID,
+	CipInstanceID,
+	CipAttributeID,
+	CipGeneralStatus,
+	CipAdditionalCode,
+	CipServiceData
+};
+
+class DeviceNetCipMessage
+{
+public:
+	DeviceNetCipMessage();
+
+	//a whole explicit message in one frame, header first: false for a fragment, or too little for a message.
+	bool ParseFrame( U32 identifier_class, const U8* data, U32 num_bytes, enum CipBodyFormat body_format );
+
+	//an explicit message without its header (one put back together from fragments), to or from header_mac_id.
+	bool ParseBody( U32 identifier_class, U32 header_mac_id, const U8* body, U32 num_bytes, enum CipBodyFormat body_format );
+
+	//what the byte at offset is, in what was parsed.
+	enum CipByteRole GetByteRole( U32 offset );
+
+	//the service's name, or NULL for one we don't know by name.
+	const char* GetServiceName();
+
+	//the range a number is in ("Open", "Vendor Specific", ...), and a general status' meaning (NULL if unknown).
+	static const char* GetServiceRangeName( U32 service_code );
+	static const char* GetClassRangeName( U32 class_id );
+	static const char* GetAttributeRangeName( U32 attribute_id );
+	static const char* GetGeneralStatusName( U32 general_status );
+
+	U32 mHeaderMacID;
+	bool mXid;
+	bool mUnconnected;		//on the UCMM's own identifiers
+	bool mResponse;
+	U32 mServiceCode;		//without the R/R bit
+	bool mHasPath;			//a request to an object: class and instance ID
+	U32 mClassID;
+	U32 mInstanceID;
+	bool mHasAttribute;
+	U32 mAttributeID;
+	bool mErrorResponse;
+	U32 mGeneralStatus;
+	U32 mAdditionalCode;	//CIP_NO_ADDITIONAL_CODE if there's none
+	const U8* mServiceData;	//into what was parsed
+	U32 mServiceDataBytes;
+
+protected: //functions
+	bool Parse( U32 identifier_class, const U8* body, U32 num_bytes, enum CipBodyFormat body_format );
+
+protected: //vars
+	//where things are, for GetByteRole
+	U32 mHeaderBytes;
+	U32 mClassBytes;
+	U32 mInstanceBytes;
+};
+
+#endif //DEVICENET_CIP
@@ -0,0 +1,404 @@
+#include "DeviceNetConnectionTracker.h"
+#include "DeviceNetCip.h"
+#include "DeviceNetReassembler.h"
+#include <string.h>
+
+//a slave's change of state or cyclic connection, if it has one: they go on the same identifiers.
+static enum DeviceNetConnection GetChangeOfStateConnection( U32 allocated )
+{
+	if( ( allocated & ALLOCATE_CYCLIC ) != 0 )
+		return CyclicConnection;
+
+	if( ( allocated & ALLOCATE_CHANGE_OF_STATE ) != 0 )
+		return ChangeOfStateConnection;
+
+	return NoConnection;
+}
+
+DeviceNetConnectionTracker::DeviceNetConnectionTracker()
+:	mListener( NULL ),
+	mLatency( NULL ),
+	mHasMessage( false ),
+	mNumDataBytes( 0 )
+{
+	memset( mNodes, 0, sizeof( mNodes ) );
+}
+
+DeviceNetConnectionTracker::~DeviceNetConnectionTracker()
+{
+}
+
+void DeviceNetConnectionTracker::Start( DeviceNetLatencyStats* latency, DeviceNetDecoderListener* listener )
+{
+	mListener = listener;
+	mLatency = latency;
+	mHasMessage = false;
+	mNumDataBytes = 0;
+
+	memset( mNodes, 0, sizeof( mNodes ) );
+}
+
+void DeviceNetConnectionTracker::OnRecord( const DeviceNetRecord& record )
+{
+	bool labelled = false;
+
+	switch( record.mType )
+	{
+	case IdentifierField:
+	case IdentifierFieldEx:
+		mHasMessage = false;
+		mStandardCan = ( record.mType == IdentifierField );
+		mCrcError = false;
+		mIdentifier = U32( record.mData1 & COMPACT_IDENTIFIER_MASK );
+		mNumDataBytes = 0;
+		labelled = ( mStandardCan == true ) && ( ( record.mFlags & REMOTE_FRAME ) == 0 );
+		break;
+	case DataField:
+		if( mNumDataBytes < 8 )
+			mData[ mNumDataBytes++ ] = U8( record.mData1 );
+		break;
+	case CrcField:
+		mCrcError = ( ( record.mFlags & CRC_ERROR ) != 0 );
+		break;
+	case AckField:
+		mAck = ( record.mData1 != 0 );
+		mHasMessage = true;
+		break;
+	case CanMessage:
+	{
+		U8 flags = U8( record.mData1 >> COMPACT_FLAGS_SHIFT );
+		mStandardCan = ( ( flags & EXTENDED_IDENTIFIER ) == 0 );
+		mCrcError = ( ( flags & CRC_ERROR ) != 0 );
+		mAck = ( ( flags & ACK_RECEIVED ) != 0 );
+		mIdentifier = U32( record.mData1 & COMPACT_IDENTIFIER_MASK );
+
+		mNumDataBytes = U32( record.mData1 >> COMPACT_DLC_SHIFT ) & COMPACT_DLC_MASK;
+		if( mNumDataBytes > 8 )
+			mNumDataBytes = 8;
+		if( ( flags & REMOTE_FRAME ) != 0 )
+			mNumDataBytes = 0;
+		for( U32 i = 0; i < mNumDataBytes; i++ )
+			mData[ i ] = U8( record.mData2 >> ( 56 - 8 * i ) );
+
+		mHasMessage = true;
+		labelled = ( mStandardCan == true ) && ( ( flags & REMOTE_FRAME ) == 0 );
+	}
+	break;
+	case DeviceNetError:
+		mHasMessage = false;
+		break;
+	}
+
+	//the identifier gets the connection it's on as things are now: what this message changes is for the next.
+	if( labelled == true )
+	{
+		enum DeviceNetConnection connection = GetConnection( DeviceNetProtocol::ClassifyIdentifier( mIdentifier ) );
+		if( connection != NoConnection )
+		{
+			DeviceNetRecord with_connection = record;
+			with_connection.mData1 |= U64( connection ) << CONNECTION_SHIFT;
+			mListener->OnRecord( with_connection );
+			return;
+		}
+	}
+
+	mListener->OnRecord( record );
+}
+
+void DeviceNetConnectionTracker::OnMarker( U64 sample, DeviceNetMarkerType type )
+{
+	mListener->OnMarker( sample, type );
+}
+
+void DeviceNetConnectionTracker::OnEventEnd( const DeviceNetEventInfo& info )
+{
+	mListener->OnEventEnd( info );
+
+	if( mHasMessage == true )
+	{
+		mStartOfFrame = info.mStartOfFrame;
+		AddMessage();
+	}
+
+	mHasMessage = false;
+}
+
+enum DeviceNetConnection DeviceNetConnectionTracker::GetConnection( U32 identifier_class )
+{
+	IdentifierType group = DeviceNetProtocol::GetIdentifierGroup( identifier_class );
+	U32 message_id = DeviceNetProtocol::GetIdentifierMessageID( identifier_class );
+	const Node& node = mNodes[ DeviceNetProtocol::GetIdentifierMacID( identifier_class ) ];
+
+	//the slave's messages in Group 1, with its MAC ID
+	if( group == MessageGroup1 )
+	{
+		switch( message_id )
+		{
+		case 0xC:
+			return ( ( node.mAllocated & ALLOCATE_MULTICAST_POLLED ) != 0 ) ? MulticastPollConnection : NoConnection;
+		case 0xD:
+			return GetChangeOfStateConnection( node.mAllocated );
+		case 0xE:
+			return ( ( node.mAllocated & ALLOCATE_BIT_STROBED ) != 0 ) ? BitStrobeConnection : NoConnection;
+		case 0xF:
+			return ( ( node.mAllocated & ALLOCATE_POLLED ) != 0 ) ? PollConnection : GetChangeOfStateConnection( node.mAllocated );
+		}
+
+		return NoConnection;
+	}
+
+	//the master's in Group 2: the bit strobe and multicast poll commands have its MAC ID, the rest the slave's
+	if( group == MessageGroup2 )
+	{
+		switch( message_id )
+		{
+		case 0:
+			return ( node.mNumBitStrobed != 0 ) ? BitStrobeConnection : NoConnection;
+		case 1:
+			return ( node.mNumMulticastPolled != 0 ) ? MulticastPollConnection : NoConnection;
+		case 2:
+			return GetChangeOfStateConnection( node.mAllocated );
+		case 3:
+		case 4:
+			return ( ( node.mAllocated & ALLOCATE_EXPLICIT ) != 0 ) ? ExplicitConnection : NoConnection;
+		case 5:
+			return ( ( node.mAllocated & ALLOCATE_POLLED ) != 0 ) ? PollConnection : GetChangeOfStateConnection( node.mAllocated );
+		}
+	}
+
+	return NoConnection;
+}
+
+const char* DeviceNetConnectionTracker::GetConnectionMessageName( U32 identifier_class, enum DeviceNetConnection connection )
+{
+	if( connection == NoConnection )
+		return NULL;
+
+	IdentifierType group = DeviceNetProtocol::GetIdentifierGroup( identifier_class );
+	U32 message_id = DeviceNetProtocol::GetIdentifierMessageID( identifier_class );
+	bool cyclic = ( connection == CyclicConnection );
+
+	if( group == MessageGroup1 )
+	{
+		switch( message_id )
+		{
+		case 0xC:
+			return "Multicast Poll Response";
+		case 0xD:
+			return ( cyclic == true ) ? "Cyclic Message" : "Change of State Message";
+		case 0xE:
+			return "Bit-Strobe Response";
+		case 0xF:
+			if( connection == PollConnection )
+				return "Poll Response";
+			return ( cyclic == true ) ? "Cyclic Acknowledge" : "Change of State Acknowledge";
+		}
+	}
+	else if( group == MessageGroup2 )
+	{
+		switch( message_id )
+		{
+		case 0:
+			return "Bit-Strobe Command";
+		case 1:
+			return "Multicast Poll Command";
+		case 2:
+			return ( cyclic == true ) ? "Cyclic Acknowledge" : "Change of State Acknowledge";
+		case 3:
+			return "Explicit Response";
+		case 4:
+			return "Explicit Request";
+		case 5:
+			if( connection == PollConnection )
+				return "Poll Command";
+			return ( cyclic == true ) ? "Cyclic Message" : "Change of State Message";
+		}
+	}
+
+	return NULL;
+}
+
+void DeviceNetConnectionTracker::AddMessage()
+{
+	if( ( mStandardCan == false ) || ( mCrcError == true ) || ( mAck == false ) )
+		return;
+
+	U32 identifier_class = DeviceNetProtocol::ClassifyIdentifier( mIdentifier );
+	IdentifierType group = DeviceNetProtocol::GetIdentifierGroup( identifier_class );
+	U32 message_id = DeviceNetProtocol::GetIdentifierMessageID( identifier_class );
+	U32 mac_id = DeviceNetProtocol::GetIdentifierMacID( identifier_class );
+
+	//timed with the connections it went on, before it changes them
+	if( mLatency != NULL )
+		TimeMessage( identifier_class );
+
+	if( group != MessageGroup2 )
+		return;
+
+	Node& node = mNodes[ mac_id ];
+
+	//a Duplicate MAC ID check request (not a response from the device that has it already): a device coming
+	//online, with nothing allocated -- the slaves it had as a master time out.
+	if( DeviceNetProtocol::GetIdentifierMessageKind( identifier_class ) == DuplicateMacIdCheckMessage )
+	{
+		if( ( mNumDataBytes == 0 ) || ( ( mData[ 0 ] & 0x80 ) != 0 ) )
+			return;
+
+		SetAllocated( mac_id, 0, 0 );
+		node.mRequestedService = 0;
+
+		for( U32 slave = 0; slave < NUM_MAC_IDS; slave++ )
+		{
+			if( ( mNodes[ slave ].mAllocated != 0 ) && ( mNodes[ slave ].mMaster == mac_id ) )
+				SetAllocated( slave, 0, 0 );
+		}
+		return;
+	}
+
+	if( DeviceNetProtocol::IsExplicitConnection( identifier_class ) == false )
+		return;
+
+	//Allocate and Release always use the 8/8 message body format.
+	DeviceNetCipMessage message;
+	if( message.ParseFrame( identifier_class, mData, mNumDataBytes, CipBodyFormat_8_8 ) == false )
+		return;
+
+	if( message.mResponse == false )
+	{
+		//the master's request to the slave's DeviceNet object
+		if( ( message.mHasPath == false ) || ( message.mClassID != CIP_CLASS_DEVICENET ) )
+			return;
+
+		if( ( message.mServiceCode == CIP_SERVICE_OPEN_CONNECTION ) && ( message.mServiceDataBytes >= 2 ) )
+		{
+			node.mRequestedService = U8( message.mServiceCode );
+			node.mRequestedChoice = message.mServiceData[ 0 ];
+			node.mRequestedMaster = message.mServiceData[ 1 ] & EXPLICIT_HEADER_MAC_ID_MASK;
+		}
+		else if( ( message.mServiceCode == CIP_SERVICE_CLOSE_CONNECTION ) && ( message.mServiceDataBytes >= 1 ) )
+		{
+			node.mRequestedService = U8( message.mServiceCode );
+			node.mRequestedChoice = message.mServiceData[ 0 ];
+			node.mRequestedMaster = node.mMaster;
+		}
+		return;
+	}
+
+	//the slave's response: it took, or it didn't
+	if( ( message_id != 3 ) || ( node.mRequestedService == 0 ) )
+		return;
+
+	if( message.mServiceCode == node.mRequestedService )
+	{
+		if( node.mRequestedService == CIP_SERVICE_OPEN_CONNECTION )
+			SetAllocated( mac_id, node.mAllocated | node.mRequestedChoice, node.mRequestedMaster );
+		else
+			SetAllocated( mac_id, node.mAllocated & ~node.mRequestedChoice, node.mMaster );
+
+		node.mRequestedService = 0;
+	}
+	else if( message.mErrorResponse == true )
+	{
+		node.mRequestedService = 0;
+	}
+}
+
+void DeviceNetConnectionTracker::TimeMessage( U32 identifier_class )
+{
+	IdentifierType group = DeviceNetProtocol::GetIdentifierGroup( identifier_class );
+	U32 message_id = DeviceNetProtocol::GetIdentifierMessageID( identifier_class );
+	U32 mac_id = DeviceNetProtocol::GetIdentifierMacID( identifier_class );
+
+	//poll commands go to the slave and come back from it, on its MAC ID
+	if( ( group == MessageGroup2 ) && ( message_id == 5 ) )
+	{
+		enum DeviceNetConnection connection = GetConnection( identifier_class );
+		if( ( connection == NoConnection ) || ( connection == PollConnection ) )
+			StartRequest( mac_id, PollLatency, 0 );
+		return;
+	}
+
+	if( ( group == MessageGroup1 ) && ( message_id == 0xF ) )
+	{
+		EndRequest( mac_id, PollLatency, 0 );
+		return;
+	}
+
+	if( ( DeviceNetProtocol::IsExplicitConnection( identifier_class ) == false ) || ( mNumDataBytes < 2 ) )
+		return;
+
+	//the first frame of a message only: acknowledgements and the fragments after the first don't count
+	U32 header_mac_id = mData[ 0 ] & EXPLICIT_HEADER_MAC_ID_MASK;
+	U32 service = mData[ 1 ];
+	if( ( mData[ 0 ] & EXPLICIT_HEADER_FRAG ) != 0 )
+	{
+		if( ( mData[ 1 ] >> FRAGMENT_TYPE_SHIFT ) != FRAGMENT_TYPE_FIRST )
+			return;
+		if( mNumDataBytes < 3 )
+			return;
+		service = mData[ 2 ];
+	}
+
+	//Group 2 has the slave's MAC ID either way, and the master's in the header; in Group 3 it's the sender's
+	if( group == MessageGroup2 )
+	{
+		if( ( message_id == 4 ) || ( message_id == CHECK_GROUP_2_MSG_ID_IS_CONNECTION_MANAGEMENT ) )
+			StartRequest( mac_id, ExplicitLatency, header_mac_id );
+		else if( message_id == 3 )
+			EndRequest( mac_id, ExplicitLatency, header_mac_id );
+		return;
+	}
+
+	bool response = ( ( service & CIP_SERVICE_RESPONSE ) != 0 );
+	if( message_id == CHECK_GROUP_3_MSG_ID_IS_EXPLICIT_REQUEST )
+		response = false;
+	else if( message_id == CHECK_GROUP_3_MSG_ID_IS_EXPLICIT_RESPONSE )
+		response = true;
+
+	if( response == false )
+		StartRequest( header_mac_id, ExplicitLatency, mac_id );
+	else
+		EndRequest( mac_id, ExplicitLatency, header_mac_id );
+}
+
+void DeviceNetConnectionTracker::StartRequest( U32 responder, enum DeviceNetLatencyKind kind, U32 requester )
+{
+	Node& node = mNodes[ responder ];
+
+	if( node.mPending[ kind ] == true )
+		mLatency->AddUnanswered( responder, kind );
+
+	node.mPending[ kind ] = true;
+	node.mRequester[ kind ] = U8( requester );
+	node.mRequestStart[ kind ] = mStartOfFrame;
+}
+
+void DeviceNetConnectionTracker::EndRequest( U32 responder, enum DeviceNetLatencyKind kind, U32 requester )
+{
+	Node& node = mNodes[ responder ];
+
+	if( ( node.mPending[ kind ] == false ) || ( node.mRequester[ kind ] != requester ) )
+		return;
+
+	mLatency->AddLatency( responder, kind, mStartOfFrame - node.mRequestStart[ kind ] );
+	node.mPending[ kind ] = false;
+}
+
+void DeviceNetConnectionTracker::SetAllocated( U32 slave, U32 allocated, U32 master )
+{
+	Node& node = mNodes[ slave ];
+
+	//the master's bit strobe and multicast poll commands go to the slaves that have those connections
+	if( ( node.mAllocated & ALLOCATE_BIT_STROBED ) != 0 )
+		mNodes[ node.mMaster ].mNumBitStrobed--;
+	if( ( node.mAllocated & ALLOCATE_MULTICAST_POLLED ) != 0 )
+		mNodes[ node.mMaster ].mNumMulticastPolled--;
+
+	node.mAllocated = U8( allocated );
+	node.mMaster = ( allocated != 0 ) ? U8( master ) : 0;
+
+	if( ( node.mAllocated & ALLOCATE_BIT_STROBED ) != 0 )
+		mNodes[ node.mMaster ].mNumBitStrobed++;
+	if( ( node.mAllocated & ALLOCATE_MULTICAST_POLLED ) != 0 )
+		mNodes[ node.mMaster ].mNumMulticastPolled++;
+}
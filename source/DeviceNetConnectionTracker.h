@@ -0,0 +1,100 @@
+#ifndef DEVICENET_CONNECTION_TRACKER
+#define DEVICENET_CONNECTION_TRACKER
+
+#include <LogicPublicTypes.h>
+#include "DeviceNetDecoder.h"
+#include "DeviceNetLatency.h"
+
+/*	The Predefined Master/Slave Connection Set, as the master sets it up
+
+	A master allocates a slave's connections with an Allocate_Master/Slave_Connection_Set request (on Group 2
+	Message ID 6, the Group 2 only unconnected port, or on the explicit connection), and gives them back with
+	Release_Master/Slave_Connection_Set; the slave's response says whether it took.  What a connection's I/O
+	messages go on is fixed by the set, but some identifiers are shared: the master's Group 2 Message ID 5 is a
+	poll command or a change of state / cyclic message, and the slave's Group 1 Message ID 15 a poll response
+	or an acknowledgement of one.  Which it is depends on what was allocated.
+
+	The tracker follows that for every MAC ID in a flat table, and labels the identifier of every frame going
+	through with the connection it belongs to (see CONNECTION_SHIFT): one table lookup per frame, and the table
+	only changes on connection management.  A device that goes through the Duplicate MAC ID check has just come
+	online, so has no connections (and its slaves lose theirs).
+
+	On the way, it pairs poll commands with poll responses and explicit requests with their responses, for the
+	latency statistics (see DeviceNetLatency.h).  A poll command is the master's Group 2 Message ID 5 to the
+	slave, unless the slave has a change of state or cyclic connection and no poll connection.  An explicit
+	request and its response are told apart by identifier where the Predefined Master/Slave Connection Set
+	gives them their own, and by the R/R bit of the service code otherwise; a fragmented message is timed from
+	its first fragment.
+*/
+
+// The allocation choice and release choice byte
+#define ALLOCATE_EXPLICIT			( 1 << 0 )
+#define ALLOCATE_POLLED				( 1 << 1 )
+#define ALLOCATE_BIT_STROBED		( 1 << 2 )
+#define ALLOCATE_MULTICAST_POLLED	( 1 << 3 )
+#define ALLOCATE_CHANGE_OF_STATE	( 1 << 4 )
+#define ALLOCATE_CYCLIC				( 1 << 5 )
+#define ALLOCATE_ACK_SUPPRESSION	( 1 << 6 )
+
+class DeviceNetConnectionTracker : public DeviceNetDecoderListener
+{
+public:
+	DeviceNetConnectionTracker();
+	virtual ~DeviceNetConnectionTracker();
+
+	//starts over with nothing allocated: everything goes to listener, labelled, and the times it takes devices to
+	//answer to latency (if it's not NULL).
+	void Start( DeviceNetLatencyStats* latency, DeviceNetDecoderListener* listener );
+
+	virtual void OnRecord( const DeviceNetRecord& record );
+	virtual void OnMarker( U64 sample, DeviceNetMarkerType type );
+	virtual void OnEventEnd( const DeviceNetEventInfo& info );
+
+	//the connection a message on this identifier belongs to, with what's allocated now.
+	enum DeviceNetConnection GetConnection( U32 identifier_class );
+
+	//what a labelled message is ("Poll Command", ...), or NULL if it has no connection.
+	static const char* GetConnectionMessageName( U32 identifier_class, enum DeviceNetConnection connection );
+
+protected: //functions
+	void AddMessage();
+	void TimeMessage( U32 identifier_class );
+	void StartRequest( U32 responder, enum DeviceNetLatencyKind kind, U32 requester );
+	void EndRequest( U32 responder, enum DeviceNetLatencyKind kind, U32 requester );
+	void SetAllocated( U32 slave, U32 allocated, U32 master );
+
+protected: //vars
+	DeviceNetDecoderListener* mListener;
+	DeviceNetLatencyStats* mLatency;
+
+	//the event going through: a data frame, if it makes it to the ACK delimiter
+	bool mHasMessage;
+	bool mStandardCan;
+	bool mCrcError;
+	bool mAck;
+	U32 mIdentifier;
+	U32 mNumDataBytes;
+	U8 mData[ 8 ];
+	U64 mStartOfFrame;
+
+	//one per MAC ID: as a slave, what it has and what it was asked for last; as a master, how many slaves take
+	//its bit strobe and multicast poll commands; and as a responder, the request of each kind it has yet to answer.
+	class Node
+	{
+	public:
+		U8 mAllocated;
+		U8 mMaster;
+		U8 mRequestedService;	//Allocate or Release, until the response; 0 when none is pending
+		U8 mRequestedChoice;
+		U8 mRequestedMaster;
+		U8 mNumBitStrobed;
+		U8 mNumMulticastPolled;
+		bool mPending[ NumLatencyKinds ];
+		U8 mRequester[ NumLatencyKinds ];
+		U64 mRequestStart[ NumLatencyKinds ];
+	};
+
+	Node mNodes[ NUM_MAC_IDS ];
+};
+
+#endif //DEVICENET_CONNECTION_TRACKER
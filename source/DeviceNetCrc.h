@@ -0,0 +1,25 @@
+#ifndef DEVICENET_CRC
+#define DEVICENET_CRC
+
+#include <LogicPublicTypes.h>
+
+/*	CAN CRC-15 (Standard Format as well as Extended Format)
+
+	The CRC SEQUENCE is the remainder of the destuffed bit stream from START OF FRAME to the end
+	of the DATA FIELD, divided by the generator polynomial X15 + X14 + X10 + X8 + X7 + X4 + X3 + 1.
+
+	Both the analyzer and the simulation data generator pass the bits packed MSB-first into 64-bit
+	words: bit 63 of the first word is the first bit on the bus, and a '1' is a recessive bit.
+	Whole bytes go through a 256-entry table, whatever is left over is done one bit at a time.
+*/
+
+#define CRC_15_POLYNOMIAL	0x4599
+#define CRC_15_MASK			0x7FFF
+
+class DeviceNetCrc
+{
+public:
+	static U16 Compute(const U64* bits, U32 num_bits);
+};
+
+#endif //DEVICENET_CRC
@@ -0,0 +1,386 @@
+#include "DeviceNetDecodeCache.h"
+#include "DeviceNetProtocol.h"
+#include <algorithm>
+#include <cstddef>
+
+DeviceNetDecodeCache::DeviceNetDecodeCache()
+:	mValid( false ),
+	mNumBytes( 0 ),
+	mLastSample( 0 ),
+	mFull( false ),
+	mHasState( false ),
+	mListener( NULL ),
+	mResultDetail( Results_Fields ),
+	mMarkerPolicy( Markers_StuffBitsAndErrors ),
+	mCompactEndingSample( 0 )
+{
+}
+
+DeviceNetDecodeCache::~DeviceNetDecodeCache()
+{
+}
+
+void DeviceNetDecodeCache::SetListener( const DeviceNetDecoderSettings& settings, DeviceNetDecoderListener* listener )
+{
+	mListener = listener;
+	mResultDetail = settings.mResultDetail;
+	mMarkerPolicy = settings.mMarkerPolicy;
+	mCompactEndingSample = 0;
+}
+
+bool DeviceNetDecodeCache::CanReplay( const DeviceNetDecoderSettings& settings, const std::vector<U64>& first_edges, BitState initial_state, U64 initial_sample )
+{
+	if( ( mValid == false ) || ( mHasState == false ) )
+		return false;
+
+	//the frames themselves have to come out the same: messages can be made of fields but not the other way
+	//round, and any markers but every bit's can be picked out of the ones we have.
+	if( ( settings.mSampleRateHz != mSettings.mSampleRateHz ) || ( settings.mBitRate != mSettings.mBitRate ) )
+		return false;
+	if( ( settings.mInverted != mSettings.mInverted ) || ( settings.mBitSampling != mSettings.mBitSampling ) )
+		return false;
+	if( ( settings.mMarkerPolicy == Markers_EveryBit ) && ( mSettings.mMarkerPolicy != Markers_EveryBit ) )
+		return false;
+	if( ( settings.mResultDetail == Results_Fields ) && ( mSettings.mResultDetail != Results_Fields ) )
+		return false;
+
+	//the same capture, or more of it.  If it had just a few edges when we started, we can't tell.
+	if( ( initial_state != mCaptureState ) || ( initial_sample != mCaptureSample ) )
+		return false;
+	if( ( mCaptureEdges.size() < DECODE_CACHE_CAPTURE_EDGES ) && ( first_edges.size() != mCaptureEdges.size() ) )
+		return false;
+	if( first_edges.size() < mCaptureEdges.size() )
+		return false;
+
+	return std::equal( mCaptureEdges.begin(), mCaptureEdges.end(), first_edges.begin() );
+}
+
+void DeviceNetDecodeCache::Start( const DeviceNetDecoderSettings& settings, const std::vector<U64>& first_edges, BitState initial_state, U64 initial_sample )
+{
+	mValid = true;
+	mSettings = settings;
+	if( mSettings.mMarkerPolicy == Markers_None )
+		mSettings.mMarkerPolicy = Markers_StuffBitsAndErrors;
+	mCaptureEdges = first_edges;
+	mCaptureState = initial_state;
+	mCaptureSample = initial_sample;
+
+	mBlocks.clear();
+	mNumBytes = 0;
+	mLastSample = 0;
+	mFull = false;
+
+	mHasState = false;
+	mSavedBlocks = 0;
+	mSavedBlockBytes = 0;
+	mSavedNumBytes = 0;
+	mSavedLastSample = 0;
+
+	mRecords.clear();
+	mMarkers.clear();
+}
+
+void DeviceNetDecodeCache::Replay( DeviceNetDecoderState& state )
+{
+	//a run that got cut short may have left events after the saved state: the decoder will find them again.
+	RollBack();
+	mRecords.clear();
+	mMarkers.clear();
+
+	U64 last_sample = 0;
+
+	for( U32 i = 0; i < mBlocks.size(); i++ )
+	{
+		const U8* data = mBlocks[ i ].data();
+		const U8* end = data + mBlocks[ i ].size();
+
+		while( data < end )
+		{
+			U32 num_records = U32( ReadVarint( data ) );
+			U32 num_markers = U32( ReadVarint( data ) );
+			U8 has_info = *data++;
+
+			DeviceNetEventInfo info;
+			info.mStartOfFrame = ( ( has_info & 1 ) != 0 ) ? ReadSample( data, last_sample ) : END_OF_EDGES;
+			info.mFlagStart = ( ( has_info & 2 ) != 0 ) ? ReadSample( data, last_sample ) : END_OF_EDGES;
+
+			for( U32 j = 0; j < num_records; j++ )
+			{
+				DeviceNetRecord record;
+				record.mStartingSampleInclusive = ReadSample( data, last_sample );
+				record.mEndingSampleInclusive = ReadSample( data, last_sample );
+				record.mType = *data++;
+				record.mFlags = *data++;
+				record.mData1 = ReadVarint( data );
+				record.mData2 = ReadVarint( data );
+				mRecords.push_back( record );
+			}
+
+			for( U32 j = 0; j < num_markers; j++ )
+			{
+				U64 marker = ReadVarint( data );
+				U64 sample = UnZigZag( marker >> 2, last_sample );
+				mMarkers.push_back( ( sample << 2 ) | ( marker & 3 ) );
+			}
+
+			Present( info );
+		}
+	}
+
+	state = mState;
+}
+
+const DeviceNetDecoderSettings& DeviceNetDecodeCache::GetDecodeSettings()
+{
+	return mSettings;
+}
+
+U32 DeviceNetDecodeCache::GetBitRate()
+{
+	return mState.mBitRate;
+}
+
+void DeviceNetDecodeCache::SaveState( const DeviceNetDecoderState& state )
+{
+	if( mFull == true )
+		return;
+
+	mState = state;
+	mHasState = true;
+	mSavedBlocks = U32( mBlocks.size() );
+	mSavedBlockBytes = ( mBlocks.empty() == true ) ? 0 : U32( mBlocks.back().size() );
+	mSavedNumBytes = mNumBytes;
+	mSavedLastSample = mLastSample;
+}
+
+void DeviceNetDecodeCache::RollBack()
+{
+	mBlocks.resize( mSavedBlocks );
+	if( mBlocks.empty() == false )
+		mBlocks.back().resize( mSavedBlockBytes );
+
+	mNumBytes = mSavedNumBytes;
+	mLastSample = mSavedLastSample;
+}
+
+void DeviceNetDecodeCache::OnRecord( const DeviceNetRecord& record )
+{
+	mRecords.push_back( record );
+}
+
+void DeviceNetDecodeCache::OnMarker( U64 sample, DeviceNetMarkerType type )
+{
+	mMarkers.push_back( ( sample << 2 ) | U64( type ) );
+}
+
+void DeviceNetDecodeCache::OnEventEnd( const DeviceNetEventInfo& info )
+{
+	if( mFull == false )
+		Store( info );
+
+	Present( info );
+}
+
+void DeviceNetDecodeCache::Present( const DeviceNetEventInfo& info )
+{
+	if( ( mResultDetail == Results_Compact ) && ( mSettings.mResultDetail == Results_Fields ) )
+	{
+		PresentCompact( info );
+	}
+	else
+	{
+		for( U32 i = 0; i < mRecords.size(); i++ )
+			mListener->OnRecord( mRecords[ i ] );
+	}
+
+	if( mMarkerPolicy != Markers_None )
+	{
+		for( U32 i = 0; i < mMarkers.size(); i++ )
+		{
+			DeviceNetMarkerType type = DeviceNetMarkerType( mMarkers[ i ] & 3 );
+			if( ( type == BitMarker ) && ( mMarkerPolicy != Markers_EveryBit ) )
+				continue;
+
+			mListener->OnMarker( mMarkers[ i ] >> 2, type );
+		}
+	}
+
+	mListener->OnEventEnd( info );
+
+	mRecords.clear();
+	mMarkers.clear();
+}
+
+void DeviceNetDecodeCache::PresentCompact( const DeviceNetEventInfo& info )
+{
+	//what the decoder gives us in compact mode: a message for a frame that got through its ACK delimiter, and the
+	//error or overload frame -- moved clear of the last message or error frame, rather than the last field.
+	const DeviceNetRecord* identifier = NULL;
+	const DeviceNetRecord* control = NULL;
+	const DeviceNetRecord* crc = NULL;
+	U64 data = 0;
+	U32 num_bytes = 0;
+
+	for( U32 i = 0; i < mRecords.size(); i++ )
+	{
+		const DeviceNetRecord& record = mRecords[ i ];
+
+		switch( record.mType )
+		{
+		case IdentifierField:
+		case IdentifierFieldEx:
+			identifier = &record;
+			break;
+		case ControlField:
+			control = &record;
+			break;
+		case DataField:
+			data = ( data << 8 ) | record.mData1;
+			num_bytes++;
+			break;
+		case CrcField:
+			crc = &record;
+			break;
+		case AckField:
+			{
+				U8 flags = identifier->mFlags & REMOTE_FRAME;
+				if( ( crc->mFlags & CRC_ERROR ) != 0 )
+					flags |= CRC_ERROR;
+				if( identifier->mType == IdentifierFieldEx )
+					flags |= EXTENDED_IDENTIFIER;
+				if( record.mData1 != 0 )
+					flags |= ACK_RECEIVED;
+
+				DeviceNetRecord frame;
+				frame.mStartingSampleInclusive = info.mStartOfFrame;
+				frame.mEndingSampleInclusive = record.mEndingSampleInclusive;
+				frame.mType = CanMessage;
+				frame.mFlags = ( ( flags & CRC_ERROR ) != 0 ) ? ( flags | DISPLAY_AS_ERROR_FLAG ) : flags;
+				frame.mData1 = identifier->mData1 & COMPACT_IDENTIFIER_MASK;
+				frame.mData1 |= control->mData1 << COMPACT_DLC_SHIFT;
+				frame.mData1 |= U64( flags ) << COMPACT_FLAGS_SHIFT;
+				frame.mData1 |= crc->mData1 << COMPACT_CRC_SHIFT;
+				frame.mData2 = ( num_bytes > 0 ) ? ( data << ( 64 - num_bytes * 8 ) ) : 0;
+				mListener->OnRecord( frame );
+				mCompactEndingSample = frame.mEndingSampleInclusive;
+			}
+			break;
+		case DeviceNetError:
+			{
+				DeviceNetRecord frame = record;
+				frame.mStartingSampleInclusive = info.mFlagStart;
+				if( frame.mStartingSampleInclusive <= mCompactEndingSample )
+					frame.mStartingSampleInclusive = mCompactEndingSample + 1;
+
+				mListener->OnRecord( frame );
+				mCompactEndingSample = frame.mEndingSampleInclusive;
+			}
+			break;
+		}
+	}
+}
+
+void DeviceNetDecodeCache::Store( const DeviceNetEventInfo& info )
+{
+	mEventBytes.clear();
+	WriteVarint( mRecords.size() );
+	WriteVarint( mMarkers.size() );
+
+	U8 has_info = 0;
+	if( info.mStartOfFrame != END_OF_EDGES )
+		has_info |= 1;
+	if( info.mFlagStart != END_OF_EDGES )
+		has_info |= 2;
+	mEventBytes.push_back( has_info );
+
+	if( ( has_info & 1 ) != 0 )
+		WriteSample( info.mStartOfFrame );
+	if( ( has_info & 2 ) != 0 )
+		WriteSample( info.mFlagStart );
+
+	for( U32 i = 0; i < mRecords.size(); i++ )
+	{
+		const DeviceNetRecord& record = mRecords[ i ];
+		WriteSample( record.mStartingSampleInclusive );
+		WriteSample( record.mEndingSampleInclusive );
+		mEventBytes.push_back( record.mType );
+		mEventBytes.push_back( record.mFlags );
+		WriteVarint( record.mData1 );
+		WriteVarint( record.mData2 );
+	}
+
+	for( U32 i = 0; i < mMarkers.size(); i++ )
+	{
+		U64 sample = mMarkers[ i ] >> 2;
+		WriteVarint( ( ZigZag( sample, mLastSample ) << 2 ) | ( mMarkers[ i ] & 3 ) );
+		mLastSample = sample;
+	}
+
+	//out of room: keep what we had at the last saved state, and stop there.
+	if( mNumBytes + mEventBytes.size() > DECODE_CACHE_MAX_BYTES )
+	{
+		mFull = true;
+		RollBack();
+		return;
+	}
+
+	if( ( mBlocks.empty() == true ) || ( mBlocks.back().size() + mEventBytes.size() > mBlocks.back().capacity() ) )
+	{
+		mBlocks.push_back( std::vector<U8>() );
+		mBlocks.back().reserve( std::max<size_t>( DECODE_CACHE_BLOCK_BYTES, mEventBytes.size() ) );
+	}
+
+	mBlocks.back().insert( mBlocks.back().end(), mEventBytes.begin(), mEventBytes.end() );
+	mNumBytes += mEventBytes.size();
+}
+
+U64 DeviceNetDecodeCache::ZigZag( U64 sample, U64 last_sample )
+{
+	//the difference to the last sample, signed: samples go back a little now and then (markers after records).
+	U64 difference = sample - last_sample;
+	return ( difference << 1 ) ^ U64( S64( difference ) >> 63 );
+}
+
+U64 DeviceNetDecodeCache::UnZigZag( U64 value, U64& last_sample )
+{
+	U64 difference = ( value >> 1 ) ^ ( 0 - ( value & 1 ) );
+	last_sample += difference;
+	return last_sample;
+}
+
+void DeviceNetDecodeCache::WriteVarint( U64 value )
+{
+	while( value >= 0x80 )
+	{
+		mEventBytes.push_back( U8( value | 0x80 ) );
+		value >>= 7;
+	}
+
+	mEventBytes.push_back( U8( value ) );
+}
+
+void DeviceNetDecodeCache::WriteSample( U64 sample )
+{
+	WriteVarint( ZigZag( sample, mLastSample ) );
+	mLastSample = sample;
+}
+
+U64 DeviceNetDecodeCache::ReadVarint( const U8*& data )
+{
+	U64 value = 0;
+	U32 shift = 0;
+
+	while( ( *data & 0x80 ) != 0 )
+	{
+		value |= U64( *data++ & 0x7F ) << shift;
+		shift += 7;
+	}
+
+	value |= U64( *data++ ) << shift;
+	return value;
+}
+
+U64 DeviceNetDecodeCache::ReadSample( const U8*& data, U64& last_sample )
+{
+	return UnZigZag( ReadVarint( data ), last_sample );
+}
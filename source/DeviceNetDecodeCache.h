@@ -0,0 +1,110 @@
+#ifndef DEVICENET_DECODE_CACHE
+#define DEVICENET_DECODE_CACHE
+
+#include <LogicPublicTypes.h>
+#include <vector>
+#include "DeviceNetDecoder.h"
+
+/*	The bit level decode of a capture, kept for the next run
+
+	Finding the frames (bit timing, destuffing, CRC) is what takes the time; what the results make of them -- a
+	record per field or one per message, which of the markers to show -- is cheap.  So the decoder works out the
+	markers of the richest policy asked for so far, and the cache keeps that, packed, along with where the decoder
+	was after the last of it.  On the way through, each event is turned into what the result detail and marker
+	policy ask for.
+
+	The records are kept in the layout the result detail asks for when the decode starts.  Every field takes
+	about twice what the results take for a message, so with compact results the decoder gives the cache one
+	record per message, and that is all it keeps: a rerun asking for every field decodes again.
+
+	When the analyzer runs again on the same capture (the same first edges) with the same bit level settings,
+	the cache replays what it has in whatever form the settings ask for now, and the decoder resumes where it
+	left off: only what was appended to a live capture since gets decoded.  Past DECODE_CACHE_MAX_BYTES it stops
+	growing, and a rerun decodes from there.
+*/
+
+#define DECODE_CACHE_BLOCK_BYTES	( 1 << 20 )
+#define DECODE_CACHE_MAX_BYTES		( 1ull << 30 )
+#define DECODE_CACHE_CAPTURE_EDGES	64		//the first edges tell one capture from another
+
+class DeviceNetDecodeCache : public DeviceNetDecoderListener
+{
+public:
+	DeviceNetDecodeCache();
+	virtual ~DeviceNetDecodeCache();
+
+	//where the events go, looking the way the result detail and marker policy of settings want them.
+	void SetListener( const DeviceNetDecoderSettings& settings, DeviceNetDecoderListener* listener );
+
+	//whether we have a decode with settings like these of a capture that starts like this one (first_edges
+	//are its first ones, DECODE_CACHE_CAPTURE_EDGES at most).
+	bool CanReplay( const DeviceNetDecoderSettings& settings, const std::vector<U64>& first_edges, BitState initial_state, U64 initial_sample );
+
+	//forgets everything: the decode starting now is of this capture, with GetDecodeSettings( settings ).
+	void Start( const DeviceNetDecoderSettings& settings, const std::vector<U64>& first_edges, BitState initial_state, U64 initial_sample );
+
+	//hands everything we have to the listener, and where the decoder has to resume.
+	void Replay( DeviceNetDecoderState& state );
+
+	//what to decode with, after Start or Replay: the result detail the decode started with, and the markers of the
+	//richest policy so far -- at least the stuff bit and error markers.
+	const DeviceNetDecoderSettings& GetDecodeSettings();
+
+	//the bit rate of what Replay hands over.
+	U32 GetBitRate();
+
+	//the events so far are everything the decoder found up to state: keep them (if there's room).
+	void SaveState( const DeviceNetDecoderState& state );
+
+	virtual void OnRecord( const DeviceNetRecord& record );
+	virtual void OnMarker( U64 sample, DeviceNetMarkerType type );
+	virtual void OnEventEnd( const DeviceNetEventInfo& info );
+
+protected: //functions
+	void Present( const DeviceNetEventInfo& info );
+	void PresentCompact( const DeviceNetEventInfo& info );
+	void Store( const DeviceNetEventInfo& info );
+	void RollBack();
+
+	static U64 ZigZag( U64 sample, U64 last_sample );
+	static U64 UnZigZag( U64 value, U64& last_sample );
+	void WriteVarint( U64 value );
+	void WriteSample( U64 sample );
+	static U64 ReadVarint( const U8*& data );
+	static U64 ReadSample( const U8*& data, U64& last_sample );
+
+protected: //vars
+	//what the cache holds: the settings it was decoded with, and the capture.
+	bool mValid;
+	DeviceNetDecoderSettings mSettings;
+	std::vector<U64> mCaptureEdges;
+	BitState mCaptureState;
+	U64 mCaptureSample;
+
+	//the events, one after the other, each in one block: samples as the difference to the one before, the
+	//rest as varints.  Up to the saved state, that is; after it they may get rolled back.
+	std::vector< std::vector<U8> > mBlocks;
+	U64 mNumBytes;
+	U64 mLastSample;
+	bool mFull;
+
+	DeviceNetDecoderState mState;
+	bool mHasState;
+	U32 mSavedBlocks;
+	U32 mSavedBlockBytes;
+	U64 mSavedNumBytes;
+	U64 mSavedLastSample;
+
+	//the event in the making (or being replayed), and its packed form.
+	std::vector<DeviceNetRecord> mRecords;
+	std::vector<U64> mMarkers;	//sample << 2 | DeviceNetMarkerType
+	std::vector<U8> mEventBytes;
+
+	//where it goes
+	DeviceNetDecoderListener* mListener;
+	enum ResultDetail mResultDetail;
+	enum MarkerPolicy mMarkerPolicy;
+	U64 mCompactEndingSample;	//like the decoder's mLastFrameEndingSample in compact mode
+};
+
+#endif //DEVICENET_DECODE_CACHE
@@ -0,0 +1,962 @@
+#include "DeviceNetDecoder.h"
+#include "DeviceNetCrc.h"
+#include <cstddef>
+
+DeviceNetDecoderSettings::DeviceNetDecoderSettings()
+:	mSampleRateHz( 0 ),
+	mBitRate( BitRate_500K ),
+	mInverted( false ),
+	mBitSampling( BitSampling_EdgeRuns ),
+	mMarkerPolicy( Markers_StuffBitsAndErrors ),
+	mResultDetail( Results_Fields )
+{
+}
+
+BitState DeviceNetDecoderSettings::Recessive() const
+{
+	if (mInverted)
+		return BIT_LOW;
+	return BIT_HIGH;
+}
+
+BitState DeviceNetDecoderSettings::Dominant() const
+{
+	if (mInverted)
+		return BIT_HIGH;
+	return BIT_LOW;
+}
+
+DeviceNetDecoder::DeviceNetDecoder()
+:	mSource( NULL ),
+	mListener( NULL ),
+	mSampleRateHz( 0 ),
+	mBitRate( 0 )
+{
+}
+
+DeviceNetDecoder::~DeviceNetDecoder()
+{
+}
+
+void DeviceNetDecoder::Start( const DeviceNetDecoderSettings& settings, DeviceNetEdgeSource* source, DeviceNetDecoderListener* listener )
+{
+	mSettings = settings;
+	mSource = source;
+	mListener = listener;
+	mSampleRateHz = settings.mSampleRateHz;
+	mBitRate = mSettings.mBitRate;
+
+	InitSampleOffsets();
+
+	mMarkEveryBit = (mSettings.mMarkerPolicy == Markers_EveryBit);
+	mMarkStuffBitsAndErrors = (mSettings.mMarkerPolicy != Markers_None);
+
+	//we might be in the middle of a frame, so we don't know how long the bus has been recessive already.
+	mIdleStart = mSource->GetSampleNumber();
+	mIdleStartIsDelimiter = false;
+	mNumFrameMarkers = 0;
+	mLastFrameEndingSample = 0;
+	mStopSample = END_OF_EDGES;
+}
+
+U32 DeviceNetDecoder::GetBitRate()
+{
+	return mBitRate;
+}
+
+void DeviceNetDecoder::GetState( DeviceNetDecoderState& state )
+{
+	state.mSampleNumber = mSource->GetSampleNumber();
+	state.mBitRate = mBitRate;
+	state.mIdleStart = mIdleStart;
+	state.mIdleStartIsDelimiter = mIdleStartIsDelimiter;
+	state.mLastFrameEndingSample = mLastFrameEndingSample;
+}
+
+void DeviceNetDecoder::Resume( const DeviceNetDecoderSettings& settings, DeviceNetEdgeSource* source, DeviceNetDecoderListener* listener, const DeviceNetDecoderState& state )
+{
+	//everything else starts over with every frame.
+	DeviceNetDecoderSettings resume_settings = settings;
+	resume_settings.mBitRate = BitRate( state.mBitRate );
+	Start( resume_settings, source, listener );
+
+	mSource->AdvanceToAbsPosition( state.mSampleNumber );
+	mIdleStart = state.mIdleStart;
+	mIdleStartIsDelimiter = state.mIdleStartIsDelimiter;
+	mLastFrameEndingSample = state.mLastFrameEndingSample;
+}
+
+void DeviceNetDecoder::SetSource( DeviceNetEdgeSource* source, DeviceNetDecoderListener* listener )
+{
+	mSource = source;
+	mListener = listener;
+}
+
+void DeviceNetDecoder::SetStopSample( U64 stop_sample )
+{
+	mStopSample = stop_sample;
+}
+
+bool DeviceNetDecoder::IsStoppedAtStartOfFrame( U64 edge_sample )
+{
+	//if the next edge is a later one, we went past edge_sample inside a frame or an error frame.
+	if( mSource->GetSampleOfNextEdge() != edge_sample )
+		return false;
+
+	if( mIdleSamples < mNumSamplesInBusIdle )
+		return false;
+
+	//six dominant bits from there on would make it an overload flag, which a decoder starting in the idle time can't know.
+	if( ( mIdleStartIsDelimiter == true ) && ( mIdleSamples < mNumSamplesInIntermission ) )
+		return false;
+
+	return true;
+}
+
+U64 DeviceNetDecoder::GetIdleSamples()
+{
+	return mIdleSamples;
+}
+
+bool DeviceNetDecoder::DecodeNext()
+{
+	BusEvent bus_event = SkipBusIdle(); //leaves us on the falling edge that starts it
+
+	if( ( bus_event == EndOfEdges ) || ( bus_event == StopEdge ) )
+		return false;
+
+	mEventInfo.mStartOfFrame = END_OF_EDGES;
+	mEventInfo.mFlagStart = END_OF_EDGES;
+
+	if( bus_event == StartOfFrameEdge )
+	{
+		DecodeFrame();
+		mEventInfo.mStartOfFrame = mStartOfFrame;
+
+		if( mCanError == true )
+		{
+			//six dominant bits right from the start bit, this soon after a frame: an overload flag in INTERMISSION.
+			bool overload = ( mErrorCause == StuffError ) && ( mRawFrameIndex == 6 ) && ( mRawBits.GetBits( 0, 6 ) == 0 );
+			overload = overload && ( mIdleStartIsDelimiter == true ) && ( mIdleSamples < mNumSamplesInIntermission );
+
+			if( overload == true )
+			{
+				mCanError = false;
+				mNumFrameMarkers = 0;
+				DecodeOverloadFrame( mStartOfFrame );
+			}
+			else
+			{
+				DecodeErrorFrame();
+			}
+		}
+	}
+	else if( bus_event == OverloadFlagEdge )
+	{
+		mCanError = false;
+		DecodeOverloadFrame( mSource->GetSampleNumber() );
+	}
+	else
+	{
+		//a dominant bit in END OF FRAME or a delimiter
+		mCanError = true;
+		mErrorCause = FormError;
+		mErrorStartingSample = mSource->GetSampleNumber();
+		mErrorEndingSample = mErrorStartingSample;
+		DecodeErrorFrame();
+	}
+
+	CommitFrameMarkers();
+	mListener->OnEventEnd( mEventInfo );
+	return true;
+}
+
+void DeviceNetDecoder::InitSampleOffsets()
+{
+	mSampleOffsets.resize(256);
+
+	double samples_per_bit = double(mSampleRateHz) / double(mBitRate);
+	double samples_behind = 0.0;
+
+	U32 increment = U32((samples_per_bit * .5) + samples_behind);
+	samples_behind = (samples_per_bit * .5) + samples_behind - double(increment);
+
+	mSampleOffsets[0] = increment;
+	U32 current_offset = increment;
+
+	for (U32 i = 1; i < 256; i++)
+	{
+		U32 increment = U32(samples_per_bit + samples_behind);
+		samples_behind = samples_per_bit + samples_behind - double(increment);
+		current_offset += increment;
+		mSampleOffsets[i] = current_offset;
+	}
+
+	//the bus is idle after 11 recessive bits: ACK delimiter, END OF FRAME and INTERMISSION.  A node with a message
+	//pending may start it in the third bit of INTERMISSION already, and we only know where the ACK delimiter
+	//started to within the clock drift since the last resync, so we take a dominant edge after 9 bits as a start
+	//of frame.  That's still well clear of the 5 recessive bits stuffing allows inside a frame.
+	mNumSamplesInBusIdle = U32(samples_per_bit * 9.0);
+
+	//END OF FRAME and the error and overload delimiters all end in 8 recessive bits.  A dominant bit in the last
+	//one, or in the first two bits of INTERMISSION, starts an overload frame; any earlier it's a form error.
+	mNumSamplesInDelimiter = U32(samples_per_bit * 6.5);
+	mNumSamplesInIntermission = U32(samples_per_bit * 9.5);
+
+	mSamplesPerBit = samples_per_bit;
+}
+
+U32 DeviceNetDecoder::DetectBitRate(const U64* edges, U32 num_edges, U32 sample_rate_hz)
+{
+	//a histogram of the pulse widths in quarter bits at 500 kbit/s.  Stuffing makes sure CAN traffic is full of
+	//single-bit pulses, so the rate is the slowest one that (bar the odd glitch) no pulse is too short for.
+	U32 histogram[AUTO_BIT_RATE_BINS];
+	for (U32 i = 0; i < AUTO_BIT_RATE_BINS; i++)
+		histogram[i] = 0;
+
+	double quarter_bit = double(sample_rate_hz) / double(BitRate_500K) / 4.0;
+	U32 num_pulses = 0;
+
+	for (U32 i = 1; (i < num_edges) && (num_pulses < AUTO_BIT_RATE_PULSES); i++)
+	{
+		U32 bin = U32(double(edges[i] - edges[i - 1]) / quarter_bit);
+		if (bin >= AUTO_BIT_RATE_BINS)
+			bin = AUTO_BIT_RATE_BINS - 1;
+
+		histogram[bin]++;
+		num_pulses++;
+	}
+
+	const U32 bit_rates[] = { BitRate_125K, BitRate_250K, BitRate_500K };
+	for (U32 i = 0; i < 2; i++)
+	{
+		//anything under 3/4 of a bit is too short for this rate.
+		U32 too_short_bins = 3 * (BitRate_500K / bit_rates[i]);
+		U32 too_short = 0;
+		for (U32 bin = 0; bin < too_short_bins; bin++)
+			too_short += histogram[bin];
+
+		if (too_short * 20 <= num_pulses)
+			return bit_rates[i];
+	}
+
+	return BitRate_500K;
+}
+
+BusEvent DeviceNetDecoder::SkipBusIdle()
+{
+	//the bus has been recessive since mIdleStart (or longer).  Rather than probing ahead we look at where the
+	//next edge is: one call jumps over any amount of idle time, and a recessive run that is too short to be
+	//bus idle (we're in the middle of a frame) is skipped along with the dominant bits after it.
+	if (mSource->GetBitState() == mSettings.Dominant())
+	{
+		mSource->AdvanceToNextEdge();
+		mIdleStart = mSource->GetSampleNumber();
+		mIdleStartIsDelimiter = false;
+	}
+
+	for (; ; )
+	{
+		if (mSource->HasMoreEdges() == false)
+			return EndOfEdges;
+
+		U64 next_edge = mSource->GetSampleOfNextEdge();
+		mIdleSamples = next_edge - mIdleStart;
+
+		if (next_edge >= mStopSample)
+			return StopEdge;
+
+		if (mIdleSamples >= mNumSamplesInBusIdle)
+		{
+			mSource->AdvanceToNextEdge(); //falling edge -- beginning of the start bit
+			return StartOfFrameEdge;
+		}
+
+		if (mIdleStartIsDelimiter == true)
+		{
+			//we know where the delimiter started, so this is the start of an error or overload flag.
+			mSource->AdvanceToNextEdge();
+			return (mIdleSamples >= mNumSamplesInDelimiter) ? OverloadFlagEdge : ErrorFlagEdge;
+		}
+
+		mSource->AdvanceToNextEdge();
+		mSource->AdvanceToNextEdge();
+		mIdleStart = mSource->GetSampleNumber();
+	}
+}
+
+void DeviceNetDecoder::StartFrame()
+{
+	mCanError = false;
+	mRawFrameIndex = 0;
+	mLastRawBit = mSettings.Recessive();
+	mSameRawBits = 0;
+	mRawBits.Clear();
+	mStuffBits.Clear();
+	mDestuffer.Reset();
+	mFrameBits.Clear();
+	mFrameBitIndex = 0;
+	mFrameRawIndex = 0;
+	mNumFrameMarkers = 0;
+
+	mStartOfFrame = mSource->GetSampleNumber();
+
+	//hard synchronization: the start bit begins at its falling edge.
+	mNumSyncPoints = 0;
+	mSyncCursor = 0;
+	Resynchronize(mStartOfFrame, 0);
+
+	if (mSettings.mBitSampling == BitSampling_EdgeRuns)
+		StartRawFrameRun();
+}
+
+void DeviceNetDecoder::DecodeFrame()
+{
+	//we decode the frame in a single pass, but not a bit at a time: we sample the raw bits as far as we know the
+	//frame goes (up to the DLC of a standard frame -- an extended one is longer -- then the rest of an extended
+	//header, then everything up to the CRC delimiter), take the stuff bits out of each batch in one go, and read
+	//the fields off the destuffed bits.
+	StartFrame();
+	LoadFrameBits(1 + LENGTH_ARBITRATION_FIELD + 2 + LENGTH_DATA_LENGTH_CODE);
+
+	BitState bit;
+	U64 first_sample;
+	U64 last_sample;
+	bool done;
+
+	done = GetFrameBit(bit, last_sample);  //the start bit
+	if (done == true)
+		return;
+
+	done = GetFrameBits(11, mIdentifier, first_sample, last_sample);
+	if (done == true)
+		return;
+
+	//ok, the next two bits will let us know if this is 11-bit or 29-bit can.  If it's 11-bit, then it'll also tell us if this is a remote frame request or not.
+
+	BitState bit0;
+	done = GetFrameBit(bit0, last_sample);
+	if (done == true)
+		return;
+
+	BitState bit1;
+	done = GetFrameBit(bit1, last_sample);
+	if (done == true)
+		return;
+
+	DeviceNetRecord frame;
+	frame.mStartingSampleInclusive = first_sample;
+
+	if (bit1 == mSettings.Dominant())
+	{
+		//11-bit CAN
+
+		BitState r0;  //since this is 11-bit CAN, we know that the next bit is r0, which we are going to throw away.
+		done = GetFrameBit(r0, last_sample);
+		if (done == true)
+			return;
+
+		mStandardCan = true;
+		mRemoteFrame = (bit0 == mSettings.Recessive()); //since this is 11-bit CAN, we know that bit0 is the RTR bit
+		frame.mType = IdentifierField;
+	}
+	else
+	{
+		//29-bit CAN
+
+		mStandardCan = false;
+
+		LoadFrameBits(mFrameBitIndex + 18 + 3 + LENGTH_DATA_LENGTH_CODE);
+
+		//get the next 18 address bits.
+		U32 identifier_ex;
+		U64 unused_sample;
+		done = GetFrameBits(18, identifier_ex, unused_sample, last_sample);
+		if (done == true)
+			return;
+
+		mIdentifier = (mIdentifier << 18) | identifier_ex;
+
+		//get the RTR bit
+		BitState rtr;
+		done = GetFrameBit(rtr, last_sample);
+		if (done == true)
+			return;
+
+		//get the r1 and r0 bits (we won't use them)
+		BitState r1;
+		done = GetFrameBit(r1, last_sample);
+		if (done == true)
+			return;
+
+		BitState r0;
+		done = GetFrameBit(r0, last_sample);
+		if (done == true)
+			return;
+
+		mRemoteFrame = (rtr == mSettings.Recessive());
+		frame.mType = IdentifierFieldEx;
+	}
+
+	frame.mEndingSampleInclusive = last_sample;
+	frame.mFlags = (mRemoteFrame == true) ? REMOTE_FRAME : 0;
+	frame.mData1 = mIdentifier;
+	frame.mData2 = mIdleSamples; //how long the bus was recessive before this frame
+	AddFieldFrame(frame);
+
+	mControlFieldStart = mFrameBitIndex - 2;  //r1/IDE and r0 (or r1 and r0) are already in
+	done = GetFrameBits(LENGTH_DATA_LENGTH_CODE, mNumDataBytes, first_sample, last_sample);
+	if (done == true)
+		return;
+
+	frame.mStartingSampleInclusive = first_sample;
+	frame.mEndingSampleInclusive = last_sample;
+	frame.mType = ControlField;
+	frame.mData1 = mNumDataBytes;
+	AddFieldFrame(frame);
+
+	U32 num_bytes = mNumDataBytes;
+	if (num_bytes > 8)
+		num_bytes = 8;
+
+	if (mRemoteFrame == true)
+		num_bytes = 0; //ignore the num_bytes if this is a remote frame.
+
+	LoadFrameBits(mFrameBitIndex + num_bytes * LENGTH_DATA_BYTE + LENGTH_CRC_SEQUENCE + 1);
+
+	mDataFieldStart = mFrameBitIndex;
+	for (U32 i = 0; i < num_bytes; i++)
+	{
+		U32 data;
+		done = GetFrameBits(LENGTH_DATA_BYTE, data, first_sample, last_sample);
+		if (done == true)
+			return;
+
+		frame.mStartingSampleInclusive = first_sample;
+		frame.mEndingSampleInclusive = last_sample;
+		frame.mType = DataField;
+		frame.mData1 = data;
+		AddFieldFrame(frame);
+	}
+
+	//the CRC covers everything we've destuffed so far, from the start bit to the end of the data field.
+	mCrcFieldStart = mFrameBitIndex;
+
+	done = GetFrameBits(LENGTH_CRC_SEQUENCE, mCrcValue, first_sample, last_sample);
+	if (done == true)
+		return;
+
+	U32 expected_crc = DeviceNetCrc::Compute(mFrameBits.GetWords(), mCrcFieldStart);
+	mCrcError = (mCrcValue != expected_crc);
+
+	frame.mStartingSampleInclusive = first_sample;
+	frame.mEndingSampleInclusive = last_sample;
+	frame.mType = CrcField;
+	frame.mFlags = (mCrcError == true) ? (CRC_ERROR | DISPLAY_AS_ERROR_FLAG) : 0;
+	frame.mData1 = mCrcValue;
+	frame.mData2 = expected_crc;
+	AddFieldFrame(frame);
+
+	//the CRC sequence may still be followed by a stuff bit, so the delimiter goes through the destuffer.  It's the
+	//last bit that does: sampling stopped right after it.
+	done = GetFrameBit(mCrcDelimiter, last_sample);
+	if (done == true)
+		return;
+
+	if (mCrcDelimiter != mSettings.Recessive())
+	{
+		//form error
+		mCanError = true;
+		mErrorCause = FormError;
+		mErrorStartingSample = last_sample - mSampleOffsets[0];
+		mErrorEndingSample = last_sample;
+		return;
+	}
+
+	BitState ack;
+	done = GetFixedFormFrameBit(ack, first_sample);
+	if (done == true)
+		return;
+
+	mAck = (ack == mSettings.Dominant());
+
+	done = GetFixedFormFrameBit(ack, last_sample);
+	if (done == true)
+		return;
+
+	if (ack != mSettings.Recessive())
+	{
+		//form error in the ACK delimiter
+		mCanError = true;
+		mErrorCause = FormError;
+		mErrorStartingSample = last_sample - mSampleOffsets[0];
+		mErrorEndingSample = last_sample;
+		return;
+	}
+
+	frame.mStartingSampleInclusive = first_sample;
+	frame.mEndingSampleInclusive = last_sample;
+	frame.mType = AckField;
+	frame.mData1 = mAck;
+	AddFieldFrame(frame);
+
+	if (mSettings.mResultDetail == Results_Compact)
+		AddMessageFrame(last_sample);
+
+	//the bus stays recessive from the ACK delimiter on.
+	mIdleStart = last_sample - mSampleOffsets[0];
+	mIdleStartIsDelimiter = true;
+}
+
+void DeviceNetDecoder::AddFieldFrame(DeviceNetRecord& frame)
+{
+	//in compact mode the fields only end up in the message frame.
+	if (mSettings.mResultDetail == Results_Fields)
+	{
+		mListener->OnRecord(frame);
+		mLastFrameEndingSample = frame.mEndingSampleInclusive;
+	}
+}
+
+void DeviceNetDecoder::AddMessageFrame(U64 last_sample)
+{
+	U32 num_bytes = (mRemoteFrame == true) ? 0 : ((mNumDataBytes > 8) ? 8 : mNumDataBytes);
+
+	U8 flags = 0;
+	if (mRemoteFrame == true)
+		flags |= REMOTE_FRAME;
+	if (mCrcError == true)
+		flags |= CRC_ERROR;
+	if (mStandardCan == false)
+		flags |= EXTENDED_IDENTIFIER;
+	if (mAck == true)
+		flags |= ACK_RECEIVED;
+
+	DeviceNetRecord frame;
+	frame.mStartingSampleInclusive = mStartOfFrame;
+	frame.mEndingSampleInclusive = last_sample;
+	frame.mType = CanMessage;
+	frame.mFlags = (mCrcError == true) ? (flags | DISPLAY_AS_ERROR_FLAG) : flags;
+	frame.mData1 = U64(mIdentifier) & COMPACT_IDENTIFIER_MASK;
+	frame.mData1 |= U64(mNumDataBytes) << COMPACT_DLC_SHIFT;
+	frame.mData1 |= U64(flags) << COMPACT_FLAGS_SHIFT;
+	frame.mData1 |= U64(mCrcValue) << COMPACT_CRC_SHIFT;
+
+	//the data bytes are still in mFrameBits: left align them, so the first byte is the top one.
+	frame.mData2 = 0;
+	if (num_bytes > 0)
+		frame.mData2 = mFrameBits.GetBits(mDataFieldStart, num_bytes * 8) << (64 - num_bytes * 8);
+
+	mListener->OnRecord(frame);
+	mLastFrameEndingSample = frame.mEndingSampleInclusive;
+}
+
+void DeviceNetDecoder::DecodeErrorFrame()
+{
+	//an error active node sends 6 dominant bits, and the nodes that only notice the error because of it send
+	//theirs on top, so the dominant part can grow to 12 bits.  An error passive node sends 6 recessive bits.
+	//Then every node sends recessive bits: the 8-bit error delimiter.
+	//mErrorStartingSample is where the bits that broke the frame begin; if the bus is dominant there, those are the flag.
+	DeviceNetErrorFrameType type = ActiveErrorFrame;
+	U64 flag_start = mErrorStartingSample;
+	U64 delimiter_start;
+	U32 flag_bits = 6;
+
+	if (mSource->GetBitState() == mSettings.Recessive())
+	{
+		//either the active flags are still to come, or this is a passive flag and the delimiter follows right away.
+		U64 passive_delimiter_end = mErrorEndingSample + U64(mSamplesPerBit * 8.0);
+		if (mSource->WouldAdvancingToAbsPositionCauseTransition(passive_delimiter_end) == true)
+		{
+			mSource->AdvanceToNextEdge();
+			flag_start = mSource->GetSampleNumber();
+		}
+		else
+		{
+			type = PassiveErrorFrame;
+		}
+	}
+
+	if (type == ActiveErrorFrame)
+	{
+		mSource->AdvanceToNextEdge();
+		delimiter_start = mSource->GetSampleNumber();
+		flag_bits = U32(double(delimiter_start - flag_start) / mSamplesPerBit + 0.5);
+	}
+	else
+	{
+		delimiter_start = flag_start + U64(mSamplesPerBit * 6.0);
+	}
+
+	AddErrorFrame(type, flag_start, delimiter_start, flag_bits);
+}
+
+void DeviceNetDecoder::DecodeOverloadFrame(U64 flag_start)
+{
+	//6 dominant bits (more if other nodes join in), then the 8-bit overload delimiter.  We're in the flag.
+	mSource->AdvanceToNextEdge();
+	U64 delimiter_start = mSource->GetSampleNumber();
+	U32 flag_bits = U32(double(delimiter_start - flag_start) / mSamplesPerBit + 0.5);
+
+	mErrorCause = NoError;
+	AddErrorFrame(OverloadFrame, flag_start, delimiter_start, flag_bits);
+}
+
+void DeviceNetDecoder::AddErrorFrame(DeviceNetErrorFrameType type, U64 flag_start, U64 delimiter_start, U32 flag_bits)
+{
+	//the frame takes in the delimiter, unless a dominant bit cuts it short -- that one starts the next frame.
+	U64 delimiter_end = delimiter_start + U64(mSamplesPerBit * 8.0) - 1;
+	if (mSource->WouldAdvancingToAbsPositionCauseTransition(delimiter_end) == true)
+		delimiter_end = mSource->GetSampleOfNextEdge() - 1;
+
+	//the flag may have started on bits that already went into the last field.
+	mEventInfo.mFlagStart = flag_start;
+	if (flag_start <= mLastFrameEndingSample)
+		flag_start = mLastFrameEndingSample + 1;
+
+	DeviceNetRecord frame;
+	frame.mStartingSampleInclusive = flag_start;
+	frame.mEndingSampleInclusive = delimiter_end;
+	frame.mType = DeviceNetError;
+	frame.mFlags = (type == OverloadFrame) ? DISPLAY_AS_WARNING_FLAG : DISPLAY_AS_ERROR_FLAG;
+	if (flag_bits > 6)
+		frame.mFlags |= FLAG_SUPERPOSITION;
+	frame.mData1 = U64(type) | (U64(mErrorCause) << ERROR_CAUSE_SHIFT);
+	frame.mData2 = flag_bits;
+	mListener->OnRecord(frame);
+	mLastFrameEndingSample = frame.mEndingSampleInclusive;
+
+	mIdleStart = delimiter_start;
+	mIdleStartIsDelimiter = true;
+}
+
+bool DeviceNetDecoder::GetRawFrameBit(BitState& result, U64& sample)
+{
+	if (mRawFrameIndex == mSampleOffsets.size())
+	{
+		//we are in garbage data most likely, lets get out of here.
+		mCanError = true;
+		mErrorCause = FrameTooLong;
+		mErrorStartingSample = mSource->GetSampleNumber();
+		mErrorEndingSample = mErrorStartingSample;
+		return true;
+	}
+
+	if (mSettings.mBitSampling == BitSampling_EdgeRuns)
+	{
+		LoadRawFrameRun();
+		sample = GetSampleOfRawBit(mRawFrameIndex);
+		result = mRunState;
+	}
+	else
+	{
+		sample = GetSampleOfRawBit(mRawFrameIndex);
+
+		//coming from a recessive bit, an edge before this sample point starts this bit -- resynchronize on it.
+		if ((mSource->GetBitState() == mSettings.Recessive()) && (mSource->WouldAdvancingToAbsPositionCauseTransition(sample) == true))
+		{
+			mSource->AdvanceToNextEdge();
+			Resynchronize(mSource->GetSampleNumber(), mRawFrameIndex);
+			sample = GetSampleOfRawBit(mRawFrameIndex);
+		}
+
+		mSource->AdvanceToAbsPosition(sample);
+		result = mSource->GetBitState();
+	}
+
+	mRawFrameIndex++;
+
+	return false;
+}
+
+void DeviceNetDecoder::StartRawFrameRun()
+{
+	//we are sitting on the falling edge of the start bit.
+	mRunState = mSource->GetBitState();
+	mRunEndBit = GetRawFrameRunEnd();
+}
+
+void DeviceNetDecoder::LoadRawFrameRun()
+{
+	//the channel sits in the current run, and mRunEndBit is the first raw bit sampled after the edge
+	//that ends it.  Only when the run is used up do we move on to that edge.
+	while (mRawFrameIndex >= mRunEndBit)
+	{
+		//a recessive run we haven't seen the end of yet: all we know is it takes in the bits up to here.
+		if (mRunEndIsKnown == false)
+		{
+			mRunEndBit = GetRawFrameRunEnd();
+			continue;
+		}
+
+		mSource->AdvanceToNextEdge();
+		mRunState = Invert(mRunState);
+
+		if (mRunState == mSettings.Dominant())
+			Resynchronize(mSource->GetSampleNumber(), mRunEndBit);
+
+		mRunEndBit = GetRawFrameRunEnd();
+	}
+}
+
+void DeviceNetDecoder::Resynchronize(U64 edge_sample, U32 bit_index)
+{
+	//every recessive-to-dominant edge marks the start of a bit, so the bits from here on are timed from the
+	//edge rather than from the start of frame.  Unlike a CAN controller we don't limit the correction to the
+	//SJW: the edge has to lie between the sample points of the bits around it anyway, or we'd have read it there.
+	mSyncSample = edge_sample;
+	mSyncBit = bit_index;
+
+	if (mNumSyncPoints < MAX_SYNC_POINTS)
+		mNumSyncPoints++;
+
+	mSyncSamples[mNumSyncPoints - 1] = edge_sample;
+	mSyncBits[mNumSyncPoints - 1] = bit_index;
+}
+
+U64 DeviceNetDecoder::GetSampleOfRawBit(U32 index)
+{
+	if (index >= mSyncBit)
+		return mSyncSample + mSampleOffsets[index - mSyncBit];
+
+	//a bit from before the last resynchronization is timed from the one before it.  We mostly go through the
+	//bits in order, so we look from where we found the last one.
+	while ((mSyncCursor + 1 < mNumSyncPoints) && (mSyncBits[mSyncCursor + 1] <= index))
+		mSyncCursor++;
+	while ((mSyncCursor > 0) && (mSyncBits[mSyncCursor] > index))
+		mSyncCursor--;
+
+	return mSyncSamples[mSyncCursor] + mSampleOffsets[index - mSyncBits[mSyncCursor]];
+}
+
+U32 DeviceNetDecoder::GetRawFrameRunEnd()
+{
+	//a dominant run is always followed by a recessive edge, but the bus may stay recessive for the rest
+	//of the capture: then the edge that ends this run hasn't been captured (yet), and we wait for the next
+	//bit's sample point.  If the run goes on past it, we know that much, and look again at the bit after.
+	mRunEndIsKnown = true;
+	if ((mRunState == mSettings.Dominant()) || (mSource->DoMoreTransitionsExistInCurrentData() == true))
+		return GetBitIndexOfSample(mSource->GetSampleOfNextEdge());
+
+	U64 sample = GetSampleOfRawBit(mRawFrameIndex);
+	if (mSource->WouldAdvancingToAbsPositionCauseTransition(sample) == true)
+		return GetBitIndexOfSample(mSource->GetSampleOfNextEdge());
+
+	mSource->AdvanceToAbsPosition(sample);
+	mRunEndIsKnown = false;
+	return mRawFrameIndex + 1;
+}
+
+U32 DeviceNetDecoder::GetBitIndexOfSample(U64 sample)
+{
+	//the number of bit sample points (counting from the start of frame) that come before sample.
+	U32 num_offsets = mSampleOffsets.size() - mSyncBit;
+	U64 distance = sample - mSyncSample;
+
+	if (distance > mSampleOffsets[num_offsets - 1])
+		return mSyncBit + num_offsets;
+
+	U32 index = U32(double(distance) * double(mBitRate) / double(mSampleRateHz));
+	if (index > num_offsets)
+		index = num_offsets;
+
+	while ((index < num_offsets) && (mSampleOffsets[index] < distance))
+		index++;
+
+	while ((index > 0) && (mSampleOffsets[index - 1] >= distance))
+		index--;
+
+	return mSyncBit + index;
+}
+
+bool DeviceNetDecoder::GetFixedFormFrameBit(BitState& result, U64& sample)
+{
+	if (GetRawFrameBit(result, sample) == true)
+		return true;
+
+	if (mMarkEveryBit == true)
+		AddFrameMarker(sample, BitMarker);
+
+	return false;
+}
+
+void DeviceNetDecoder::AddFrameMarker(U64 sample, DeviceNetMarkerType type)
+{
+	if (mNumFrameMarkers == MAX_FRAME_MARKERS)
+		return;
+
+	mFrameMarkers[mNumFrameMarkers] = (U32(sample - mStartOfFrame) << 1) | U32(type);
+	mNumFrameMarkers++;
+}
+
+void DeviceNetDecoder::CommitFrameMarkers()
+{
+	for (U32 i = 0; i < mNumFrameMarkers; i++)
+		mListener->OnMarker(mStartOfFrame + (mFrameMarkers[i] >> 1), DeviceNetMarkerType(mFrameMarkers[i] & 1));
+
+	if ((mCanError == true) && (mMarkStuffBitsAndErrors == true))
+		mListener->OnMarker(mErrorEndingSample, ErrorMarker);
+
+	mNumFrameMarkers = 0;
+}
+
+bool DeviceNetDecoder::SampleRawFrameBits(U32 max_bits)
+{
+	//samples up to max_bits raw bits into mRawBits, a run at a time with edge run sampling.  We stop early at
+	//the sixth identical bit in a row: that's a stuff error, and what comes after it belongs to the error frame.
+	//The bits gather in a word first, and go into mRawBits whenever it's full.
+	BitState recessive = mSettings.Recessive();
+	bool edge_runs = (mSettings.mBitSampling == BitSampling_EdgeRuns);
+	U64 bits = 0;
+	U32 num_bits_in_word = 0;
+	U32 num_sampled = 0;
+	bool too_long = false;
+
+	while ((num_sampled < max_bits) && (mSameRawBits < 6))
+	{
+		BitState bit;
+		U64 sample;
+		if (GetRawFrameBit(bit, sample) == true)
+		{
+			too_long = true;
+			break;
+		}
+
+		if (bit == mLastRawBit)
+		{
+			mSameRawBits++;
+		}
+		else
+		{
+			mLastRawBit = bit;
+			mSameRawBits = 1;
+		}
+
+		U32 num_bits = 1;
+
+		if (edge_runs == true)
+		{
+			//take the rest of the run in one go.
+			U32 extra = mRunEndBit - mRawFrameIndex;
+			if (max_bits - num_sampled - 1 < extra)
+				extra = max_bits - num_sampled - 1;
+			if (6 - mSameRawBits < extra)
+				extra = 6 - mSameRawBits;
+
+			mRawFrameIndex += extra;
+			mSameRawBits += extra;
+			num_bits += extra;
+		}
+
+		if (num_bits_in_word + num_bits > 64)
+		{
+			mRawBits.AppendBits(bits, num_bits_in_word);
+			bits = 0;
+			num_bits_in_word = 0;
+		}
+
+		bits <<= num_bits;
+		if (bit == recessive)
+			bits |= (U64(1) << num_bits) - 1;
+		num_bits_in_word += num_bits;
+		num_sampled += num_bits;
+	}
+
+	mRawBits.AppendBits(bits, num_bits_in_word);
+	return too_long;
+}
+
+void DeviceNetDecoder::LoadFrameBits(U32 num_bits)
+{
+	//samples and destuffs raw bits until mFrameBits has num_bits in it, the stuffing breaks or the frame runs too
+	//long.  Every raw bit we sample is either one of those bits or a stuff bit, so we never sample past the last one.
+	while ((mFrameBits.GetNumBits() < num_bits) && (mCanError == false) && (mDestuffer.GetErrorIndex() == NO_STUFF_ERROR))
+	{
+		U32 first_raw_bit = mDestuffer.GetNumRawBits();
+		SampleRawFrameBits(num_bits - mFrameBits.GetNumBits());
+		mDestuffer.Destuff(mRawBits, mFrameBits, mStuffBits);
+		AddRawBitMarkers(first_raw_bit, mDestuffer.GetNumRawBits());
+	}
+}
+
+bool DeviceNetDecoder::GetFrameBit(BitState& result, U64& sample)
+{
+	U32 value;
+	U64 first_sample;
+	if (GetFrameBits(1, value, first_sample, sample) == true)
+		return true;
+
+	result = (value == 1) ? mSettings.Recessive() : mSettings.Dominant();
+	return false;
+}
+
+bool DeviceNetDecoder::GetFrameBits(U32 num_bits, U32& value, U64& first_sample, U64& last_sample)
+{
+	//reads a MSB-first field of num_bits destuffed bits.
+	if (mFrameBitIndex + num_bits > mFrameBits.GetNumBits())
+		LoadFrameBits(mFrameBitIndex + num_bits);
+
+	if (mFrameBitIndex + num_bits > mFrameBits.GetNumBits())
+	{
+		if (mCanError == false)
+		{
+			//after five identical bits the transmitter inserts one of the opposite polarity.  If it isn't there,
+			//somebody is sending an error flag (or we lost the frame).  It's the last bit we sampled.
+			U32 error_index = mDestuffer.GetErrorIndex();
+			mCanError = true;
+			mErrorCause = StuffError;
+			mErrorStartingSample = GetSampleOfRawBit(error_index - 5) - mSampleOffsets[0]; //no edge inside the six bits, so no resync either
+			mErrorEndingSample = GetSampleOfRawBit(error_index);
+		}
+
+		return true;
+	}
+
+	//the field may start on a stuff bit (never on two), and takes in the stuff bits between its own.
+	U32 first_raw_bit = mFrameRawIndex;
+	if (mStuffBits.GetBit(first_raw_bit) == true)
+		first_raw_bit++;
+
+	U32 end_raw_bit = first_raw_bit + num_bits;
+	while (end_raw_bit > first_raw_bit + 1)
+	{
+		U32 num_stuff_bits = DeviceNetBitBuffer::CountOnes(mStuffBits.GetBits(first_raw_bit, end_raw_bit - first_raw_bit));
+		if (first_raw_bit + num_bits + num_stuff_bits == end_raw_bit)
+			break;
+		end_raw_bit = first_raw_bit + num_bits + num_stuff_bits;
+	}
+
+	value = U32(mFrameBits.GetBits(mFrameBitIndex, num_bits));
+	first_sample = GetSampleOfRawBit(first_raw_bit);
+	last_sample = (num_bits == 1) ? first_sample : GetSampleOfRawBit(end_raw_bit - 1);
+
+	mFrameBitIndex += num_bits;
+	mFrameRawIndex = end_raw_bit;
+	return false;
+}
+
+void DeviceNetDecoder::AddRawBitMarkers(U32 first_bit, U32 end_bit)
+{
+	//markers for raw bits that just came out of the destuffer.
+	if (mMarkEveryBit == true)
+	{
+		for (U32 i = first_bit; i < end_bit; i++)
+			AddFrameMarker(GetSampleOfRawBit(i), (mStuffBits.GetBit(i) == true) ? StuffBitMarker : BitMarker);
+	}
+	else if (mMarkStuffBitsAndErrors == true)
+	{
+		//most batches have no stuff bits at all, and the rest only a few: skip from one to the next.
+		for (U32 i = first_bit; i < end_bit; i += 64)
+		{
+			U32 num_bits = (end_bit - i < 64) ? (end_bit - i) : 64;
+			U64 stuff_bits = mStuffBits.GetBits(i, num_bits) << (64 - num_bits);
+
+			while (stuff_bits != 0)
+			{
+				U32 offset = DeviceNetBitBuffer::CountLeadingZeros(stuff_bits);
+				AddFrameMarker(GetSampleOfRawBit(i + offset), StuffBitMarker);
+				stuff_bits &= ~(0x8000000000000000ull >> offset);
+			}
+		}
+	}
+}
@@ -0,0 +1,275 @@
+#ifndef DEVICENET_DECODER
+#define DEVICENET_DECODER
+
+#include <LogicPublicTypes.h>
+#include <vector>
+#include "DeviceNetProtocol.h"
+#include "DeviceNetEdgeSource.h"
+#include "DeviceNetBitBuffer.h"
+#include "DeviceNetDestuffer.h"
+
+/*	The CAN bit level decoder behind the DeviceNet analyzer
+
+	It doesn't need anything from the Logic SDK but its types: it reads the bus through a DeviceNetEdgeSource
+	and hands every frame and marker it finds to a DeviceNetDecoderListener.  DeviceNetAnalyzer just plugs the
+	channel data and the results into it; anything else that has the edges (a recording, a test) can do the same.
+*/
+
+enum BitRate
+{
+	BitRate_500K = 500000,
+	BitRate_250K = 250000,
+	BitRate_125K = 125000,
+	BitRate_Auto = 0		//detected from the first edges of the capture (DetectBitRate), before a decoder starts
+};
+
+enum BitSampling
+{
+	BitSampling_SamplePoints,	//advance to every bit's sample point and read it
+	BitSampling_EdgeRuns		//walk the edges and turn each run length into a number of bits
+};
+
+enum MarkerPolicy
+{
+	Markers_None,
+	Markers_StuffBitsAndErrors,
+	Markers_EveryBit
+};
+
+enum ResultDetail
+{
+	Results_Fields,		//a frame for every field: identifier, control, each data byte, CRC and ACK
+	Results_Compact		//one frame per message
+};
+
+//the same bits as the SDK's frame flags (AnalyzerResults.h).
+#ifndef DISPLAY_AS_ERROR_FLAG
+#define DISPLAY_AS_ERROR_FLAG ( 1 << 7 )
+#endif
+#ifndef DISPLAY_AS_WARNING_FLAG
+#define DISPLAY_AS_WARNING_FLAG ( 1 << 6 )
+#endif
+
+class DeviceNetDecoderSettings
+{
+public:
+	DeviceNetDecoderSettings();
+
+	U32 mSampleRateHz;
+	enum BitRate mBitRate;
+	bool mInverted;
+	enum BitSampling mBitSampling;
+	enum MarkerPolicy mMarkerPolicy;
+	enum ResultDetail mResultDetail;
+
+	BitState Recessive() const;
+	BitState Dominant() const;
+};
+
+//what the decoder reports: laid out like the SDK's Frame, with mType one of DeviceNetFrameType.
+class DeviceNetRecord
+{
+public:
+	U64 mStartingSampleInclusive;
+	U64 mEndingSampleInclusive;
+	U64 mData1;
+	U64 mData2;
+	U8 mType;
+	U8 mFlags;
+};
+
+enum DeviceNetMarkerType
+{
+	BitMarker,
+	StuffBitMarker,
+	ErrorMarker
+};
+
+//what a listener rebuilding the records of an event needs besides them (see DeviceNetDecodeCache): where the frame
+//started, and where the error or overload flag started before it was moved clear of the last field.  END_OF_EDGES
+//when the event has no such thing.
+class DeviceNetEventInfo
+{
+public:
+	U64 mStartOfFrame;
+	U64 mFlagStart;
+};
+
+class DeviceNetDecoderListener
+{
+public:
+	virtual ~DeviceNetDecoderListener() {}
+
+	virtual void OnRecord( const DeviceNetRecord& record ) = 0;
+	virtual void OnMarker( U64 sample, DeviceNetMarkerType type ) = 0;
+
+	//everything since the last call belongs to one frame, error or overload frame.
+	virtual void OnEventEnd( const DeviceNetEventInfo& /*info*/ ) {}
+};
+
+//what SkipBusIdle found at the end of the recessive stretch
+enum BusEvent
+{
+	StartOfFrameEdge,
+	ErrorFlagEdge,
+	OverloadFlagEdge,
+	EndOfEdges,
+	StopEdge	//at or after the stop sample: left for whoever decodes from there
+};
+
+//automatic bit rate detection: how many pulses we look at (at most / at least), and the histogram size in
+//quarter bits at 500 kbit/s -- a bit at 125 kbit/s is 16 of them, the last bin takes anything longer.
+#define AUTO_BIT_RATE_PULSES		256
+#define AUTO_BIT_RATE_MIN_PULSES	64
+#define AUTO_BIT_RATE_BINS			32
+
+//one marker per raw bit at most, and a frame is never longer than the sample offset table.
+#define MAX_FRAME_MARKERS	256
+
+//resynchronizations happen on recessive-to-dominant edges, so at most every other raw bit.
+#define MAX_SYNC_POINTS		( MAX_FRAME_MARKERS / 2 )
+
+//where a decoder is between two events: enough for another one to pick up from there (see Resume).
+class DeviceNetDecoderState
+{
+public:
+	U64 mSampleNumber;
+	U32 mBitRate;
+	U64 mIdleStart;
+	bool mIdleStartIsDelimiter;
+	U64 mLastFrameEndingSample;
+};
+
+class DeviceNetDecoder
+{
+public:
+	DeviceNetDecoder();
+	virtual ~DeviceNetDecoder();
+
+	//sets up the bit timing from wherever source is now.  The settings need a bit rate: not BitRate_Auto.
+	void Start( const DeviceNetDecoderSettings& settings, DeviceNetEdgeSource* source, DeviceNetDecoderListener* listener );
+
+	//decodes the next frame, error or overload frame; false once the source has no more edges.
+	bool DecodeNext();
+
+	U32 GetBitRate();
+
+	//the bit rate the pulses between num_edges edges look like (at least AUTO_BIT_RATE_MIN_PULSES of them, only the
+	//first AUTO_BIT_RATE_PULSES count).  The caller keeps the edges, so decoding can still start from the first.
+	static U32 DetectBitRate( const U64* edges, U32 num_edges, U32 sample_rate_hz );
+
+	//between events: where we are, and like Start, from there, with a source at or before that sample.
+	void GetState( DeviceNetDecoderState& state );
+	void Resume( const DeviceNetDecoderSettings& settings, DeviceNetEdgeSource* source, DeviceNetDecoderListener* listener, const DeviceNetDecoderState& state );
+
+	//carries on from where we are with another source, which has to be in the same place, and another listener.
+	void SetSource( DeviceNetEdgeSource* source, DeviceNetDecoderListener* listener );
+
+	//DecodeNext returns false at the first edge at or after stop_sample, rather than decode what it starts.
+	void SetStopSample( U64 stop_sample );
+
+	//once stopped: whether we stopped on the edge at edge_sample, after enough bus idle to take it as a start of
+	//frame -- the same as a decoder started in that idle time would.  And how long the bus was idle.
+	bool IsStoppedAtStartOfFrame( U64 edge_sample );
+	U64 GetIdleSamples();
+
+protected: //vars
+	DeviceNetDecoderSettings mSettings;
+	DeviceNetEdgeSource* mSource;
+	DeviceNetDecoderListener* mListener;
+	U32 mSampleRateHz;
+
+protected: //analysis functions
+	BusEvent SkipBusIdle();
+	void InitSampleOffsets();
+	void StartFrame();
+	void DecodeFrame();
+	void DecodeErrorFrame();
+	void DecodeOverloadFrame(U64 flag_start);
+	void AddErrorFrame(DeviceNetErrorFrameType type, U64 flag_start, U64 delimiter_start, U32 flag_bits);
+	void AddFieldFrame(DeviceNetRecord& frame);
+	void AddMessageFrame(U64 last_sample);
+	bool GetRawFrameBit(BitState& result, U64& sample);
+	void StartRawFrameRun();
+	void LoadRawFrameRun();
+	U32 GetRawFrameRunEnd();
+	void Resynchronize(U64 edge_sample, U32 bit_index);
+	U64 GetSampleOfRawBit(U32 index);
+	U32 GetBitIndexOfSample(U64 sample);
+	bool SampleRawFrameBits(U32 max_bits);
+	void LoadFrameBits(U32 num_bits);
+	bool GetFrameBit(BitState& result, U64& sample);
+	bool GetFrameBits(U32 num_bits, U32& value, U64& first_sample, U64& last_sample);
+	bool GetFixedFormFrameBit(BitState& result, U64& sample);
+	void AddFrameMarker(U64 sample, DeviceNetMarkerType type);
+	void AddRawBitMarkers(U32 first_bit, U32 end_bit);
+	void CommitFrameMarkers();
+
+protected: //analysis vars:
+	U32 mBitRate;		//from the settings, or detected
+	double mSamplesPerBit;
+	U32 mNumSamplesInBusIdle;
+	U32 mNumSamplesInDelimiter;
+	U32 mNumSamplesInIntermission;
+	U64 mIdleStart;		//where the bus went recessive after the last frame (as far as we know)
+	bool mIdleStartIsDelimiter;	//mIdleStart is the start of an ACK, error or overload delimiter
+	U64 mIdleSamples;	//and how long it stayed that way before the current one
+	U64 mStopSample;
+	U32 mRawFrameIndex;
+	BitState mLastRawBit;	//the last raw bit sampled,
+	U32 mSameRawBits;	//and how many in a row were the same
+	BitState mRunState;	//edge run-length sampling: state of the run the channel sits on,
+	U32 mRunEndBit;		//and the index of the first raw bit after it
+	bool mRunEndIsKnown;	//or just the first one we haven't seen it take in, if its edge isn't there yet
+	U64 mStartOfFrame;
+	U64 mSyncSample;	//the last (re)synchronization edge,
+	U32 mSyncBit;		//and the raw bit it starts: mSampleOffsets counts from there
+	U64 mSyncSamples[MAX_SYNC_POINTS];	//all of them since the start of frame, for bits further back
+	U32 mSyncBits[MAX_SYNC_POINTS];
+	U32 mNumSyncPoints;
+	U32 mSyncCursor;	//the one GetSampleOfRawBit used last
+	U32 mIdentifier;
+	U32 mCrcValue;
+	bool mCrcError;
+	bool mAck;
+
+	std::vector<U32> mSampleOffsets;
+
+	//the frame's markers, packed as (sample - mStartOfFrame) << 1 | DeviceNetMarkerType, and handed to the listener in one go
+	//once the frame is done.
+	U32 mFrameMarkers[MAX_FRAME_MARKERS];
+	U32 mNumFrameMarkers;
+	bool mMarkEveryBit;
+	bool mMarkStuffBitsAndErrors;
+
+	//the frame as sampled, and which of those bits were stuff bits -- recessive as 1.  We sample as far ahead as
+	//we know the frame goes on, and the destuffer takes the stuff bits out of each batch in one go.
+	DeviceNetBitBuffer mRawBits;
+	DeviceNetBitBuffer mStuffBits;
+	DeviceNetDestuffer mDestuffer;
+
+	//the frame with its stuff bits taken out, recessive as 1; the arbitration field starts right after the start bit.
+	DeviceNetBitBuffer mFrameBits;
+	U32 mFrameBitIndex;	//the next one to read,
+	U32 mFrameRawIndex;	//and the raw bit after the last one read
+	U32 mControlFieldStart;
+	U32 mDataFieldStart;
+	U32 mCrcFieldStart;
+
+	bool mStandardCan;
+	bool mRemoteFrame;
+	U32 mNumDataBytes;
+	BitState mCrcDelimiter;
+
+	U64 mLastFrameEndingSample;
+
+	bool mCanError;
+	DeviceNetErrorCause mErrorCause;
+	U64 mErrorStartingSample;
+	U64 mErrorEndingSample;
+
+	DeviceNetEventInfo mEventInfo;
+
+};
+
+#endif //DEVICENET_DECODER
@@ -0,0 +1,144 @@
+#include "DeviceNetDestuffer.h"
+#include <cstddef>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#include <immintrin.h>
+#define DEVICENET_BMI2_MSVC
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#include <immintrin.h>
+#define DEVICENET_BMI2_GCC
+#endif
+
+//5 raw bits of context in front of every chunk, so a chunk is at most 59 bits.
+#define DESTUFF_CONTEXT_BITS	5
+#define DESTUFF_CHUNK_BITS		( 64 - DESTUFF_CONTEXT_BITS )
+
+//what sits in front of the start bit: recessive bus idle, alternating further out so it can't look like a run.
+#define DESTUFF_IDLE_CONTEXT	0x15
+
+typedef U64 (*RemoveBitsFunction)(U64 value, U64 remove);
+
+static U64 RemoveBitsPortable(U64 value, U64 remove)
+{
+	//from the top one down, so the ones still to go stay where they are.
+	while (remove != 0)
+	{
+		U32 position = 63 - DeviceNetBitBuffer::CountLeadingZeros(remove);
+		U64 below = (U64(1) << position) - 1;
+		value = ((value >> 1) & ~below) | (value & below);
+		remove &= below;
+	}
+
+	return value;
+}
+
+#if defined(DEVICENET_BMI2_GCC)
+__attribute__((target("bmi2"))) static U64 RemoveBitsBmi2(U64 value, U64 remove)
+{
+	return _pext_u64(value, ~remove);
+}
+
+static bool CpuHasBmi2()
+{
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("bmi2") != 0;
+}
+#elif defined(DEVICENET_BMI2_MSVC)
+static U64 RemoveBitsBmi2(U64 value, U64 remove)
+{
+	return _pext_u64(value, ~remove);
+}
+
+static bool CpuHasBmi2()
+{
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+		return false;
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 8)) != 0;	//EBX bit 8
+}
+#else
+static U64 RemoveBitsBmi2(U64 value, U64 remove)
+{
+	return RemoveBitsPortable(value, remove);
+}
+
+static bool CpuHasBmi2()
+{
+	return false;
+}
+#endif
+
+static bool gBmi2Available = CpuHasBmi2();
+static RemoveBitsFunction gRemoveBits = (gBmi2Available == true) ? RemoveBitsBmi2 : RemoveBitsPortable;
+
+DeviceNetDestuffer::DeviceNetDestuffer()
+{
+	Reset();
+}
+
+void DeviceNetDestuffer::Reset()
+{
+	mNumRawBits = 0;
+	mErrorIndex = NO_STUFF_ERROR;
+}
+
+bool DeviceNetDestuffer::IsBmi2Available()
+{
+	return gBmi2Available;
+}
+
+void DeviceNetDestuffer::SetBmi2Enabled(bool enabled)
+{
+	gRemoveBits = ((enabled == true) && (gBmi2Available == true)) ? RemoveBitsBmi2 : RemoveBitsPortable;
+}
+
+U32 DeviceNetDestuffer::Destuff(const DeviceNetBitBuffer& raw_bits, DeviceNetBitBuffer& bits, DeviceNetBitBuffer& stuff_bits)
+{
+	while ((mErrorIndex == NO_STUFF_ERROR) && (mNumRawBits < raw_bits.GetNumBits()))
+	{
+		U32 num_bits = raw_bits.GetNumBits() - mNumRawBits;
+		if (num_bits > DESTUFF_CHUNK_BITS)
+			num_bits = DESTUFF_CHUNK_BITS;
+
+		//the chunk with its context in front, left aligned: word bit j is raw bit mNumRawBits - 5 + j.
+		U64 word;
+		if (mNumRawBits >= DESTUFF_CONTEXT_BITS)
+		{
+			word = raw_bits.GetBits(mNumRawBits - DESTUFF_CONTEXT_BITS, DESTUFF_CONTEXT_BITS + num_bits);
+		}
+		else
+		{
+			U64 context = (U64(DESTUFF_IDLE_CONTEXT) << mNumRawBits) | raw_bits.GetBits(0, mNumRawBits);
+			word = ((context & 0x1F) << num_bits) | raw_bits.GetBits(mNumRawBits, num_bits);
+		}
+		word <<= DESTUFF_CHUNK_BITS - num_bits;
+
+		//same: bit j and bit j - 1 are identical.  after_four: so are the four pairs before bit j.
+		U64 same = ~(word ^ (word >> 1));
+		U64 after_four = (same >> 1) & (same >> 2) & (same >> 3) & (same >> 4);
+		U64 chunk = ((U64(1) << num_bits) - 1) << (DESTUFF_CHUNK_BITS - num_bits);
+
+		U64 errors = after_four & same & chunk;
+		if (errors != 0)
+		{
+			//only the bits in front of the first error count.
+			U32 error_bit = DeviceNetBitBuffer::CountLeadingZeros(errors);
+			mErrorIndex = mNumRawBits - DESTUFF_CONTEXT_BITS + error_bit;
+			num_bits = error_bit - DESTUFF_CONTEXT_BITS;
+			chunk = (num_bits == 0) ? 0 : (((U64(1) << num_bits) - 1) << (DESTUFF_CHUNK_BITS - num_bits));
+		}
+
+		U64 stuff = after_four & ~same & chunk;
+		U32 shift = DESTUFF_CHUNK_BITS - num_bits;
+
+		bits.AppendBits(gRemoveBits((word & chunk) >> shift, stuff >> shift), num_bits - DeviceNetBitBuffer::CountOnes(stuff));
+		stuff_bits.AppendBits(stuff >> shift, num_bits);
+		mNumRawBits += num_bits;
+	}
+
+	return mErrorIndex;
+}
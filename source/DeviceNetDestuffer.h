@@ -0,0 +1,45 @@
+#ifndef DEVICENET_DESTUFFER
+#define DEVICENET_DESTUFFER
+
+#include <LogicPublicTypes.h>
+#include "DeviceNetBitBuffer.h"
+
+/*	Bulk CAN bit destuffing
+
+	The raw bits of a frame (recessive as 1, the start bit first) go through in 59-bit chunks, each in one word
+	together with the 5 raw bits before it.  XOR-ing the word with itself shifted by one bit marks every transition;
+	a bit that comes after four bits without one (five identical bits) is a stuff bit if it is a transition too, and
+	a stuff error if it isn't.  ANDing four shifted copies finds all of those at once, the first error is a count of
+	leading zeros away (the words are MSB-first), and the stuff bits are squeezed out with BMI2's PEXT where the CPU
+	has it -- checked once, at run time -- or one at a time otherwise.
+
+	A destuffer works through the raw bits of one frame as they're sampled: every call takes the ones added since
+	the last, up to the first stuff error.
+*/
+
+#define NO_STUFF_ERROR	0xFFFFFFFF
+
+class DeviceNetDestuffer
+{
+public:
+	DeviceNetDestuffer();
+
+	void Reset();
+
+	//appends the new raw bits, minus their stuff bits, to bits, and a 1 for every stuff bit (a 0 for any other) to
+	//stuff_bits.  Returns the index of the raw bit that broke the stuffing rule -- the sixth identical bit in a row --
+	//or NO_STUFF_ERROR.  Nothing from that bit on is destuffed.
+	U32 Destuff(const DeviceNetBitBuffer& raw_bits, DeviceNetBitBuffer& bits, DeviceNetBitBuffer& stuff_bits);
+
+	U32 GetNumRawBits() { return mNumRawBits; }	//destuffed so far (including stuff bits)
+	U32 GetErrorIndex() { return mErrorIndex; }
+
+	static bool IsBmi2Available();
+	static void SetBmi2Enabled(bool enabled);	//off falls back to the portable code even if the CPU has BMI2
+
+protected:
+	U32 mNumRawBits;
+	U32 mErrorIndex;
+};
+
+#endif //DEVICENET_DESTUFFER
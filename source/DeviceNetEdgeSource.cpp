@@ -0,0 +1,207 @@
+#include "DeviceNetEdgeSource.h"
+#include <cstddef>
+
+DeviceNetEdgeArray::DeviceNetEdgeArray()
+{
+	Clear( BIT_HIGH, 0 );
+}
+
+DeviceNetEdgeArray::~DeviceNetEdgeArray()
+{
+}
+
+void DeviceNetEdgeArray::Clear( BitState initial_state, U64 first_sample )
+{
+	mEdges.clear();
+	mInitialState = initial_state;
+	mFirstSample = first_sample;
+	Rewind();
+}
+
+void DeviceNetEdgeArray::AddEdge( U64 sample_number )
+{
+	mEdges.push_back( sample_number );
+}
+
+void DeviceNetEdgeArray::Rewind()
+{
+	mSampleNumber = mFirstSample;
+	mBitState = mInitialState;
+	mNextEdge = 0;
+}
+
+U64 DeviceNetEdgeArray::GetSampleNumber()
+{
+	return mSampleNumber;
+}
+
+BitState DeviceNetEdgeArray::GetBitState()
+{
+	return mBitState;
+}
+
+void DeviceNetEdgeArray::AdvanceToAbsPosition( U64 sample_number )
+{
+	if( sample_number < mSampleNumber )
+		return;
+
+	while( ( mNextEdge < mEdges.size() ) && ( mEdges[ mNextEdge ] <= sample_number ) )
+	{
+		mBitState = Invert( mBitState );
+		mNextEdge++;
+	}
+
+	mSampleNumber = sample_number;
+}
+
+void DeviceNetEdgeArray::AdvanceToNextEdge()
+{
+	if( mNextEdge == mEdges.size() )
+		return;
+
+	mSampleNumber = mEdges[ mNextEdge ];
+	mBitState = Invert( mBitState );
+	mNextEdge++;
+}
+
+U64 DeviceNetEdgeArray::GetSampleOfNextEdge()
+{
+	if( mNextEdge == mEdges.size() )
+		return END_OF_EDGES;
+
+	return mEdges[ mNextEdge ];
+}
+
+bool DeviceNetEdgeArray::WouldAdvancingToAbsPositionCauseTransition( U64 sample_number )
+{
+	return ( mNextEdge < mEdges.size() ) && ( mEdges[ mNextEdge ] <= sample_number );
+}
+
+bool DeviceNetEdgeArray::DoMoreTransitionsExistInCurrentData()
+{
+	return mNextEdge < mEdges.size();
+}
+
+bool DeviceNetEdgeArray::HasMoreEdges()
+{
+	return mNextEdge < mEdges.size();
+}
+
+DeviceNetEdgeSpan::DeviceNetEdgeSpan()
+{
+	Set( NULL, 0, 0, BIT_HIGH, 0, NULL );
+}
+
+DeviceNetEdgeSpan::~DeviceNetEdgeSpan()
+{
+}
+
+void DeviceNetEdgeSpan::Set( const U64* edges, U32 begin, U32 end, BitState initial_state, U64 first_sample, DeviceNetEdgeSource* tail )
+{
+	mEdges = edges;
+	mNextEdge = begin;
+	mEndEdge = end;
+	mTail = tail;
+	mSampleNumber = first_sample;
+	mBitState = initial_state;
+}
+
+U32 DeviceNetEdgeSpan::GetNextEdgeIndex()
+{
+	return mNextEdge;
+}
+
+bool DeviceNetEdgeSpan::InTail()
+{
+	return ( mNextEdge == mEndEdge ) && ( mTail != NULL );
+}
+
+U64 DeviceNetEdgeSpan::GetSampleNumber()
+{
+	if( InTail() == true )
+		return mTail->GetSampleNumber();
+
+	return mSampleNumber;
+}
+
+BitState DeviceNetEdgeSpan::GetBitState()
+{
+	if( InTail() == true )
+		return mTail->GetBitState();
+
+	return mBitState;
+}
+
+void DeviceNetEdgeSpan::AdvanceToAbsPosition( U64 sample_number )
+{
+	if( InTail() == true )
+	{
+		mTail->AdvanceToAbsPosition( sample_number );
+		return;
+	}
+
+	if( sample_number < mSampleNumber )
+		return;
+
+	while( ( mNextEdge < mEndEdge ) && ( mEdges[ mNextEdge ] <= sample_number ) )
+	{
+		mBitState = Invert( mBitState );
+		mNextEdge++;
+	}
+
+	mSampleNumber = sample_number;
+
+	if( InTail() == true )
+		mTail->AdvanceToAbsPosition( sample_number );
+}
+
+void DeviceNetEdgeSpan::AdvanceToNextEdge()
+{
+	if( InTail() == true )
+	{
+		mTail->AdvanceToNextEdge();
+		return;
+	}
+
+	if( mNextEdge == mEndEdge )
+		return;
+
+	mSampleNumber = mEdges[ mNextEdge ];
+	mBitState = Invert( mBitState );
+	mNextEdge++;
+}
+
+U64 DeviceNetEdgeSpan::GetSampleOfNextEdge()
+{
+	if( InTail() == true )
+		return mTail->GetSampleOfNextEdge();
+
+	if( mNextEdge == mEndEdge )
+		return END_OF_EDGES;
+
+	return mEdges[ mNextEdge ];
+}
+
+bool DeviceNetEdgeSpan::WouldAdvancingToAbsPositionCauseTransition( U64 sample_number )
+{
+	if( InTail() == true )
+		return mTail->WouldAdvancingToAbsPositionCauseTransition( sample_number );
+
+	return ( mNextEdge < mEndEdge ) && ( mEdges[ mNextEdge ] <= sample_number );
+}
+
+bool DeviceNetEdgeSpan::DoMoreTransitionsExistInCurrentData()
+{
+	if( InTail() == true )
+		return mTail->DoMoreTransitionsExistInCurrentData();
+
+	return mNextEdge < mEndEdge;
+}
+
+bool DeviceNetEdgeSpan::HasMoreEdges()
+{
+	if( InTail() == true )
+		return mTail->HasMoreEdges();
+
+	return mNextEdge < mEndEdge;
+}
@@ -0,0 +1,93 @@
+#ifndef DEVICENET_EDGE_SOURCE
+#define DEVICENET_EDGE_SOURCE
+
+#include <LogicPublicTypes.h>
+#include <vector>
+
+//where the decoder gets its bits from: the handful of AnalyzerChannelData calls it uses, so the same decoder
+//runs on a Logic capture (see DeviceNetChannelEdgeSource) or on edges from anywhere else.
+class DeviceNetEdgeSource
+{
+public:
+	virtual ~DeviceNetEdgeSource() {}
+
+	virtual U64 GetSampleNumber() = 0;
+	virtual BitState GetBitState() = 0;
+	virtual void AdvanceToAbsPosition( U64 sample_number ) = 0;
+	virtual void AdvanceToNextEdge() = 0;
+	virtual U64 GetSampleOfNextEdge() = 0;
+	virtual bool WouldAdvancingToAbsPositionCauseTransition( U64 sample_number ) = 0;
+	virtual bool DoMoreTransitionsExistInCurrentData() = 0;
+
+	//false once there won't be any more edges.  A Logic capture never says so: the SDK waits for more data, and
+	//ends the worker thread when there isn't going to be any.
+	virtual bool HasMoreEdges() = 0;
+};
+
+//a finished recording in memory: the state at the first sample and every edge after it.  Past the last edge
+//the line keeps its state for good, and the next edge is at END_OF_EDGES.
+#define END_OF_EDGES	0xFFFFFFFFFFFFFFFFull
+
+class DeviceNetEdgeArray : public DeviceNetEdgeSource
+{
+public:
+	DeviceNetEdgeArray();
+	virtual ~DeviceNetEdgeArray();
+
+	void Clear( BitState initial_state, U64 first_sample );
+	void AddEdge( U64 sample_number );		//edges have to come in order
+	void Rewind();
+
+	virtual U64 GetSampleNumber();
+	virtual BitState GetBitState();
+	virtual void AdvanceToAbsPosition( U64 sample_number );
+	virtual void AdvanceToNextEdge();
+	virtual U64 GetSampleOfNextEdge();
+	virtual bool WouldAdvancingToAbsPositionCauseTransition( U64 sample_number );
+	virtual bool DoMoreTransitionsExistInCurrentData();
+	virtual bool HasMoreEdges();
+
+protected:
+	std::vector<U64> mEdges;
+	BitState mInitialState;
+	U64 mFirstSample;
+
+	U64 mSampleNumber;
+	BitState mBitState;
+	U32 mNextEdge;
+};
+
+//edges begin to end of somebody else's array, with the line in initial_state from first_sample on.  Past the
+//last one the line keeps its state, or, with a tail, the tail takes over: it has to be at that last edge (at
+//first_sample if there are none) by then.
+class DeviceNetEdgeSpan : public DeviceNetEdgeSource
+{
+public:
+	DeviceNetEdgeSpan();
+	virtual ~DeviceNetEdgeSpan();
+
+	void Set( const U64* edges, U32 begin, U32 end, BitState initial_state, U64 first_sample, DeviceNetEdgeSource* tail );
+	U32 GetNextEdgeIndex();		//into edges: end once the span is used up
+
+	virtual U64 GetSampleNumber();
+	virtual BitState GetBitState();
+	virtual void AdvanceToAbsPosition( U64 sample_number );
+	virtual void AdvanceToNextEdge();
+	virtual U64 GetSampleOfNextEdge();
+	virtual bool WouldAdvancingToAbsPositionCauseTransition( U64 sample_number );
+	virtual bool DoMoreTransitionsExistInCurrentData();
+	virtual bool HasMoreEdges();
+
+protected:
+	bool InTail();
+
+	const U64* mEdges;
+	U32 mNextEdge;
+	U32 mEndEdge;
+	DeviceNetEdgeSource* mTail;
+
+	U64 mSampleNumber;
+	BitState mBitState;
+};
+
+#endif //DEVICENET_EDGE_SOURCE
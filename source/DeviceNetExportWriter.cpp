@@ -0,0 +1,159 @@
+#include "DeviceNetExportWriter.h"
+#include <AnalyzerHelpers.h>
+#include <string.h>
+
+static const char gHexDigits[] = "0123456789ABCDEF";
+
+DeviceNetExportWriter::DeviceNetExportWriter( void* file )
+:	mFile( file ),
+	mBuffer( NULL ),
+	mNumBytes( 0 ),
+	mCapacity( ( file != NULL ) ? EXPORT_BUFFER_BYTES : EXPORT_MEMORY_BUFFER_BYTES )
+{
+	mBuffer = new char[ mCapacity ];
+}
+
+DeviceNetExportWriter::~DeviceNetExportWriter()
+{
+	delete[] mBuffer;
+}
+
+void DeviceNetExportWriter::Write( const char* text )
+{
+	Write( text, U32( strlen( text ) ) );
+}
+
+void DeviceNetExportWriter::Write( const char* data, U32 num_bytes )
+{
+	//more than a buffer full goes straight through
+	if( ( mFile != NULL ) && ( num_bytes > mCapacity ) )
+	{
+		Flush();
+		AnalyzerHelpers::AppendToFile( ( const U8* )data, num_bytes, mFile );
+		return;
+	}
+
+	memcpy( Reserve( num_bytes ), data, num_bytes );
+	mNumBytes += num_bytes;
+}
+
+U32 DeviceNetExportWriter::WriteDecimal( U64 number, U32 min_digits )
+{
+	char digits[ 20 ];
+	U32 num_digits = 0;
+	do
+	{
+		digits[ num_digits++ ] = char( '0' + number % 10 );
+		number /= 10;
+	}
+	while( ( number != 0 ) || ( ( num_digits < min_digits ) && ( num_digits < 20 ) ) );
+
+	char* p = Reserve( num_digits );
+	for( U32 i = 0; i < num_digits; i++ )
+		p[ i ] = digits[ num_digits - 1 - i ];
+	mNumBytes += num_digits;
+
+	return num_digits;
+}
+
+U32 DeviceNetExportWriter::WriteHex( U64 number, U32 min_digits )
+{
+	U32 num_digits = 1;
+	while( ( num_digits < 16 ) && ( ( number >> ( 4 * num_digits ) ) != 0 ) )
+		num_digits++;
+	if( num_digits < min_digits )
+		num_digits = ( min_digits < 16 ) ? min_digits : 16;
+
+	char* p = Reserve( num_digits );
+	for( U32 i = 0; i < num_digits; i++ )
+		p[ i ] = gHexDigits[ ( number >> ( 4 * ( num_digits - 1 - i ) ) ) & 0xF ];
+	mNumBytes += num_digits;
+
+	return num_digits;
+}
+
+void DeviceNetExportWriter::WriteRepeated( char c, U32 count )
+{
+	for( U32 i = 0; i < count; i++ )
+		WriteChar( c );
+}
+
+void DeviceNetExportWriter::WriteNumber( U64 number, DisplayBase display_base, U32 num_bits )
+{
+	if( ( num_bits == 0 ) || ( num_bits > 64 ) )
+		num_bits = 64;
+	if( num_bits < 64 )
+		number &= ( 1ull << num_bits ) - 1;
+
+	if( display_base == Decimal )
+	{
+		WriteDecimal( number );
+		return;
+	}
+
+	if( display_base == Hexadecimal )
+	{
+		//0x, then a digit per 4 bits, leading zeros and all
+		Write( "0x", 2 );
+		WriteHex( number, ( num_bits + 3 ) / 4 );
+		return;
+	}
+
+	char number_str[ EXPORT_MAX_NUMBER_CHARS ];
+	AnalyzerHelpers::GetNumberString( number, display_base, num_bits, number_str, EXPORT_MAX_NUMBER_CHARS );
+	Write( number_str );
+}
+
+void DeviceNetExportWriter::WriteLittleEndian( U64 value, U32 num_bytes )
+{
+	char* p = Reserve( num_bytes );
+	for( U32 i = 0; i < num_bytes; i++ )
+		p[ i ] = char( value >> ( 8 * i ) );
+	mNumBytes += num_bytes;
+}
+
+void DeviceNetExportWriter::WriteBigEndian( U64 value, U32 num_bytes )
+{
+	char* p = Reserve( num_bytes );
+	for( U32 i = 0; i < num_bytes; i++ )
+		p[ i ] = char( value >> ( 8 * ( num_bytes - 1 - i ) ) );
+	mNumBytes += num_bytes;
+}
+
+void DeviceNetExportWriter::Flush()
+{
+	if( mFile == NULL )
+		return;
+
+	if( mNumBytes != 0 )
+		AnalyzerHelpers::AppendToFile( ( const U8* )mBuffer, mNumBytes, mFile );
+
+	mNumBytes = 0;
+}
+
+char* DeviceNetExportWriter::Reserve( U32 num_bytes )
+{
+	if( mNumBytes + num_bytes > mCapacity )
+		MakeRoom( num_bytes );
+
+	return mBuffer + mNumBytes;
+}
+
+void DeviceNetExportWriter::MakeRoom( U32 num_bytes )
+{
+	if( mFile != NULL )
+	{
+		Flush();
+		return;
+	}
+
+	U32 capacity = mCapacity;
+	while( mNumBytes + num_bytes > capacity )
+		capacity *= 2;
+
+	char* buffer = new char[ capacity ];
+	memcpy( buffer, mBuffer, mNumBytes );
+	delete[] mBuffer;
+	mBuffer = buffer;
+	mCapacity = capacity;
+}
@@ -0,0 +1,61 @@
+#ifndef DEVICENET_EXPORT_WRITER
+#define DEVICENET_EXPORT_WRITER
+
+#include <AnalyzerTypes.h>
+#include <LogicPublicTypes.h>
+
+/*	Buffered output for the export files
+
+	An export can run to millions of rows, so nothing goes through a stream or a temporary string: text is
+	formatted straight into one buffer, which goes to the file EXPORT_BUFFER_BYTES at a time.  Hexadecimal and
+	decimal numbers are formatted here, the way AnalyzerHelpers::GetNumberString has them; the other display
+	bases are rare enough to go through it.
+
+	A writer with no file (NULL) keeps everything in memory instead, its buffer growing as it needs to: the
+	parallel export formats each chunk of packets into one of those, then writes it to the file's writer.
+*/
+
+#define EXPORT_BUFFER_BYTES			( 1 << 20 )
+#define EXPORT_MEMORY_BUFFER_BYTES	( 1 << 16 )	//to start with
+#define EXPORT_MAX_NUMBER_CHARS	128		//the longest a number gets: 64 bits in binary, with the spaces
+
+class DeviceNetExportWriter
+{
+public:
+	DeviceNetExportWriter( void* file );
+	~DeviceNetExportWriter();
+
+	void Write( const char* text );
+	void Write( const char* data, U32 num_bytes );
+	void WriteChar( char c ) { if( mNumBytes == mCapacity ) MakeRoom( 1 ); mBuffer[ mNumBytes++ ] = c; }
+	void WriteNumber( U64 number, DisplayBase display_base, U32 num_bits );
+
+	//plain numbers, with leading zeros up to min_digits: how many characters they took.
+	U32 WriteDecimal( U64 number, U32 min_digits = 1 );
+	U32 WriteHex( U64 number, U32 min_digits = 1 );	//upper case, no 0x
+
+	void WriteRepeated( char c, U32 count );
+
+	//binary: the low num_bytes of value, least significant first, or most significant first.
+	void WriteLittleEndian( U64 value, U32 num_bytes );
+	void WriteBigEndian( U64 value, U32 num_bytes );
+
+	//what's in the buffer goes to the file: call it before the file is closed.  Nothing, with no file.
+	void Flush();
+
+	//with no file: what's been written, and starting again.
+	const char* GetData() { return mBuffer; }
+	U32 GetNumBytes() { return mNumBytes; }
+	void Clear() { mNumBytes = 0; }
+
+protected:
+	char* Reserve( U32 num_bytes );
+	void MakeRoom( U32 num_bytes );
+
+	void* mFile;
+	char* mBuffer;
+	U32 mNumBytes;
+	U32 mCapacity;
+};
+
+#endif //DEVICENET_EXPORT_WRITER
@@ -0,0 +1,114 @@
+#include "DeviceNetLatency.h"
+#include <string.h>
+#include <math.h>
+
+DeviceNetLatencyHistogram::DeviceNetLatencyHistogram()
+{
+	Clear();
+}
+
+void DeviceNetLatencyHistogram::Clear()
+{
+	mCount = 0;
+	mMax = 0;
+	memset( mBuckets, 0, sizeof( mBuckets ) );
+}
+
+void DeviceNetLatencyHistogram::Add( U64 samples )
+{
+	mBuckets[ GetBucket( samples ) ]++;
+	mCount++;
+	if( samples > mMax )
+		mMax = samples;
+}
+
+U64 DeviceNetLatencyHistogram::GetCount()
+{
+	return mCount;
+}
+
+U64 DeviceNetLatencyHistogram::GetMax()
+{
+	return mMax;
+}
+
+U64 DeviceNetLatencyHistogram::GetPercentile( double percentile )
+{
+	if( mCount == 0 )
+		return 0;
+
+	//the first bucket where the count so far reaches the rank
+	U64 rank = U64( ceil( percentile * double( mCount ) / 100.0 ) );
+	if( rank < 1 )
+		rank = 1;
+
+	U64 count = 0;
+	for( U32 bucket = 0; bucket < LATENCY_NUM_BUCKETS; bucket++ )
+	{
+		count += mBuckets[ bucket ];
+		if( count >= rank )
+		{
+			U64 samples = GetBucketMax( bucket );
+			return ( samples < mMax ) ? samples : mMax;
+		}
+	}
+
+	return mMax;
+}
+
+U32 DeviceNetLatencyHistogram::GetBucket( U64 samples )
+{
+	if( samples >= ( 1ull << LATENCY_MAX_BITS ) )
+		samples = ( 1ull << LATENCY_MAX_BITS ) - 1;
+
+	//keep the top LATENCY_SUB_BUCKET_BITS + 1 bits: the leading one picks the power of two, the rest the bucket in it
+	U32 shift = 0;
+	while( ( samples >> shift ) >= ( 2 * LATENCY_SUB_BUCKETS ) )
+		shift++;
+
+	return shift * LATENCY_SUB_BUCKETS + U32( samples >> shift );
+}
+
+U64 DeviceNetLatencyHistogram::GetBucketMax( U32 bucket )
+{
+	if( bucket < 2 * LATENCY_SUB_BUCKETS )
+		return bucket;
+
+	U32 shift = bucket / LATENCY_SUB_BUCKETS - 1;
+	U64 top_bits = bucket - shift * LATENCY_SUB_BUCKETS;
+	return ( ( top_bits + 1 ) << shift ) - 1;
+}
+
+DeviceNetLatencyStats::DeviceNetLatencyStats()
+{
+	memset( mNumUnanswered, 0, sizeof( mNumUnanswered ) );
+}
+
+void DeviceNetLatencyStats::Clear()
+{
+	for( U32 mac_id = 0; mac_id < NUM_MAC_IDS; mac_id++ )
+		for( U32 kind = 0; kind < NumLatencyKinds; kind++ )
+			mHistograms[ mac_id ][ kind ].Clear();
+
+	memset( mNumUnanswered, 0, sizeof( mNumUnanswered ) );
+}
+
+void DeviceNetLatencyStats::AddLatency( U32 mac_id, enum DeviceNetLatencyKind kind, U64 samples )
+{
+	mHistograms[ mac_id ][ kind ].Add( samples );
+}
+
+void DeviceNetLatencyStats::AddUnanswered( U32 mac_id, enum DeviceNetLatencyKind kind )
+{
+	mNumUnanswered[ mac_id ][ kind ]++;
+}
+
+DeviceNetLatencyHistogram& DeviceNetLatencyStats::GetHistogram( U32 mac_id, enum DeviceNetLatencyKind kind )
+{
+	return mHistograms[ mac_id ][ kind ];
+}
+
+U64 DeviceNetLatencyStats::GetNumUnanswered( U32 mac_id, enum DeviceNetLatencyKind kind )
+{
+	return mNumUnanswered[ mac_id ][ kind ];
+}
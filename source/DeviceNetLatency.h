@@ -0,0 +1,72 @@
+#ifndef DEVICENET_LATENCY
+#define DEVICENET_LATENCY
+
+#include <LogicPublicTypes.h>
+#include "DeviceNetProtocol.h"
+
+/*	How long devices take to answer, per MAC ID
+
+	The connection tracker times every poll command to the poll response, and every explicit request to its
+	response, from start of frame to start of frame, and adds the time to the responder's histogram as it goes.
+	A request that gets another one before its response is counted as unanswered.
+
+	A histogram is log-bucketed, the way HdrHistogram does it: below 2 * LATENCY_SUB_BUCKETS samples every value
+	has a bucket of its own, and above that every power of two is split into LATENCY_SUB_BUCKETS buckets, so a
+	bucket is never wider than 1/32 of the values in it (3%).  That's a fixed 1024 counts from one sample to
+	2^LATENCY_MAX_BITS samples (over two minutes at 500 MHz); longer times go in the last bucket.  The maximum is
+	kept exactly.
+*/
+
+#define LATENCY_SUB_BUCKET_BITS	5
+#define LATENCY_SUB_BUCKETS		( 1 << LATENCY_SUB_BUCKET_BITS )
+#define LATENCY_MAX_BITS		36
+#define LATENCY_NUM_BUCKETS		( ( LATENCY_MAX_BITS - LATENCY_SUB_BUCKET_BITS + 1 ) * LATENCY_SUB_BUCKETS )
+
+enum DeviceNetLatencyKind
+{
+	PollLatency,		// Group 2 poll command to Group 1 poll response
+	ExplicitLatency,	// explicit request to explicit response, Group 2 or 3
+	NumLatencyKinds
+};
+
+class DeviceNetLatencyHistogram
+{
+public:
+	DeviceNetLatencyHistogram();
+
+	void Clear();
+	void Add( U64 samples );
+
+	U64 GetCount();
+	U64 GetMax();
+
+	//the time percentile percent (0..100) of them took at most, to the bucket's resolution.
+	U64 GetPercentile( double percentile );
+
+protected:
+	static U32 GetBucket( U64 samples );
+	static U64 GetBucketMax( U32 bucket );
+
+	U64 mCount;
+	U64 mMax;
+	U32 mBuckets[ LATENCY_NUM_BUCKETS ];
+};
+
+class DeviceNetLatencyStats
+{
+public:
+	DeviceNetLatencyStats();
+
+	void Clear();
+	void AddLatency( U32 mac_id, enum DeviceNetLatencyKind kind, U64 samples );
+	void AddUnanswered( U32 mac_id, enum DeviceNetLatencyKind kind );
+
+	DeviceNetLatencyHistogram& GetHistogram( U32 mac_id, enum DeviceNetLatencyKind kind );
+	U64 GetNumUnanswered( U32 mac_id, enum DeviceNetLatencyKind kind );
+
+protected:
+	DeviceNetLatencyHistogram mHistograms[ NUM_MAC_IDS ][ NumLatencyKinds ];
+	U64 mNumUnanswered[ NUM_MAC_IDS ][ NumLatencyKinds ];
+};
+
+#endif //DEVICENET_LATENCY
@@ -0,0 +1,357 @@
+#include "DeviceNetParallelDecoder.h"
+#include "DeviceNetProtocol.h"
+#include <algorithm>
+#include <thread>
+
+DeviceNetEventBuffer::DeviceNetEventBuffer()
+{
+}
+
+DeviceNetEventBuffer::~DeviceNetEventBuffer()
+{
+}
+
+void DeviceNetEventBuffer::Clear()
+{
+	mRecords.clear();
+	mMarkers.clear();
+	mEventRecordEnds.clear();
+	mEventMarkerEnds.clear();
+	mEventInfos.clear();
+}
+
+void DeviceNetEventBuffer::SetIdleSamples( U64 idle_samples )
+{
+	//the first event starts with the frame's identifier field (unless it broke before that, or it's compact), and
+	//the fields after it carry the same mData2 up to the CRC.
+	if( mEventRecordEnds.empty() == true )
+		return;
+
+	for( U32 i = 0; i < mEventRecordEnds[ 0 ]; i++ )
+	{
+		U8 type = mRecords[ i ].mType;
+		bool identifier = ( type == IdentifierField ) || ( type == IdentifierFieldEx );
+
+		if( ( i == 0 ) && ( identifier == false ) )
+			return;
+		if( ( identifier == false ) && ( type != ControlField ) && ( type != DataField ) )
+			return;
+
+		mRecords[ i ].mData2 = idle_samples;
+	}
+}
+
+void DeviceNetEventBuffer::Replay( DeviceNetDecoderListener* listener )
+{
+	U32 record = 0;
+	U32 marker = 0;
+
+	for( U32 i = 0; i < mEventRecordEnds.size(); i++ )
+	{
+		//the decoder hands over an event's markers after its records.
+		for( ; record < mEventRecordEnds[ i ]; record++ )
+			listener->OnRecord( mRecords[ record ] );
+
+		for( ; marker < mEventMarkerEnds[ i ]; marker++ )
+			listener->OnMarker( mMarkers[ marker ] >> 2, DeviceNetMarkerType( mMarkers[ marker ] & 3 ) );
+
+		listener->OnEventEnd( mEventInfos[ i ] );
+	}
+}
+
+void DeviceNetEventBuffer::OnRecord( const DeviceNetRecord& record )
+{
+	mRecords.push_back( record );
+}
+
+void DeviceNetEventBuffer::OnMarker( U64 sample, DeviceNetMarkerType type )
+{
+	mMarkers.push_back( ( sample << 2 ) | U64( type ) );
+}
+
+void DeviceNetEventBuffer::OnEventEnd( const DeviceNetEventInfo& info )
+{
+	mEventRecordEnds.push_back( U32( mRecords.size() ) );
+	mEventMarkerEnds.push_back( U32( mMarkers.size() ) );
+	mEventInfos.push_back( info );
+}
+
+DeviceNetParallelDecoder::DeviceNetParallelDecoder()
+:	mNumThreads( 1 ),
+	mSource( NULL ),
+	mListener( NULL ),
+	mNumChunks( 0 )
+{
+	mDecoders.push_back( new DeviceNetDecoder() );
+}
+
+DeviceNetParallelDecoder::~DeviceNetParallelDecoder()
+{
+	for( U32 i = 0; i < mDecoders.size(); i++ )
+		delete mDecoders[ i ];
+}
+
+void DeviceNetParallelDecoder::SetNumThreads( U32 num_threads )
+{
+	mNumThreads = num_threads;
+	if( mNumThreads == 0 )
+		mNumThreads = std::thread::hardware_concurrency();
+	if( mNumThreads == 0 )
+		mNumThreads = 1;
+}
+
+void DeviceNetParallelDecoder::Start( const DeviceNetDecoderSettings& settings, U32 num_threads, DeviceNetEdgeSource* source, DeviceNetDecoderListener* listener )
+{
+	SetNumThreads( num_threads );
+	mSource = source;
+	mListener = listener;
+	mEdges.clear();
+
+	if( mNumThreads == 1 )
+	{
+		mDecoders[ 0 ]->Start( settings, source, listener );
+		return;
+	}
+
+	//the first decoder reads from the source itself; the chunks' decoders use the bit timing it set up.
+	mSpan.Set( NULL, 0, 0, source->GetBitState(), source->GetSampleNumber(), source );
+	mDecoders[ 0 ]->Start( settings, &mSpan, listener );
+
+	mSettings = settings;
+	mSettings.mBitRate = BitRate( mDecoders[ 0 ]->GetBitRate() );
+
+	mFirstState = source->GetBitState();
+	mFirstSample = source->GetSampleNumber();
+}
+
+void DeviceNetParallelDecoder::GetState( DeviceNetDecoderState& state )
+{
+	//the first decoder's source is where the edges we have read but not decoded yet start.
+	mDecoders[ 0 ]->GetState( state );
+}
+
+void DeviceNetParallelDecoder::Resume( const DeviceNetDecoderSettings& settings, U32 num_threads, DeviceNetEdgeSource* source, DeviceNetDecoderListener* listener, const DeviceNetDecoderState& state )
+{
+	SetNumThreads( num_threads );
+	mSource = source;
+	mListener = listener;
+	mEdges.clear();
+
+	if( mNumThreads == 1 )
+	{
+		mDecoders[ 0 ]->Resume( settings, source, listener, state );
+		return;
+	}
+
+	mSource->AdvanceToAbsPosition( state.mSampleNumber );
+	mSpan.Set( NULL, 0, 0, source->GetBitState(), source->GetSampleNumber(), source );
+	mDecoders[ 0 ]->Resume( settings, &mSpan, listener, state );
+
+	mSettings = settings;
+	mSettings.mBitRate = BitRate( state.mBitRate );
+
+	mFirstState = source->GetBitState();
+	mFirstSample = source->GetSampleNumber();
+}
+
+U32 DeviceNetParallelDecoder::GetBitRate()
+{
+	return mDecoders[ 0 ]->GetBitRate();
+}
+
+U32 DeviceNetParallelDecoder::GetNumThreads()
+{
+	return mNumThreads;
+}
+
+bool DeviceNetParallelDecoder::DecodeNext()
+{
+	if( mNumThreads == 1 )
+		return mDecoders[ 0 ]->DecodeNext();
+
+	bool end_of_edges = ReadWindow();
+
+	if( ( mEdges.size() >= PARALLEL_MIN_EDGES ) && ( FindChunks( end_of_edges ) == true ) )
+		return DecodeWindow( end_of_edges );
+
+	return DecodeSerial();
+}
+
+bool DeviceNetParallelDecoder::ReadWindow()
+{
+	//whatever the source already has, without waiting for more.  True if that's all there is going to be.
+	while( ( mEdges.size() < PARALLEL_WINDOW_EDGES ) && ( mSource->DoMoreTransitionsExistInCurrentData() == true ) )
+	{
+		mSource->AdvanceToNextEdge();
+		mEdges.push_back( mSource->GetSampleNumber() );
+	}
+
+	return mSource->HasMoreEdges() == false;
+}
+
+bool DeviceNetParallelDecoder::FindChunks( bool end_of_edges )
+{
+	//a chunk starts at a falling edge after enough recessive bits, and (unless these are the last edges) far
+	//enough from the end of the window for the decoder of the chunk before it to look ahead as far as it wants.
+	double samples_per_bit = double( mSettings.mSampleRateHz ) / double( mSettings.mBitRate );
+	U64 split_idle = U64( samples_per_bit * PARALLEL_SPLIT_IDLE_BITS );
+	U64 lookahead = U64( samples_per_bit * PARALLEL_LOOKAHEAD_BITS );
+
+	U32 num_edges = U32( mEdges.size() );
+	U64 last_start = END_OF_EDGES;
+	if( end_of_edges == false )
+	{
+		if( mEdges.back() - mFirstSample < lookahead )
+			return false;
+		last_start = mEdges.back() - lookahead;
+	}
+
+	U32 chunk_edges = num_edges / ( mNumThreads * PARALLEL_CHUNKS_PER_THREAD );
+	if( chunk_edges < PARALLEL_MIN_CHUNK_EDGES )
+		chunk_edges = PARALLEL_MIN_CHUNK_EDGES;
+	chunk_edges &= ~1u;
+
+	mChunkStarts.clear();
+	mChunkStarts.push_back( 0 );
+
+	//the rising edges are every other one.
+	U32 i = ( mFirstState == mSettings.Dominant() ) ? 0 : 1;
+	i += chunk_edges;
+
+	while( i + 1 < num_edges )
+	{
+		if( mEdges[ i + 1 ] > last_start )
+			break;
+
+		if( mEdges[ i + 1 ] - mEdges[ i ] >= split_idle )
+		{
+			mChunkStarts.push_back( i + 1 );
+			i += chunk_edges;
+		}
+
+		i += 2;
+	}
+
+	//the last chunk waits for the next window: unless that was the last of the edges, we need two.
+	if( end_of_edges == false )
+		return mChunkStarts.size() > 2;
+
+	return mChunkStarts.size() > 1;
+}
+
+bool DeviceNetParallelDecoder::DecodeSerial()
+{
+	//the first decoder goes on through the window and on into the source, for one event at least: with no edges
+	//read, that waits for the next one like a DeviceNetDecoder would.
+	DeviceNetDecoder* decoder = mDecoders[ 0 ];
+
+	mSpan.Set( mEdges.data(), 0, U32( mEdges.size() ), mFirstState, mFirstSample, mSource );
+	decoder->SetSource( &mSpan, mListener );
+	decoder->SetStopSample( END_OF_EDGES );
+
+	do
+	{
+		if( decoder->DecodeNext() == false )
+			return false;
+	}
+	while( mSpan.GetNextEdgeIndex() < mEdges.size() );
+
+	mEdges.clear();
+	mFirstState = mSource->GetBitState();
+	mFirstSample = mSource->GetSampleNumber();
+	return true;
+}
+
+U64 DeviceNetParallelDecoder::GetChunkStopSample( U32 chunk )
+{
+	if( chunk + 1 < mChunkStarts.size() )
+		return mEdges[ mChunkStarts[ chunk + 1 ] ];
+
+	return END_OF_EDGES;
+}
+
+bool DeviceNetParallelDecoder::DecodeWindow( bool end_of_edges )
+{
+	U32 num_chunks = U32( mChunkStarts.size() );
+	if( end_of_edges == false )
+		num_chunks--;
+
+	while( mDecoders.size() < num_chunks )
+		mDecoders.push_back( new DeviceNetDecoder() );
+	if( mSpans.size() < num_chunks )
+		mSpans.resize( num_chunks );
+	if( mBuffers.size() < num_chunks )
+		mBuffers.resize( num_chunks );
+
+	//the first chunk goes on from where the first decoder is; the others start in the idle time before them.
+	U32 num_edges = U32( mEdges.size() );
+	for( U32 i = 0; i < num_chunks; i++ )
+	{
+		mBuffers[ i ].Clear();
+
+		if( i == 0 )
+		{
+			mSpans[ i ].Set( mEdges.data(), 0, num_edges, mFirstState, mFirstSample, NULL );
+			mDecoders[ i ]->SetSource( &mSpans[ i ], &mBuffers[ i ] );
+		}
+		else
+		{
+			U32 start = mChunkStarts[ i ];
+			mSpans[ i ].Set( mEdges.data(), start, num_edges, mSettings.Recessive(), mEdges[ start - 1 ], NULL );
+			mDecoders[ i ]->Start( mSettings, &mSpans[ i ], &mBuffers[ i ] );
+		}
+
+		mDecoders[ i ]->SetStopSample( GetChunkStopSample( i ) );
+	}
+
+	mNumChunks = num_chunks;
+	mPool.Run( this, std::min( mNumThreads, num_chunks ) );
+
+	//in order, from the decoder that got as far as the chunk: either the chunk's own results go on from where it
+	//stopped, or it decodes the chunk itself.
+	mBuffers[ 0 ].Replay( mListener );
+	U32 last = 0;
+
+	for( U32 i = 1; i < num_chunks; i++ )
+	{
+		DeviceNetDecoder* decoder = mDecoders[ last ];
+
+		if( decoder->IsStoppedAtStartOfFrame( mEdges[ mChunkStarts[ i ] ] ) == true )
+		{
+			mBuffers[ i ].SetIdleSamples( decoder->GetIdleSamples() );
+			mBuffers[ i ].Replay( mListener );
+			last = i;
+		}
+		else
+		{
+			decoder->SetSource( &mSpans[ last ], mListener );
+			decoder->SetStopSample( GetChunkStopSample( i ) );
+			while( decoder->DecodeNext() == true )
+				;
+		}
+	}
+
+	//whichever decoder that was goes on with the next window, from where it stopped.
+	std::swap( mDecoders[ 0 ], mDecoders[ last ] );
+
+	DeviceNetEdgeSpan& span = mSpans[ last ];
+	mFirstState = span.GetBitState();
+	mFirstSample = span.GetSampleNumber();
+	mEdges.erase( mEdges.begin(), mEdges.begin() + span.GetNextEdgeIndex() );
+
+	return end_of_edges == false;
+}
+
+void DeviceNetParallelDecoder::RunJob( U32 worker )
+{
+	DecodeChunks( worker, mNumChunks );
+}
+
+void DeviceNetParallelDecoder::DecodeChunks( U32 first_chunk, U32 num_chunks )
+{
+	for( U32 i = first_chunk; i < num_chunks; i += mNumThreads )
+	{
+		while( mDecoders[ i ]->DecodeNext() == true )
+			;
+	}
+}
@@ -0,0 +1,115 @@
+#ifndef DEVICENET_PARALLEL_DECODER
+#define DEVICENET_PARALLEL_DECODER
+
+#include <LogicPublicTypes.h>
+#include <vector>
+#include "DeviceNetDecoder.h"
+#include "DeviceNetEdgeSource.h"
+#include "DeviceNetWorkerPool.h"
+
+/*	DeviceNetDecoder on several threads
+
+	The edges are read from the source in windows, and each window is cut into chunks at bus idle: a dominant edge
+	after at least 10.5 recessive bits (11, give or take the clock drift -- ACK delimiter, END OF FRAME and
+	INTERMISSION) can only start a frame.  Every chunk is decoded on a worker thread by a decoder of its own that
+	starts in that idle time, into a buffer, and the buffers go to the listener in sample order.
+
+	Where a chunk starts, the decoder of the one before it stops.  If it stops right on the chunk's first edge, with
+	the bus idle long enough, it agrees with the chunk's decoder about everything from there on; if it doesn't (a
+	broken frame ran on into the idle time, say) it decodes the chunk itself instead.  Either way the listener gets
+	exactly what a single DeviceNetDecoder would have given it.  The worker threads are the pool's, which stay up
+	from window to window.  The last chunk of a window is left for the next one,
+	so every stop has enough edges after it to look ahead; when there aren't enough edges for more than one chunk
+	(we're right behind a live capture) a single decoder carries on straight from the source.
+*/
+
+#define PARALLEL_WINDOW_EDGES		( 1 << 20 )	//read at most this many edges at a time,
+#define PARALLEL_MIN_EDGES			( 1 << 16 )	//and decode on one thread with fewer than this.
+#define PARALLEL_MIN_CHUNK_EDGES	( 1 << 12 )
+#define PARALLEL_CHUNKS_PER_THREAD	4			//so a thread with quick chunks can take on more of them
+#define PARALLEL_SPLIT_IDLE_BITS	10.5
+#define PARALLEL_LOOKAHEAD_BITS		512			//a chunk never starts closer than this to the end of the window
+
+//what a chunk's decoder found, kept until it's the chunk's turn: the records and markers, and where each event ends.
+class DeviceNetEventBuffer : public DeviceNetDecoderListener
+{
+public:
+	DeviceNetEventBuffer();
+	virtual ~DeviceNetEventBuffer();
+
+	void Clear();
+
+	//the chunk's decoder didn't see all of the idle time before the first frame: put in how long it really was.
+	void SetIdleSamples( U64 idle_samples );
+
+	void Replay( DeviceNetDecoderListener* listener );
+
+	virtual void OnRecord( const DeviceNetRecord& record );
+	virtual void OnMarker( U64 sample, DeviceNetMarkerType type );
+	virtual void OnEventEnd( const DeviceNetEventInfo& info );
+
+protected:
+	std::vector<DeviceNetRecord> mRecords;
+	std::vector<U64> mMarkers;	//sample << 2 | DeviceNetMarkerType
+	std::vector<U32> mEventRecordEnds;
+	std::vector<U32> mEventMarkerEnds;
+	std::vector<DeviceNetEventInfo> mEventInfos;
+};
+
+class DeviceNetParallelDecoder : public DeviceNetWorkerJob
+{
+public:
+	DeviceNetParallelDecoder();
+	~DeviceNetParallelDecoder();
+
+	//like DeviceNetDecoder::Start; num_threads 0 is one per core, and 1 runs a DeviceNetDecoder straight off the source.
+	void Start( const DeviceNetDecoderSettings& settings, U32 num_threads, DeviceNetEdgeSource* source, DeviceNetDecoderListener* listener );
+
+	//like DeviceNetDecoder::GetState and Resume: between two calls to DecodeNext, everything before the state's
+	//sample number is decoded, and nothing after it.
+	void GetState( DeviceNetDecoderState& state );
+	void Resume( const DeviceNetDecoderSettings& settings, U32 num_threads, DeviceNetEdgeSource* source, DeviceNetDecoderListener* listener, const DeviceNetDecoderState& state );
+
+	//decodes the next event, and as many after it as the edges the source has right now allow; false once the
+	//source has no more edges.
+	bool DecodeNext();
+
+	U32 GetBitRate();
+	U32 GetNumThreads();
+
+	//a worker's chunks of the window.
+	virtual void RunJob( U32 worker );
+
+protected: //functions
+	void SetNumThreads( U32 num_threads );
+	bool ReadWindow();
+	bool FindChunks( bool end_of_edges );
+	bool DecodeSerial();
+	bool DecodeWindow( bool end_of_edges );
+	void DecodeChunks( U32 first_chunk, U32 num_chunks );
+	U64 GetChunkStopSample( U32 chunk );
+
+protected: //vars
+	DeviceNetDecoderSettings mSettings;	//for the chunks: with the bit rate the first decoder started with
+	U32 mNumThreads;
+	DeviceNetEdgeSource* mSource;
+	DeviceNetDecoderListener* mListener;
+
+	//the edges read from the source that aren't decoded yet, and the line where the first decoder is now.
+	std::vector<U64> mEdges;
+	BitState mFirstState;
+	U64 mFirstSample;
+	DeviceNetEdgeSpan mSpan;	//the window, then the source
+
+	//a decoder, span and buffer per chunk.  The first decoder goes on from window to window: it has decoded
+	//everything before mFirstSample.
+	std::vector<U32> mChunkStarts;	//the index of each chunk's first edge, the one that starts a frame
+	std::vector<DeviceNetDecoder*> mDecoders;
+	std::vector<DeviceNetEdgeSpan> mSpans;
+	std::vector<DeviceNetEventBuffer> mBuffers;
+	U32 mNumChunks;
+
+	DeviceNetWorkerPool mPool;
+};
+
+#endif //DEVICENET_PARALLEL_DECODER
@@ -0,0 +1,98 @@
+#include "DeviceNetParallelExport.h"
+#include <algorithm>
+#include <thread>
+
+DeviceNetParallelExport::DeviceNetParallelExport( U32 num_threads, AnalyzerResults* results, DeviceNetExportFormatter* formatter )
+:	mNumThreads( num_threads ),
+	mResults( results ),
+	mFormatter( formatter ),
+	mNumChunks( 0 ),
+	mFirstPacket( 0 ),
+	mEndPacket( 0 )
+{
+	if( mNumThreads == 0 )
+		mNumThreads = std::thread::hardware_concurrency();
+	if( mNumThreads == 0 )
+		mNumThreads = 1;
+
+	for( U32 i = 0; i < mNumThreads * EXPORT_CHUNKS_PER_THREAD; i++ )
+		mBuffers.push_back( new DeviceNetExportWriter( NULL ) );
+}
+
+DeviceNetParallelExport::~DeviceNetParallelExport()
+{
+	for( U32 i = 0; i < mBuffers.size(); i++ )
+		delete mBuffers[ i ];
+}
+
+U64 DeviceNetParallelExport::GetRoundPackets()
+{
+	return U64( mBuffers.size() ) * EXPORT_CHUNK_PACKETS;
+}
+
+void DeviceNetParallelExport::FormatPackets( DeviceNetExportWriter& writer, U64 first_packet, U64 end_packet )
+{
+	if( end_packet <= first_packet )
+		return;
+	end_packet = std::min( end_packet, first_packet + GetRoundPackets() );
+
+	ReadFrames( first_packet, end_packet );
+
+	//one thread's worth is formatted straight into the file's buffer
+	if( ( mNumThreads == 1 ) || ( end_packet - first_packet <= EXPORT_CHUNK_PACKETS ) )
+	{
+		FormatRange( writer, first_packet, end_packet );
+		return;
+	}
+
+	mNumChunks = U32( ( end_packet - first_packet + EXPORT_CHUNK_PACKETS - 1 ) / EXPORT_CHUNK_PACKETS );
+	mPool.Run( this, std::min( mNumThreads, mNumChunks ) );
+
+	for( U32 i = 0; i < mNumChunks; i++ )
+		writer.Write( mBuffers[ i ]->GetData(), mBuffers[ i ]->GetNumBytes() );
+}
+
+void DeviceNetParallelExport::RunJob( U32 worker )
+{
+	U32 num_threads = std::min( mNumThreads, mNumChunks );
+
+	for( U32 i = worker; i < mNumChunks; i += num_threads )
+	{
+		DeviceNetExportWriter* buffer = mBuffers[ i ];
+		buffer->Clear();
+
+		U64 first_packet = mFirstPacket + U64( i ) * EXPORT_CHUNK_PACKETS;
+		FormatRange( *buffer, first_packet, std::min( mEndPacket, first_packet + EXPORT_CHUNK_PACKETS ) );
+	}
+}
+
+void DeviceNetParallelExport::ReadFrames( U64 first_packet, U64 end_packet )
+{
+	mFirstPacket = first_packet;
+	mEndPacket = end_packet;
+	mFrames.clear();
+	mPacketStarts.clear();
+
+	for( U64 packet_id = first_packet; packet_id < end_packet; packet_id++ )
+	{
+		U64 first_frame_id;
+		U64 last_frame_id;
+		mResults->GetFramesContainedInPacket( packet_id, &first_frame_id, &last_frame_id );
+
+		mPacketStarts.push_back( U32( mFrames.size() ) );
+		for( U64 frame_id = first_frame_id; frame_id <= last_frame_id; frame_id++ )
+			mFrames.push_back( mResults->GetFrame( frame_id ) );
+	}
+
+	mPacketStarts.push_back( U32( mFrames.size() ) );
+}
+
+void DeviceNetParallelExport::FormatRange( DeviceNetExportWriter& writer, U64 first_packet, U64 end_packet )
+{
+	for( U64 packet_id = first_packet; packet_id < end_packet; packet_id++ )
+	{
+		U32 i = U32( packet_id - mFirstPacket );
+		U32 num_frames = mPacketStarts[ i + 1 ] - mPacketStarts[ i ];
+		mFormatter->FormatPacket( writer, packet_id, mFrames.data() + mPacketStarts[ i ], num_frames );
+	}
+}
@@ -0,0 +1,70 @@
+#ifndef DEVICENET_PARALLEL_EXPORT
+#define DEVICENET_PARALLEL_EXPORT
+
+#include <AnalyzerResults.h>
+#include <vector>
+#include "DeviceNetExportWriter.h"
+#include "DeviceNetWorkerPool.h"
+
+/*	Export formatting on several threads
+
+	A packet's row (or record) depends on nothing but the packet's own frames, so the packets are cut into chunks
+	of EXPORT_CHUNK_PACKETS, and the chunks are formatted side by side on the worker pool, each into a buffer of its
+	own.  The buffers then go to the file's writer in packet order: the file is exactly what formatting the packets
+	one after another would have written.
+
+	Nothing promises the SDK's results can be read from more than one thread, so the workers never touch them: the
+	calling thread copies a round's frames -- EXPORT_CHUNKS_PER_THREAD chunks for every thread -- out of the results
+	first, and the workers format from that copy.  Between rounds, the export reports its progress and checks for
+	cancel, on the calling thread as well.
+*/
+
+#define EXPORT_CHUNK_PACKETS		1024
+#define EXPORT_CHUNKS_PER_THREAD	4		//so a thread with quick chunks can take on more of them
+
+//what writes a packet, from a copy of its frames: called from the worker threads, for packets of other chunks at
+//the same time.
+class DeviceNetExportFormatter
+{
+public:
+	virtual ~DeviceNetExportFormatter() {}
+
+	virtual void FormatPacket( DeviceNetExportWriter& writer, U64 packet_id, Frame* frames, U32 num_frames ) = 0;
+};
+
+class DeviceNetParallelExport : public DeviceNetWorkerJob
+{
+public:
+	DeviceNetParallelExport( U32 num_threads, AnalyzerResults* results, DeviceNetExportFormatter* formatter );	//0 for one per core
+	~DeviceNetParallelExport();
+
+	//how many packets FormatPackets takes at most: the round.
+	U64 GetRoundPackets();
+
+	//packets first_packet up to (not including) end_packet, formatted and written to writer in order.
+	void FormatPackets( DeviceNetExportWriter& writer, U64 first_packet, U64 end_packet );
+
+	//a worker's chunks of the round.
+	virtual void RunJob( U32 worker );
+
+protected:
+	void ReadFrames( U64 first_packet, U64 end_packet );
+	void FormatRange( DeviceNetExportWriter& writer, U64 first_packet, U64 end_packet );
+
+	U32 mNumThreads;
+	AnalyzerResults* mResults;
+	DeviceNetExportFormatter* mFormatter;
+	std::vector<DeviceNetExportWriter*> mBuffers;
+	U32 mNumChunks;
+
+	//the round's frames, and where each packet starts: packet mFirstPacket + i has mFrames[ mPacketStarts[ i ] ]
+	//up to mFrames[ mPacketStarts[ i + 1 ] ].
+	U64 mFirstPacket;
+	U64 mEndPacket;
+	std::vector<Frame> mFrames;
+	std::vector<U32> mPacketStarts;
+
+	DeviceNetWorkerPool mPool;
+};
+
+#endif //DEVICENET_PARALLEL_EXPORT
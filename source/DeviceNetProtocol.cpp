@@ -1,5 +1,80 @@
 #include "DeviceNetProtocol.h"
 
+// The classification word of one identifier, from the ranges and special values above
+static constexpr U32 ComposeIdentifierClass(U32 group, U32 message_id, U32 mac_id, U32 kind)
+{
+	return (mac_id << IDENTIFIER_CLASS_MAC_ID_SHIFT) | (message_id << IDENTIFIER_CLASS_MESSAGE_ID_SHIFT) | (group << IDENTIFIER_CLASS_GROUP_SHIFT) | (kind << IDENTIFIER_CLASS_KIND_SHIFT);
+}
+
+static constexpr U32 ClassifyIdentifierBits(U32 identifier)
+{
+	if (identifier < START_ADDR_MESSAGE_GROUP_2)
+	{
+		U32 message_id = (identifier & MASK_GROUP_1_MESSAGE_ID) >> SHIFT_GROUP_1_MESSAGE_ID;
+		U32 mac_id = (identifier & MASK_SOURCE_MAC_ID) >> SHIFT_SOURCE_MAC_ID;
+		return ComposeIdentifierClass(MessageGroup1, message_id, mac_id, OrdinaryMessage);
+	}
+
+	if (identifier < START_ADDR_MESSAGE_GROUP_3)
+	{
+		U32 message_id = (identifier & MASK_GROUP_2_MESSAGE_ID) >> SHIFT_GROUP_2_MESSAGE_ID;
+		U32 mac_id = (identifier & MASK_MAC_ID) >> SHIFT_MAC_ID;
+		U32 kind = OrdinaryMessage;
+		if (message_id == CHECK_GROUP_2_MSG_ID_IS_CONNECTION_MANAGEMENT)
+			kind = ConnectionManagementMessage;
+		else if (message_id == CHECK_GROUP_2_MSG_ID_IS_CHECK_MESSAGE)
+			kind = DuplicateMacIdCheckMessage;
+		return ComposeIdentifierClass(MessageGroup2, message_id, mac_id, kind);
+	}
+
+	if (identifier < START_ADDR_MESSAGE_GROUP_4)
+	{
+		U32 message_id = (identifier & MASK_GROUP_3_MESSAGE_ID) >> SHIFT_GROUP_3_MESSAGE_ID;
+		U32 mac_id = (identifier & MASK_SOURCE_MAC_ID) >> SHIFT_SOURCE_MAC_ID;
+		U32 kind = OrdinaryMessage;
+		if (message_id == CHECK_GROUP_3_MSG_ID_IS_EXPLICIT_RESPONSE)
+			kind = UnconnectedExplicitResponse;
+		else if (message_id == CHECK_GROUP_3_MSG_ID_IS_EXPLICIT_REQUEST)
+			kind = UnconnectedExplicitRequest;
+		else if (message_id == CHECK_GROUP_3_MSG_ID_IS_RESERVED)
+			kind = ReservedGroup3Message;
+		return ComposeIdentifierClass(MessageGroup3, message_id, mac_id, kind);
+	}
+
+	if (identifier < START_ADDR_INVALID_CAN_IDS)
+	{
+		U32 message_id = (identifier & MASK_GROUP_4_MESSAGE_ID) >> SHIFT_GROUP_4_MESSAGE_ID;
+		U32 kind = ReservedGroup4Message;
+		if (message_id == CHECK_GROUP_4_MSG_ID_IS_COM_FAULTED_RESPONSE)
+			kind = CommunicationFaultedResponse;
+		else if (message_id == CHECK_GROUP_4_MSG_ID_IS_COM_FAULTED_REQUEST)
+			kind = CommunicationFaultedRequest;
+		else if (message_id == CHECK_GROUP_4_MSG_ID_IS_OFFLINE_OWNERSHIP_RESPONSE)
+			kind = OfflineOwnershipResponse;
+		else if (message_id == CHECK_GROUP_4_MSG_ID_IS_OFFLINE_OWNERSHIP_REQUEST)
+			kind = OfflineOwnershipRequest;
+		return ComposeIdentifierClass(MessageGroup4, message_id, 0, kind);
+	}
+
+	return ComposeIdentifierClass(InvalidCanIdentifiers, 0, 0, OrdinaryMessage);
+}
+
+static constexpr DeviceNetIdentifierTable ComposeIdentifierTable()
+{
+	DeviceNetIdentifierTable table = {};
+	for (U32 i = 0; i < NUM_IDENTIFIERS; i++)
+		table.mClasses[i] = ClassifyIdentifierBits(i);
+	return table;
+}
+
+// Built by the compiler: nothing runs at startup, and looking an identifier up is a single load
+extern const DeviceNetIdentifierTable gDeviceNetIdentifierTable;
+constexpr DeviceNetIdentifierTable gDeviceNetIdentifierTable = ComposeIdentifierTable();
+
+static_assert(gDeviceNetIdentifierTable.mClasses[0x5FE] == ComposeIdentifierClass(MessageGroup2, 6, 0x3F, ConnectionManagementMessage), "Group 2 identifier classification");
+static_assert(gDeviceNetIdentifierTable.mClasses[0x7AF] == ComposeIdentifierClass(MessageGroup3, 6, 0x2F, UnconnectedExplicitRequest), "Group 3 identifier classification");
+static_assert(gDeviceNetIdentifierTable.mClasses[0x7EF] == ComposeIdentifierClass(MessageGroup4, 0x2F, 0, OfflineOwnershipRequest), "Group 4 identifier classification");
+
 DeviceNetProtocol::DeviceNetProtocol()
 {
 	// Identity usage
@@ -101,88 +176,74 @@ void DeviceNetProtocol::DecomposeArbitrationField(U32 mArbitrationField)
 	mArbitrationFieldIdentifierBits = ((mArbitrationField & 0x00000FFE ) >> 1);
 	mArbitrationFieldRtrBit = ((mArbitrationField & 0x00000001) >> 0);
 
-	// Decode the identifier-bits to figure out the Message Group
-	if ((mArbitrationFieldIdentifierBits >= START_ADDR_MESSAGE_GROUP_1) && (mArbitrationFieldIdentifierBits < START_ADDR_MESSAGE_GROUP_2))
-	{
-		mMessageGroup1 = true;
-		mGroup1MessageID = ((mArbitrationFieldIdentifierBits & MASK_GROUP_1_MESSAGE_ID) >> SHIFT_GROUP_1_MESSAGE_ID);
-		mSourceMacID_MG1 = ((mArbitrationFieldIdentifierBits & MASK_SOURCE_MAC_ID) >> SHIFT_SOURCE_MAC_ID);
-	}
-	else if ((mArbitrationFieldIdentifierBits >= START_ADDR_MESSAGE_GROUP_2) && (mArbitrationFieldIdentifierBits < START_ADDR_MESSAGE_GROUP_3))
-	{
-		mMessageGroup2 = true;
-		mMacID = ((mArbitrationFieldIdentifierBits & MASK_MAC_ID) >> SHIFT_MAC_ID);
-		mGroup2MessageID = ((mArbitrationFieldIdentifierBits & MASK_GROUP_2_MESSAGE_ID) >> SHIFT_GROUP_2_MESSAGE_ID);
-		if (mGroup2MessageID == CHECK_GROUP_2_MSG_ID_IS_CONNECTION_MANAGEMENT)
-		{
-			mReservedMacIdConnectionManagement = true;
-		}
-		if (mGroup2MessageID == CHECK_GROUP_2_MSG_ID_IS_CHECK_MESSAGE)
-		{
-			mDuplicateMacIdCheckMessage = true;
-		}
-	}
-	else if ((mArbitrationFieldIdentifierBits >= START_ADDR_MESSAGE_GROUP_3) && (mArbitrationFieldIdentifierBits < START_ADDR_MESSAGE_GROUP_4))
-	{
-		mMessageGroup3 = true;
-
-		mGroup3MessageID = ((mArbitrationFieldIdentifierBits & MASK_GROUP_3_MESSAGE_ID) >> SHIFT_GROUP_3_MESSAGE_ID);
-
-		if (mGroup3MessageID == CHECK_GROUP_3_MSG_ID_IS_EXPLICIT_RESPONSE)
-		{
-			mExplicitResponseMessage = true;
-		}
-		if (mGroup3MessageID == CHECK_GROUP_3_MSG_ID_IS_EXPLICIT_REQUEST)
-		{
-			mExplicitRequestMessage = true;
-		}
-		if (mGroup3MessageID == CHECK_GROUP_3_MSG_ID_IS_RESERVED)
-		{
-			mReservedGroup3MsgID = true;
-		}
-
-		mSourceMacID_MG3 = ((mArbitrationFieldIdentifierBits & MASK_SOURCE_MAC_ID) >> SHIFT_SOURCE_MAC_ID);
-	}
-	else if ((mArbitrationFieldIdentifierBits >= START_ADDR_MESSAGE_GROUP_4) && (mArbitrationFieldIdentifierBits < START_ADDR_INVALID_CAN_IDS))
-	{
-		mMessageGroup4 = true;
-
-		mGroup4MessageID = ((mArbitrationFieldIdentifierBits & MASK_GROUP_4_MESSAGE_ID) >> SHIFT_GROUP_4_MESSAGE_ID);
-
-		if (mGroup4MessageID == CHECK_GROUP_4_MSG_ID_IS_COM_FAULTED_RESPONSE)
-		{
-			mCommunicationFaultedResponseMessage = true;
-		}
-		else if (mGroup4MessageID == CHECK_GROUP_4_MSG_ID_IS_COM_FAULTED_REQUEST)
-		{
-			mCommunicationFaultedRequestMessage = true;
-		}
-		else if (mGroup4MessageID == CHECK_GROUP_4_MSG_ID_IS_OFFLINE_OWNERSHIP_RESPONSE)
-		{
-			mOfflineOwnershipResponseMessage = true;
-		}
-		else if (mGroup4MessageID == CHECK_GROUP_4_MSG_ID_IS_OFFLINE_OWNERSHIP_REQUEST)
-		{
-			mOfflineOwnershipRequestMessage = true;
-		}
-		else
-		{
-			mReservedGroup4MsgID = true;
-		}
-	}
-	else if ((mArbitrationFieldIdentifierBits >= START_ADDR_INVALID_CAN_IDS) && (mArbitrationFieldIdentifierBits < START_ADDR_INVALID_IDENTIFIER))
-	{
-		mInvalidCanIdentifiers = true;
-	}
-	else
-	{
-		mIdentifierError = true;
-	}
+	// The identifier-bits are all in the table; a group's members are 0 unless it's this identifier's group
+	U32 identifier_class = ClassifyIdentifier(mArbitrationFieldIdentifierBits);
+	IdentifierType group = GetIdentifierGroup(identifier_class);
+	U32 message_id = GetIdentifierMessageID(identifier_class);
+	U32 mac_id = GetIdentifierMacID(identifier_class);
+	DeviceNetMessageKind kind = GetIdentifierMessageKind(identifier_class);
 
-	if (mArbitrationFieldRtrBit != BIT_RTR)
-	{
-		mRtrBitError = true;
-	}
+	mMessageGroup1 = (group == MessageGroup1);
+	mMessageGroup2 = (group == MessageGroup2);
+	mMessageGroup3 = (group == MessageGroup3);
+	mMessageGroup4 = (group == MessageGroup4);
+	mInvalidCanIdentifiers = (group == InvalidCanIdentifiers);
+
+	mGroup1MessageID = (mMessageGroup1 == true) ? message_id : 0;
+	mSourceMacID_MG1 = (mMessageGroup1 == true) ? mac_id : 0;
+	mMacID = (mMessageGroup2 == true) ? mac_id : 0;
+	mGroup2MessageID = (mMessageGroup2 == true) ? message_id : 0;
+	mGroup3MessageID = (mMessageGroup3 == true) ? message_id : 0;
+	mSourceMacID_MG3 = (mMessageGroup3 == true) ? mac_id : 0;
+	mGroup4MessageID = (mMessageGroup4 == true) ? message_id : 0;
+
+	mReservedMacIdConnectionManagement = (kind == ConnectionManagementMessage);
+	mDuplicateMacIdCheckMessage = (kind == DuplicateMacIdCheckMessage);
+
+	mExplicitResponseMessage = (kind == UnconnectedExplicitResponse);
+	mExplicitRequestMessage = (kind == UnconnectedExplicitRequest);
+	mReservedGroup3MsgID = (kind == ReservedGroup3Message);
+
+	mReservedGroup4MsgID = (kind == ReservedGroup4Message);
+	mCommunicationFaultedResponseMessage = (kind == CommunicationFaultedResponse);
+	mCommunicationFaultedRequestMessage = (kind == CommunicationFaultedRequest);
+	mOfflineOwnershipResponseMessage = (kind == OfflineOwnershipResponse);
+	mOfflineOwnershipRequestMessage = (kind == OfflineOwnershipRequest);
+
+	// 12 bits can't hold anything past the identifier ranges
+	mIdentifierError = false;
+	mRtrBitError = (mArbitrationFieldRtrBit != BIT_RTR);
+}
+
+// The slave's explicit responses and the master's explicit requests in Group 2, and Group 3's (but for the reserved ID 7)
+bool DeviceNetProtocol::IsExplicitConnection(U32 identifier_class)
+{
+	IdentifierType group = GetIdentifierGroup(identifier_class);
+	U32 message_id = GetIdentifierMessageID(identifier_class);
+
+	if (group == MessageGroup2)
+		return (message_id == 3) || (message_id == 4) || (message_id == CHECK_GROUP_2_MSG_ID_IS_CONNECTION_MANAGEMENT);
+
+	if (group == MessageGroup3)
+		return (message_id != CHECK_GROUP_3_MSG_ID_IS_RESERVED);
+
+	return false;
+}
+
+// Group 1's, the master's multicast poll, change of state / cyclic acknowledge and poll commands.  The bit strobe command
+// is always 8 bytes of bits.
+bool DeviceNetProtocol::IsIOConnection(U32 identifier_class)
+{
+	IdentifierType group = GetIdentifierGroup(identifier_class);
+	U32 message_id = GetIdentifierMessageID(identifier_class);
+
+	if (group == MessageGroup1)
+		return true;
+
+	if (group == MessageGroup2)
+		return (message_id == 1) || (message_id == 2) || (message_id == 5);
+
+	return false;
 }
 
 void DeviceNetProtocol::DecomposeControlField(U32 mControlField)
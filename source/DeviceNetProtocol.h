@@ -1,8 +1,7 @@
 #ifndef DEVICENET_PROTOCOL
 #define DEVICENET_PROTOCOL
 
-#include <AnalyzerSettings.h>
-#include <AnalyzerTypes.h>
+#include <LogicPublicTypes.h>
 
 /*	DeviceNet specific
 
@@ -108,6 +107,7 @@
 // Address-Ranges MAC ID's
 #define START_ADDR_MAC_ID	0x00000000	// "The MAC ID.  The value 63 (decimal) is to be utilized upon initialization of a device (e.g. powerup) if another value has not been assigned."
 #define END_ADDR_MAC_ID		0x0000003F
+#define NUM_MAC_IDS			0x00000040
 
 // Masks to decode and shift the Member's in Message Group's
 #define MASK_GROUP_1_MESSAGE_ID		0x000003C0	// Bit 9:6
@@ -156,6 +156,8 @@
 #define BIT_R0	0x00000000	// always dominant '0' since DeviceNet is based on CAN 2.0A where r0 is reserved.
 
 #define LENGTH_ARBITRATION_FIELD	12
+#define LENGTH_IDENTIFIER			11
+#define LENGTH_CRC_SEQUENCE			15
 #define LENGTH_DATA_LENGTH_CODE		4
 #define LENGTH_DATA_BYTE			8
 #define LENGTH_END_OF_FRAME			7
@@ -168,10 +170,75 @@ enum DeviceNetFrameType
 	DataField,
 	CrcField,
 	AckField,
-	DeviceNetError
+	DeviceNetError,
+	CanMessage,			// compact results: the whole message in one frame, see below
+	ReassembledMessage	// a fragmented message put back together (DeviceNetReassembler), see below
 };
 
 #define REMOTE_FRAME ( 1 << 0 )
+#define CRC_ERROR ( 1 << 1 )
+#define EXTENDED_IDENTIFIER ( 1 << 2 )	// CanMessage only
+#define ACK_RECEIVED ( 1 << 3 )			// CanMessage only
+
+// DeviceNetError frames
+//   mData1: bits 0..7 DeviceNetErrorFrameType, 8..15 the DeviceNetErrorCause that started it
+//   mData2: the length of the dominant flag in bits
+enum DeviceNetErrorFrameType
+{
+	ActiveErrorFrame,	// 6 dominant bits, up to 12 with the other nodes' flags on top
+	PassiveErrorFrame,	// 6 recessive bits
+	OverloadFrame
+};
+
+enum DeviceNetErrorCause
+{
+	NoError,
+	StuffError,
+	FormError,
+	FrameTooLong		// ran out of sample offsets without finding the end of the frame
+};
+
+#define ERROR_CAUSE_SHIFT	8
+#define FLAG_SUPERPOSITION ( 1 << 4 )	// DeviceNetError only: the flag is longer than 6 bits
+
+// CanMessage frame layout
+//   mData1: bits 0..28 identifier, 32..35 DLC, 36..39 connection (see below), 40..47 the flags above, 48..62 CRC sequence
+//   mData2: the data bytes, the first one in bits 56..63
+#define COMPACT_IDENTIFIER_MASK		0x1FFFFFFF
+#define COMPACT_DLC_SHIFT			32
+#define COMPACT_DLC_MASK			0xF
+#define COMPACT_FLAGS_SHIFT			40
+#define COMPACT_FLAGS_MASK			0xFF
+#define COMPACT_CRC_SHIFT			48
+
+// The Predefined Master/Slave connection a message is on (DeviceNetConnectionTracker)
+//   IdentifierField and CanMessage frames: mData1 bits 36..39, so the identifier is mData1 & COMPACT_IDENTIFIER_MASK
+enum DeviceNetConnection
+{
+	NoConnection,
+	ExplicitConnection,
+	PollConnection,
+	BitStrobeConnection,
+	MulticastPollConnection,
+	ChangeOfStateConnection,
+	CyclicConnection
+};
+
+#define CONNECTION_SHIFT			36
+#define CONNECTION_MASK				0xF
+
+// ReassembledMessage frame layout: over the END OF FRAME of the last fragment
+//   mData1: bits 0..10 identifier of the fragments, 16..21 the MAC ID of the explicit message header,
+//           32..47 the number of fragments, 48..63 how many of them were acknowledged (explicit messages)
+//   mData2: bits 0..23 the length of the message, 24..63 where it is in the results' payload arena
+#define REASSEMBLED_HEADER_MAC_ID_SHIFT	16
+#define REASSEMBLED_FRAGMENTS_SHIFT		32
+#define REASSEMBLED_ACKS_SHIFT			48
+#define REASSEMBLED_COUNT_MASK			0xFFFF
+#define REASSEMBLED_LENGTH_MASK			0xFFFFFF
+#define REASSEMBLED_OFFSET_SHIFT		24
+#define REASSEMBLED_NO_PAYLOAD			0xFFFFFFFFFFull	// the arena was full
+#define EXPLICIT_MESSAGE ( 1 << 5 )		// ReassembledMessage only: an explicit message, not I/O
 
 enum IdentifierType
 {
@@ -182,6 +249,42 @@ enum IdentifierType
 	InvalidCanIdentifiers
 };
 
+// What an identifier's Message ID stands for, where DeviceNet gives it a meaning of its own
+enum DeviceNetMessageKind
+{
+	OrdinaryMessage,
+	ConnectionManagementMessage,		// Group 2 Message ID '110' ; "Reserved for Predefined Master/Slave Connection Management"
+	DuplicateMacIdCheckMessage,			// Group 2 Message ID '111' ; "Duplicate MAC ID Check Message"
+	UnconnectedExplicitResponse,		// Group 3 Message ID '101'
+	UnconnectedExplicitRequest,			// Group 3 Message ID '110'
+	ReservedGroup3Message,				// Group 3 Message ID '111'
+	ReservedGroup4Message,				// Group 4 Message ID '000000' .. '101011'
+	CommunicationFaultedResponse,		// Group 4 Message ID '101100'
+	CommunicationFaultedRequest,		// Group 4 Message ID '101101'
+	OfflineOwnershipResponse,			// Group 4 Message ID '101110'
+	OfflineOwnershipRequest				// Group 4 Message ID '101111'
+};
+
+// Identifier classification: one word per 11 bit identifier, worked out at compile time (DeviceNetProtocol.cpp)
+//   bits 0..5 MAC ID (the Source MAC ID in groups 1 and 3), 8..13 the group's Message ID, 16..18 IdentifierType,
+//   24..27 DeviceNetMessageKind.  Fields a group doesn't have are 0.
+#define NUM_IDENTIFIERS						0x00000800
+#define IDENTIFIER_CLASS_MAC_ID_SHIFT		0
+#define IDENTIFIER_CLASS_MAC_ID_MASK		0x3F
+#define IDENTIFIER_CLASS_MESSAGE_ID_SHIFT	8
+#define IDENTIFIER_CLASS_MESSAGE_ID_MASK	0x3F
+#define IDENTIFIER_CLASS_GROUP_SHIFT		16
+#define IDENTIFIER_CLASS_GROUP_MASK			0x7
+#define IDENTIFIER_CLASS_KIND_SHIFT			24
+#define IDENTIFIER_CLASS_KIND_MASK			0xF
+
+struct DeviceNetIdentifierTable
+{
+	U32 mClasses[NUM_IDENTIFIERS];
+};
+
+extern const DeviceNetIdentifierTable gDeviceNetIdentifierTable;
+
 class DeviceNetProtocol
 {
 public:
@@ -248,7 +351,19 @@ public:
 	void ComposeControlField(U32 mDataLengthCode);
 
 	// Analyzing dependend functions
-	void DecomposeArbitrationField(U32 mArbitrationField);
+	void DecomposeArbitrationField(U32 mArbitrationField);	// sets every member above, so one object does for every frame
+
+	// Identifier classification in one load: the identifier's 11 bits (anything above is ignored), and the parts of the word
+	static U32 ClassifyIdentifier(U32 identifier) { return gDeviceNetIdentifierTable.mClasses[identifier & (NUM_IDENTIFIERS - 1)]; }
+	static IdentifierType GetIdentifierGroup(U32 identifier_class) { return IdentifierType((identifier_class >> IDENTIFIER_CLASS_GROUP_SHIFT) & IDENTIFIER_CLASS_GROUP_MASK); }
+	static U32 GetIdentifierMessageID(U32 identifier_class) { return (identifier_class >> IDENTIFIER_CLASS_MESSAGE_ID_SHIFT) & IDENTIFIER_CLASS_MESSAGE_ID_MASK; }
+	static U32 GetIdentifierMacID(U32 identifier_class) { return (identifier_class >> IDENTIFIER_CLASS_MAC_ID_SHIFT) & IDENTIFIER_CLASS_MAC_ID_MASK; }
+	static DeviceNetMessageKind GetIdentifierMessageKind(U32 identifier_class) { return DeviceNetMessageKind((identifier_class >> IDENTIFIER_CLASS_KIND_SHIFT) & IDENTIFIER_CLASS_KIND_MASK); }
+
+	// What the Predefined Master/Slave Connection Set and UCMM carry on an identifier: explicit messages (message header first),
+	// or I/O messages that may come in fragments
+	static bool IsExplicitConnection(U32 identifier_class);
+	static bool IsIOConnection(U32 identifier_class);
 
 	void DecomposeControlField(U32 mControlField);
 
@@ -0,0 +1,398 @@
+#include "DeviceNetReassembler.h"
+#include <string.h>
+
+#define NO_TRANSFER	0xFFFF
+
+DeviceNetPayloadArena::DeviceNetPayloadArena()
+:	mBlockBytes( PAYLOAD_ARENA_BLOCK_BYTES )
+{
+	//never reallocated, so reading a block doesn't race with adding one.
+	mBlocks.reserve( PAYLOAD_ARENA_MAX_BLOCKS );
+}
+
+DeviceNetPayloadArena::~DeviceNetPayloadArena()
+{
+	for( U32 i = 0; i < mBlocks.size(); i++ )
+		delete[] mBlocks[ i ];
+}
+
+U64 DeviceNetPayloadArena::Add( const U8* data, U32 num_bytes )
+{
+	if( num_bytes == 0 )
+		return 0;
+
+	if( num_bytes > PAYLOAD_ARENA_BLOCK_BYTES )
+		return REASSEMBLED_NO_PAYLOAD;
+
+	//a message never straddles two blocks.
+	if( mBlockBytes + num_bytes > PAYLOAD_ARENA_BLOCK_BYTES )
+	{
+		if( mBlocks.size() == PAYLOAD_ARENA_MAX_BLOCKS )
+			return REASSEMBLED_NO_PAYLOAD;
+
+		mBlocks.push_back( new U8[ PAYLOAD_ARENA_BLOCK_BYTES ] );
+		mBlockBytes = 0;
+	}
+
+	U64 offset = U64( mBlocks.size() - 1 ) * PAYLOAD_ARENA_BLOCK_BYTES + mBlockBytes;
+	memcpy( mBlocks.back() + mBlockBytes, data, num_bytes );
+	mBlockBytes += num_bytes;
+	return offset;
+}
+
+const U8* DeviceNetPayloadArena::Get( U64 offset )
+{
+	return mBlocks[ U32( offset / PAYLOAD_ARENA_BLOCK_BYTES ) ] + ( offset % PAYLOAD_ARENA_BLOCK_BYTES );
+}
+
+U64 DeviceNetPayloadArena::GetNumBytes()
+{
+	if( mBlocks.empty() == true )
+		return 0;
+
+	return U64( mBlocks.size() - 1 ) * PAYLOAD_ARENA_BLOCK_BYTES + mBlockBytes;
+}
+
+DeviceNetReassembler::DeviceNetReassembler()
+:	mReassembly( Reassembly_None ),
+	mPayloads( NULL ),
+	mListener( NULL )
+{
+	mTransfers.resize( REASSEMBLY_MAX_TRANSFERS );
+}
+
+DeviceNetReassembler::~DeviceNetReassembler()
+{
+}
+
+void DeviceNetReassembler::Start( enum Reassembly reassembly, U32 sample_rate_hz, U32 bit_rate, DeviceNetPayloadArena* payloads, DeviceNetDecoderListener* listener )
+{
+	mReassembly = reassembly;
+	mPayloads = payloads;
+	mListener = listener;
+
+	mEndOfFrameSamples = 1;
+	if( bit_rate != 0 )
+		mEndOfFrameSamples = U64( double( sample_rate_hz ) / double( bit_rate ) * double( LENGTH_END_OF_FRAME ) );
+	if( mEndOfFrameSamples == 0 )
+		mEndOfFrameSamples = 1;
+
+	mHasMessage = false;
+	mNumDataBytes = 0;
+	mLastFrameEndingSample = 0;
+	mClipping = false;
+	mNumMessages = 0;
+
+	mFreeTransfers.clear();
+	for( U32 i = REASSEMBLY_MAX_TRANSFERS; i > 0; i-- )
+		mFreeTransfers.push_back( i - 1 );
+
+	mTransferOfKey.assign( NUM_IDENTIFIERS << 6, NO_TRANSFER );
+	mTransferOfEnds.assign( 64 << 6, NO_TRANSFER );
+}
+
+void DeviceNetReassembler::OnRecord( const DeviceNetRecord& record )
+{
+	switch( record.mType )
+	{
+	case IdentifierField:
+	case IdentifierFieldEx:
+		mHasMessage = false;
+		mStandardCan = ( record.mType == IdentifierField );
+		mRemoteFrame = ( ( record.mFlags & REMOTE_FRAME ) != 0 );
+		mCrcError = false;
+		mIdentifier = U32( record.mData1 );
+		mNumDataBytes = 0;
+		break;
+	case DataField:
+		if( mNumDataBytes < 8 )
+			mData[ mNumDataBytes++ ] = U8( record.mData1 );
+		break;
+	case CrcField:
+		mCrcError = ( ( record.mFlags & CRC_ERROR ) != 0 );
+		break;
+	case AckField:
+		mAck = ( record.mData1 != 0 );
+		mMessageEndingSample = record.mEndingSampleInclusive;
+		mHasMessage = true;
+		break;
+	case CanMessage:
+	{
+		U8 flags = U8( record.mData1 >> COMPACT_FLAGS_SHIFT );
+		mStandardCan = ( ( flags & EXTENDED_IDENTIFIER ) == 0 );
+		mRemoteFrame = ( ( flags & REMOTE_FRAME ) != 0 );
+		mCrcError = ( ( flags & CRC_ERROR ) != 0 );
+		mAck = ( ( flags & ACK_RECEIVED ) != 0 );
+		mIdentifier = U32( record.mData1 & COMPACT_IDENTIFIER_MASK );
+
+		mNumDataBytes = U32( record.mData1 >> COMPACT_DLC_SHIFT ) & COMPACT_DLC_MASK;
+		if( mNumDataBytes > 8 )
+			mNumDataBytes = 8;
+		if( mRemoteFrame == true )
+			mNumDataBytes = 0;
+		for( U32 i = 0; i < mNumDataBytes; i++ )
+			mData[ i ] = U8( record.mData2 >> ( 56 - 8 * i ) );
+
+		mMessageEndingSample = record.mEndingSampleInclusive;
+		mHasMessage = true;
+	}
+	break;
+	case DeviceNetError:
+		mHasMessage = false;
+		break;
+	}
+
+	//an error flag in END OF FRAME starts where our frame is: the decoder moves it clear of its own fields, we do
+	//the same for ours.
+	if( ( mClipping == true ) && ( record.mStartingSampleInclusive <= mLastFrameEndingSample ) )
+	{
+		DeviceNetRecord clipped = record;
+		clipped.mStartingSampleInclusive = mLastFrameEndingSample + 1;
+		mListener->OnRecord( clipped );
+		return;
+	}
+
+	mListener->OnRecord( record );
+}
+
+void DeviceNetReassembler::OnMarker( U64 sample, DeviceNetMarkerType type )
+{
+	mListener->OnMarker( sample, type );
+}
+
+void DeviceNetReassembler::OnEventEnd( const DeviceNetEventInfo& info )
+{
+	mClipping = false;
+	mListener->OnEventEnd( info );
+
+	if( mHasMessage == true )
+		AddMessage();
+
+	mHasMessage = false;
+}
+
+void DeviceNetReassembler::AddMessage()
+{
+	if( mReassembly == Reassembly_None )
+		return;
+
+	//a frame nobody acknowledged wasn't received: it goes out again.
+	if( ( mStandardCan == false ) || ( mRemoteFrame == true ) || ( mCrcError == true ) || ( mAck == false ) )
+		return;
+
+	mNumMessages++;
+
+	U32 identifier_class = DeviceNetProtocol::ClassifyIdentifier( mIdentifier );
+	if( DeviceNetProtocol::IsExplicitConnection( identifier_class ) == true )
+		AddExplicitFragment( identifier_class );
+	else if( ( mReassembly == Reassembly_ExplicitAndIO ) && ( DeviceNetProtocol::IsIOConnection( identifier_class ) == true ) )
+		AddIOFragment();
+}
+
+void DeviceNetReassembler::AddExplicitFragment( U32 identifier_class )
+{
+	if( mNumDataBytes < 2 )
+		return;
+
+	if( ( mData[ 0 ] & EXPLICIT_HEADER_FRAG ) == 0 )
+		return;
+
+	U32 header_mac_id = mData[ 0 ] & EXPLICIT_HEADER_MAC_ID_MASK;
+	U32 type = mData[ 1 ] >> FRAGMENT_TYPE_SHIFT;
+	U32 count = mData[ 1 ] & FRAGMENT_COUNT_MASK;
+
+	//the identifier's MAC ID is the source, but for the master's requests in Group 2, which go to it.
+	U32 mac_id = DeviceNetProtocol::GetIdentifierMacID( identifier_class );
+	U32 message_id = DeviceNetProtocol::GetIdentifierMessageID( identifier_class );
+	bool to_mac_id = ( DeviceNetProtocol::GetIdentifierGroup( identifier_class ) == MessageGroup2 ) && ( message_id != 3 );
+	U32 producer = ( to_mac_id == true ) ? header_mac_id : mac_id;
+	U32 consumer = ( to_mac_id == true ) ? mac_id : header_mac_id;
+
+	if( type == FRAGMENT_TYPE_ACK )
+	{
+		//for the fragment that went the other way last; a status other than 0 ("too much data") ends the message.
+		U32 transfer = mTransferOfEnds[ ( consumer << 6 ) | producer ];
+		if( transfer == NO_TRANSFER )
+			return;
+
+		Transfer& acked = mTransfers[ transfer ];
+		if( count != ( ( acked.mNextCount - 1 ) & FRAGMENT_COUNT_MASK ) )
+			return;
+
+		U32 status = ( mNumDataBytes > 2 ) ? mData[ 2 ] : 0;
+		if( status != 0 )
+		{
+			FreeTransfer( transfer );
+			return;
+		}
+
+		if( acked.mLastAckCount != count )
+		{
+			acked.mLastAckCount = count;
+			acked.mNumAcks++;
+		}
+		return;
+	}
+
+	AddFragment( ( mIdentifier << 6 ) | header_mac_id, true, producer, consumer, type, count, mData + 2, mNumDataBytes - 2 );
+}
+
+void DeviceNetReassembler::AddIOFragment()
+{
+	if( mNumDataBytes < 1 )
+		return;
+
+	U32 key = mIdentifier << 6;
+	U32 type = mData[ 0 ] >> FRAGMENT_TYPE_SHIFT;
+	U32 count = mData[ 0 ] & FRAGMENT_COUNT_MASK;
+
+	//all but the last fragment fill the frame, and nothing acknowledges them: anything else means the connection
+	//isn't fragmented after all.
+	if( ( type == FRAGMENT_TYPE_ACK ) || ( ( type != FRAGMENT_TYPE_LAST ) && ( mNumDataBytes != 8 ) ) )
+	{
+		if( mTransferOfKey[ key ] != NO_TRANSFER )
+			FreeTransfer( mTransferOfKey[ key ] );
+		return;
+	}
+
+	AddFragment( key, false, 0, 0, type, count, mData + 1, mNumDataBytes - 1 );
+}
+
+void DeviceNetReassembler::AddFragment( U32 key, bool explicit_message, U32 producer, U32 consumer, U32 type, U32 count, const U8* data, U32 num_bytes )
+{
+	U32 transfer = mTransferOfKey[ key ];
+
+	//the count starts at 0 with the first fragment.
+	if( ( type == FRAGMENT_TYPE_FIRST ) && ( count != 0 ) )
+	{
+		if( transfer != NO_TRANSFER )
+			FreeTransfer( transfer );
+		return;
+	}
+
+	if( type == FRAGMENT_TYPE_FIRST )
+	{
+		//starts over, whatever there was
+		if( transfer == NO_TRANSFER )
+			transfer = GetTransfer( key );
+		else if( ( mTransfers[ transfer ].mExplicit == true ) && ( mTransferOfEnds[ ( mTransfers[ transfer ].mProducer << 6 ) | mTransfers[ transfer ].mConsumer ] == transfer ) )
+			mTransferOfEnds[ ( mTransfers[ transfer ].mProducer << 6 ) | mTransfers[ transfer ].mConsumer ] = NO_TRANSFER;
+
+		Transfer& first = mTransfers[ transfer ];
+		first.mExplicit = explicit_message;
+		first.mProducer = producer;
+		first.mConsumer = consumer;
+		first.mNextCount = ( count + 1 ) & FRAGMENT_COUNT_MASK;
+		first.mLastType = type;
+		first.mLastAckCount = FRAGMENT_COUNT_MASK + 1;
+		first.mNumFragments = 1;
+		first.mNumAcks = 0;
+		first.mLastUse = mNumMessages;
+		first.mPayload.assign( data, data + num_bytes );
+
+		if( explicit_message == true )
+			mTransferOfEnds[ ( producer << 6 ) | consumer ] = transfer;
+		return;
+	}
+
+	//a middle or last fragment of nothing we know of: we came in halfway, or it's no fragment at all.
+	if( transfer == NO_TRANSFER )
+		return;
+
+	Transfer& next = mTransfers[ transfer ];
+
+	//the one we had already: it went out again (explicit, because the acknowledgement didn't come in time).
+	if( ( type == next.mLastType ) && ( count == ( ( next.mNextCount - 1 ) & FRAGMENT_COUNT_MASK ) ) )
+		return;
+
+	//one went missing, or the message got too long: it's lost.
+	if( ( count != next.mNextCount ) || ( next.mPayload.size() + num_bytes > REASSEMBLY_MAX_BYTES ) )
+	{
+		FreeTransfer( transfer );
+		return;
+	}
+
+	next.mPayload.insert( next.mPayload.end(), data, data + num_bytes );
+	next.mNextCount = ( count + 1 ) & FRAGMENT_COUNT_MASK;
+	next.mLastType = type;
+	next.mNumFragments++;
+	next.mLastUse = mNumMessages;
+
+	if( type == FRAGMENT_TYPE_LAST )
+	{
+		AddReassembledMessage( transfer );
+		FreeTransfer( transfer );
+	}
+}
+
+U32 DeviceNetReassembler::GetTransfer( U32 key )
+{
+	if( mFreeTransfers.empty() == true )
+	{
+		//they're all taken: the one that has waited longest for its next fragment probably never gets it.
+		U32 oldest = 0;
+		for( U32 i = 1; i < mTransfers.size(); i++ )
+		{
+			if( mTransfers[ i ].mLastUse < mTransfers[ oldest ].mLastUse )
+				oldest = i;
+		}
+
+		FreeTransfer( oldest );
+	}
+
+	U32 transfer = mFreeTransfers.back();
+	mFreeTransfers.pop_back();
+
+	mTransfers[ transfer ].mKey = key;
+	mTransferOfKey[ key ] = transfer;
+	return transfer;
+}
+
+void DeviceNetReassembler::FreeTransfer( U32 transfer )
+{
+	Transfer& done = mTransfers[ transfer ];
+	mTransferOfKey[ done.mKey ] = NO_TRANSFER;
+
+	U32 ends = ( done.mProducer << 6 ) | done.mConsumer;
+	if( ( done.mExplicit == true ) && ( mTransferOfEnds[ ends ] == transfer ) )
+		mTransferOfEnds[ ends ] = NO_TRANSFER;
+
+	mFreeTransfers.push_back( transfer );
+}
+
+void DeviceNetReassembler::AddReassembledMessage( U32 transfer )
+{
+	Transfer& done = mTransfers[ transfer ];
+
+	U32 num_bytes = U32( done.mPayload.size() );
+	U64 offset = REASSEMBLED_NO_PAYLOAD;
+	if( mPayloads != NULL )
+		offset = mPayloads->Add( done.mPayload.data(), num_bytes );
+
+	U64 num_fragments = ( done.mNumFragments > REASSEMBLED_COUNT_MASK ) ? REASSEMBLED_COUNT_MASK : done.mNumFragments;
+	U64 num_acks = ( done.mNumAcks > REASSEMBLED_COUNT_MASK ) ? REASSEMBLED_COUNT_MASK : done.mNumAcks;
+
+	DeviceNetRecord frame;
+	frame.mStartingSampleInclusive = mMessageEndingSample + 1;
+	frame.mEndingSampleInclusive = mMessageEndingSample + mEndOfFrameSamples;
+	frame.mType = ReassembledMessage;
+	frame.mFlags = ( done.mExplicit == true ) ? EXPLICIT_MESSAGE : 0;
+
+	//every explicit fragment but the last has to be acknowledged before the next one goes out.
+	if( ( ( done.mExplicit == true ) && ( done.mNumAcks + 1 < done.mNumFragments ) ) || ( offset == REASSEMBLED_NO_PAYLOAD ) )
+		frame.mFlags |= DISPLAY_AS_WARNING_FLAG;
+
+	frame.mData1 = U64( done.mKey >> 6 ) | ( U64( done.mKey & EXPLICIT_HEADER_MAC_ID_MASK ) << REASSEMBLED_HEADER_MAC_ID_SHIFT );
+	frame.mData1 |= ( num_fragments << REASSEMBLED_FRAGMENTS_SHIFT ) | ( num_acks << REASSEMBLED_ACKS_SHIFT );
+	frame.mData2 = U64( num_bytes ) | ( offset << REASSEMBLED_OFFSET_SHIFT );
+	mListener->OnRecord( frame );
+
+	//a packet of its own
+	DeviceNetEventInfo info;
+	info.mStartOfFrame = END_OF_EDGES;
+	info.mFlagStart = END_OF_EDGES;
+	mListener->OnEventEnd( info );
+
+	mLastFrameEndingSample = frame.mEndingSampleInclusive;
+	mClipping = true;
+}
@@ -0,0 +1,136 @@
+#ifndef DEVICENET_REASSEMBLER
+#define DEVICENET_REASSEMBLER
+
+#include <LogicPublicTypes.h>
+#include <vector>
+#include "DeviceNetDecoder.h"
+
+/*	The DeviceNet fragmentation protocol, put back together
+
+	A message longer than 8 bytes goes out in fragments.  Explicit messages have the fragmentation byte after the
+	message header (Frag bit set, MAC ID of the other end), and every fragment is acknowledged by the receiver on
+	the connection going the other way; I/O messages of a fragmented connection start with it right away, and
+	aren't acknowledged.  The byte is the fragment type (first, middle, last, ack) in bits 7:6 and a count in 5:0
+	that goes up by one per fragment.
+
+	The reassembler sits between the decode cache and the results, passing everything through.  It follows the
+	fragments of each (connection, MAC ID) -- the identifier, and for explicit messages the header's MAC ID -- and
+	once the last one is in, adds a ReassembledMessage frame of its own over the last fragment's END OF FRAME, with
+	the whole message in a DeviceNetPayloadArena.  A fragmented I/O connection can only be told from its
+	fragments: we take an 8-byte I/O message starting with a first fragment (count 0) for one, and only report
+	it if the counts run through to a last fragment without a gap.
+*/
+
+enum Reassembly
+{
+	Reassembly_None,
+	Reassembly_Explicit,
+	Reassembly_ExplicitAndIO
+};
+
+// Fragmentation protocol byte
+#define FRAGMENT_TYPE_SHIFT			6
+#define FRAGMENT_COUNT_MASK			0x3F
+#define FRAGMENT_TYPE_FIRST			0
+#define FRAGMENT_TYPE_MIDDLE		1
+#define FRAGMENT_TYPE_LAST			2
+#define FRAGMENT_TYPE_ACK			3
+#define EXPLICIT_HEADER_FRAG		( 1 << 7 )
+#define EXPLICIT_HEADER_XID			( 1 << 6 )
+#define EXPLICIT_HEADER_MAC_ID_MASK	0x3F
+
+// A connection has one message in the making at most; this many connections can have one at the same time (the
+// one left alone longest makes way for a new one), and a message can't get longer than this.
+#define REASSEMBLY_MAX_TRANSFERS	128
+#define REASSEMBLY_MAX_BYTES		( 1 << 16 )
+
+// The reassembled messages, one after the other in blocks that stay where they are: the results read what's
+// committed while the worker thread adds more.
+#define PAYLOAD_ARENA_BLOCK_BYTES	( 1 << 20 )
+#define PAYLOAD_ARENA_MAX_BLOCKS	4096
+
+class DeviceNetPayloadArena
+{
+public:
+	DeviceNetPayloadArena();
+	~DeviceNetPayloadArena();
+
+	//where the copy of data starts, to hand to Get; REASSEMBLED_NO_PAYLOAD once the arena is full.
+	U64 Add( const U8* data, U32 num_bytes );
+	const U8* Get( U64 offset );
+
+	U64 GetNumBytes();
+
+protected:
+	std::vector<U8*> mBlocks;
+	U32 mBlockBytes;	//used in the last block
+};
+
+class DeviceNetReassembler : public DeviceNetDecoderListener
+{
+public:
+	DeviceNetReassembler();
+	virtual ~DeviceNetReassembler();
+
+	//starts over: the messages go into payloads, and everything (ours and what we pass on) to listener.  The bit
+	//rate is what the frames went at, for the END OF FRAME our frames cover.
+	void Start( enum Reassembly reassembly, U32 sample_rate_hz, U32 bit_rate, DeviceNetPayloadArena* payloads, DeviceNetDecoderListener* listener );
+
+	virtual void OnRecord( const DeviceNetRecord& record );
+	virtual void OnMarker( U64 sample, DeviceNetMarkerType type );
+	virtual void OnEventEnd( const DeviceNetEventInfo& info );
+
+protected: //functions
+	void AddMessage();
+	void AddExplicitFragment( U32 identifier_class );
+	void AddIOFragment();
+	void AddFragment( U32 key, bool explicit_message, U32 producer, U32 consumer, U32 type, U32 count, const U8* data, U32 num_bytes );
+	U32 GetTransfer( U32 key );
+	void FreeTransfer( U32 transfer );
+	void AddReassembledMessage( U32 transfer );
+
+protected: //vars
+	enum Reassembly mReassembly;
+	U64 mEndOfFrameSamples;
+	DeviceNetPayloadArena* mPayloads;
+	DeviceNetDecoderListener* mListener;
+
+	//the event going through: a data frame, if it makes it to the ACK delimiter
+	bool mHasMessage;
+	bool mStandardCan;
+	bool mRemoteFrame;
+	bool mCrcError;
+	bool mAck;
+	U32 mIdentifier;
+	U32 mNumDataBytes;
+	U8 mData[ 8 ];
+	U64 mMessageEndingSample;
+
+	U64 mLastFrameEndingSample;	//of our last frame: an error flag in END OF FRAME starts after it,
+	bool mClipping;				//if it comes right after that frame
+
+	//a message in the making
+	class Transfer
+	{
+	public:
+		U32 mKey;
+		bool mExplicit;
+		U32 mProducer;		//explicit: the MAC IDs of the ends, for the acknowledgements
+		U32 mConsumer;
+		U32 mNextCount;
+		U32 mLastType;
+		U32 mLastAckCount;
+		U32 mNumFragments;
+		U32 mNumAcks;
+		U64 mLastUse;
+		std::vector<U8> mPayload;	//keeps its capacity from message to message
+	};
+
+	std::vector<Transfer> mTransfers;
+	std::vector<U32> mFreeTransfers;
+	std::vector<U16> mTransferOfKey;		//NUM_IDENTIFIERS * 64 keys: identifier << 6 | header MAC ID
+	std::vector<U16> mTransferOfEnds;		//64 * 64: producer << 6 | consumer, explicit transfers only
+	U64 mNumMessages;	//the clock for mLastUse
+};
+
+#endif //DEVICENET_REASSEMBLER
@@ -4,8 +4,25 @@
 #include <AnalyzerHelpers.h>
 
 #include "DeviceNetProtocol.h"
+#include "DeviceNetCrc.h"
+#include "DeviceNetBitBuffer.h"
+#include "DeviceNetReassembler.h"
+#include "DeviceNetCip.h"
+#include "DeviceNetConnectionTracker.h"
+
+//the ends of the simulated explicit messages
+#define SIMULATION_MASTER_MAC_ID	0x00
+#define SIMULATION_SLAVE_MAC_ID		0x2F
 
 DeviceNetSimulationDataGenerator::DeviceNetSimulationDataGenerator()
+:	mBusLoadPercent( 0 ),
+	mMinDataBytes( 8 ),
+	mMaxDataBytes( 8 ),
+	mRandomState( 1 ),
+	mExplicitEvery( 16 ),
+	mExplicitBytes( 24 ),
+	mNumFrames( 0 ),
+	mAllocated( false )
 {
 }
 
@@ -18,15 +35,39 @@ void DeviceNetSimulationDataGenerator::Initialize( U32 simulation_sample_rate, D
 	mSimulationSampleRateHz = simulation_sample_rate;
 	mSettings = settings;
 
-	mClockGenerator.Init(mSettings->mBitRate, simulation_sample_rate);
+	//with automatic detection, simulate the fastest rate.
+	mBitRate = (mSettings->mBitRate == BitRate_Auto) ? U32(BitRate_500K) : U32(mSettings->mBitRate);
+
+	mClockGenerator.Init(mBitRate, simulation_sample_rate);
 
 	mDeviceNetSimulationData.SetChannel( mSettings->mDeviceNetChannel );
 	mDeviceNetSimulationData.SetSampleRate( simulation_sample_rate );
-	mDeviceNetSimulationData.SetInitialBitState( BIT_HIGH );
+	mDeviceNetSimulationData.SetInitialBitState( mSettings->Recessive() );
 
 	mDeviceNetSimulationData.Advance(mClockGenerator.AdvanceByHalfPeriod(10.0));  //insert 10 bit-periods of idle
 
 	mValue = 0;
+	mAllocated = false;
+}
+
+void DeviceNetSimulationDataGenerator::SetTraffic( U32 bus_load_percent, U32 min_data_bytes, U32 max_data_bytes, U32 seed )
+{
+	mBusLoadPercent = (bus_load_percent > 100) ? 100 : bus_load_percent;
+	mMaxDataBytes = (max_data_bytes > 8) ? 8 : max_data_bytes;
+	mMinDataBytes = (min_data_bytes > mMaxDataBytes) ? mMaxDataBytes : min_data_bytes;
+	mRandomState = seed;
+}
+
+void DeviceNetSimulationDataGenerator::SetExplicitTraffic( U32 every_num_frames, U32 num_bytes )
+{
+	mExplicitEvery = every_num_frames;
+	mExplicitBytes = (num_bytes < 3) ? 3 : num_bytes;	//so it doesn't fit in one frame
+}
+
+U32 DeviceNetSimulationDataGenerator::GetRandomNumber()
+{
+	mRandomState = mRandomState * 1103515245 + 12345;
+	return mRandomState >> 16;
 }
 
 U32 DeviceNetSimulationDataGenerator::GenerateSimulationData( U64 largest_sample_requested, U32 sample_rate, SimulationChannelDescriptor** simulation_channel )
@@ -36,18 +77,21 @@ U32 DeviceNetSimulationDataGenerator::GenerateSimulationData( U64 largest_sample
 	std::vector<U8> data;
 	std::vector<U8> empty_data;
 
+	if ((mExplicitEvery != 0) && (mAllocated == false))
+	{
+		WriteAllocateRequest();
+		mAllocated = true;
+	}
+
 	while( mDeviceNetSimulationData.GetCurrentSampleNumber() < adjusted_largest_sample_requested )
 	{
-		data.clear();
-		data.push_back(mValue + 0);
-		data.push_back(mValue + 1);
-		data.push_back(mValue + 2);
-		data.push_back(mValue + 3);
+		U32 num_bytes = mMinDataBytes;
+		if (mMaxDataBytes > mMinDataBytes)
+			num_bytes += GetRandomNumber() % (mMaxDataBytes - mMinDataBytes + 1);
 
-		data.push_back(mValue + 4);
-		data.push_back(mValue + 5);
-		data.push_back(mValue + 6);
-		data.push_back(mValue + 7);
+		data.clear();
+		for (U32 i = 0; i < num_bytes; i++)
+			data.push_back(mValue + i);
 
 		mValue++;
 
@@ -55,15 +99,121 @@ U32 DeviceNetSimulationDataGenerator::GenerateSimulationData( U64 largest_sample
 		WriteFrame();
 		CreateDataFrame(MessageGroup1, 0xC, 0x2F, data, false);
 		WriteFrame();
+
+		mNumFrames += 2;
+		if ((mExplicitEvery != 0) && (mNumFrames >= mExplicitEvery))
+		{
+			mNumFrames = 0;
+			WriteExplicitRequest();
+		}
 	}
 
 	*simulation_channel = &mDeviceNetSimulationData;
 	return 1;
 }
 
+void DeviceNetSimulationDataGenerator::WriteAllocateRequest()
+{
+	//the master allocates the slave's explicit and multicast poll connections, on the Group 2 only unconnected port:
+	//the DeviceNet object (class 3, instance 1), the allocation choice and the master's MAC ID.
+	std::vector<U8> data;
+	data.push_back(SIMULATION_MASTER_MAC_ID);
+	data.push_back(CIP_SERVICE_OPEN_CONNECTION);
+	data.push_back(CIP_CLASS_DEVICENET);
+	data.push_back(0x01);
+	data.push_back(ALLOCATE_EXPLICIT | ALLOCATE_MULTICAST_POLLED);
+	data.push_back(SIMULATION_MASTER_MAC_ID);
+
+	CreateDataFrame(MessageGroup2, CHECK_GROUP_2_MSG_ID_IS_CONNECTION_MANAGEMENT, SIMULATION_SLAVE_MAC_ID, data, true);
+	WriteFrame();
+
+	//the slave's response, on its explicit connection: the message body format, 8/8
+	data.clear();
+	data.push_back(SIMULATION_MASTER_MAC_ID);
+	data.push_back(CIP_SERVICE_OPEN_CONNECTION | CIP_SERVICE_RESPONSE);
+	data.push_back(0x00);
+
+	CreateDataFrame(MessageGroup2, 3, SIMULATION_SLAVE_MAC_ID, data, true);
+	WriteFrame();
+}
+
+void DeviceNetSimulationDataGenerator::WriteExplicitRequest()
+{
+	//Set_Attribute_Single of a vendor specific attribute, in the 8/8 message body format: service, class, instance
+	//and attribute, then the value.  Too long for one frame, so it goes in fragments of 6 bytes.
+	std::vector<U8> body;
+	body.push_back(CIP_SERVICE_SET_ATTRIBUTE_SINGLE);
+	body.push_back(0x64);
+	body.push_back(0x01);
+	body.push_back(0x01);
+	for (U32 i = 0; i < mExplicitBytes; i++)
+		body.push_back(mValue + i);
+
+	std::vector<U8> data;
+	U32 count = 0;
+	for (U32 offset = 0; offset < body.size(); offset += 6)
+	{
+		U32 type = FRAGMENT_TYPE_MIDDLE;
+		if (offset == 0)
+			type = FRAGMENT_TYPE_FIRST;
+		else if (offset + 6 >= body.size())
+			type = FRAGMENT_TYPE_LAST;
+
+		//the master's explicit request, to the slave
+		data.clear();
+		data.push_back(EXPLICIT_HEADER_FRAG | SIMULATION_MASTER_MAC_ID);
+		data.push_back((type << FRAGMENT_TYPE_SHIFT) | (count & FRAGMENT_COUNT_MASK));
+		for (U32 i = offset; (i < offset + 6) && (i < body.size()); i++)
+			data.push_back(body[i]);
+
+		CreateDataFrame(MessageGroup2, 4, SIMULATION_SLAVE_MAC_ID, data, true);
+		WriteFrame();
+
+		//the slave's acknowledgement, status 0: success
+		data.clear();
+		data.push_back(EXPLICIT_HEADER_FRAG | SIMULATION_MASTER_MAC_ID);
+		data.push_back((FRAGMENT_TYPE_ACK << FRAGMENT_TYPE_SHIFT) | (count & FRAGMENT_COUNT_MASK));
+		data.push_back(0x00);
+
+		CreateDataFrame(MessageGroup2, 3, SIMULATION_SLAVE_MAC_ID, data, true);
+		WriteFrame();
+
+		count++;
+	}
+
+	//and the slave's (success) response: the service code with the response bit
+	data.clear();
+	data.push_back(SIMULATION_MASTER_MAC_ID);
+	data.push_back(CIP_SERVICE_SET_ATTRIBUTE_SINGLE | CIP_SERVICE_RESPONSE);
+
+	CreateDataFrame(MessageGroup2, 3, SIMULATION_SLAVE_MAC_ID, data, true);
+	WriteFrame();
+
+	//then a Get_Attribute_Single that fits in one frame, of an attribute the slave doesn't have
+	data.clear();
+	data.push_back(SIMULATION_MASTER_MAC_ID);
+	data.push_back(CIP_SERVICE_GET_ATTRIBUTE_SINGLE);
+	data.push_back(0x64);
+	data.push_back(0x01);
+	data.push_back(0x02);
+
+	CreateDataFrame(MessageGroup2, 4, SIMULATION_SLAVE_MAC_ID, data, true);
+	WriteFrame();
+
+	//the Error Response: general status "Attribute not supported", no additional code
+	data.clear();
+	data.push_back(SIMULATION_MASTER_MAC_ID);
+	data.push_back(CIP_SERVICE_ERROR_RESPONSE | CIP_SERVICE_RESPONSE);
+	data.push_back(0x14);
+	data.push_back(CIP_NO_ADDITIONAL_CODE);
+
+	CreateDataFrame(MessageGroup2, 3, SIMULATION_SLAVE_MAC_ID, data, true);
+	WriteFrame();
+}
+
 void DeviceNetSimulationDataGenerator::CreateDataFrame(enum IdentifierType idType, U8 GroupMessageID, U8 MacID, std::vector<U8>& data, bool get_ack_in_response)
 {
-	U32 samples_per_bit = mSimulationSampleRateHz / mSettings->mBitRate;
+	U32 samples_per_bit = mSimulationSampleRateHz / mBitRate;
 
 	/*!
 	 * Data Frame
@@ -128,7 +278,7 @@ void DeviceNetSimulationDataGenerator::CreateDataFrame(enum IdentifierType idTyp
 	 * therefore we can forget this for now.
 	 */
 
-	U32 mask = 1 << (LENGTH_ARBITRATION_FIELD - 1);
+	U32 mask = 1 << (LENGTH_IDENTIFIER - 1);
 	U32 identifier;
 
 	if (idType == MessageGroup1)
@@ -165,7 +315,7 @@ void DeviceNetSimulationDataGenerator::CreateDataFrame(enum IdentifierType idTyp
 		identifier = 0xFFFFFFFF;
 	}
 
-	for (U32 i = 0; i < LENGTH_ARBITRATION_FIELD; i++)
+	for (U32 i = 0; i < LENGTH_IDENTIFIER; i++)
 	{
 		if ((mask & identifier) == 0)
 			mFakeArbitrationField.push_back(mSettings->Dominant());
@@ -214,7 +364,7 @@ void DeviceNetSimulationDataGenerator::CreateDataFrame(enum IdentifierType idTyp
 	 * 
 	 */
 	U32 data_size = data.size();
-	if (data_size > 9)
+	if (data_size > 8)
 		AnalyzerHelpers::Assert("DeviceNet can't sent more than 8 bytes");
 	
 	// @ TODO: Check if a empty dataframe is possible in DeviceNet
@@ -318,45 +468,19 @@ void DeviceNetSimulationDataGenerator::CreateDataFrame(enum IdentifierType idTyp
 	mFakeFixedFormBits.insert(mFakeFixedFormBits.end(), mFakeEndOfFrame.begin(), mFakeEndOfFrame.end());
 
 
-	DeviceNetProtocol mDeviceNet;
-
-	/*
-	U8 byte = mSerialText[ mStringIndex ];
-	mStringIndex++;
-	if( mStringIndex == mSerialText.size() )
-		mStringIndex = 0;
-	*/
-
-	
-
-	//we're currenty high
-	//let's move forward a little
-	mDeviceNetSimulationData.Advance( samples_per_bit * 10 );
-
-	mDeviceNetSimulationData.Transition();  //low-going edge for start bit
-	mDeviceNetSimulationData.Advance( samples_per_bit );  //add start bit time
-
-	//build the Arbitration Field
-
-	mDeviceNet.ComposeGroup1MessageIdentifier(0xC, 0x38);
-	mDeviceNet.ComposeArbitrationField();
-
-	mask = 0x1 << (LENGTH_ARBITRATION_FIELD - 1);
-	for( U32 i=0; i< LENGTH_ARBITRATION_FIELD; i++ )
+	//we're currently recessive
+	//let's move forward a little (bus idle between frames): 10 bits, or as much as it takes to get the bus load
+	//asked for.  Stuff bits aren't counted, and INTERMISSION's 3 bits are the least there can be.
+	U32 idle_bits = 10;
+	if (mBusLoadPercent != 0)
 	{
-		if( ( mDeviceNet.mArbitrationField & mask ) != 0 )
-			mDeviceNetSimulationData.TransitionIfNeeded( BIT_HIGH );
-		else
-			mDeviceNetSimulationData.TransitionIfNeeded( BIT_LOW );
-
-		mDeviceNetSimulationData.Advance( samples_per_bit );
-		mask = mask >> 1;
+		U32 frame_bits = mFakeStuffedBits.size() + mFakeFixedFormBits.size();
+		idle_bits = frame_bits * (100 - mBusLoadPercent) / mBusLoadPercent;
+		if (idle_bits < 3)
+			idle_bits = 3;
 	}
 
-	mDeviceNetSimulationData.TransitionIfNeeded( BIT_HIGH ); //we need to end high
-
-	//lets pad the end a bit for the stop bit:
-	//mDeviceNetSimulationData.Advance( samples_per_bit );
+	mDeviceNetSimulationData.Advance( samples_per_bit * idle_bits );
 }
 
 void DeviceNetSimulationDataGenerator::AddCrc()
@@ -368,8 +492,8 @@ void DeviceNetSimulationDataGenerator::AddCrc()
 
 	U32 bits_for_crc = mFakeStuffedBits.size();
 	U16 crc = ComputeCrc(mFakeStuffedBits, bits_for_crc);
-	U32 mask = 0x4000;
-	for (U32 i = 0; i < 15; i++)
+	U32 mask = 1 << (LENGTH_CRC_SEQUENCE - 1);
+	for (U32 i = 0; i < LENGTH_CRC_SEQUENCE; i++)
 	{
 		if ((mask & crc) == 0)
 			mFakeCrcFieldWithoutDelimiter.push_back(mSettings->Dominant());
@@ -422,24 +546,12 @@ U16 DeviceNetSimulationDataGenerator::ComputeCrc(std::vector<BitState>& bits, U3
 	//After the transmission / reception of the last bit of the DATA FIELD, CRC_RG contains
 	//the CRC sequence.
 
-	U16 crc_result = 0;
+	//DeviceNetCrc does this a byte at a time; the analyzer checks received frames with the same code.
+	DeviceNetBitBuffer packed_bits;
 	for (U32 i = 0; i < num_bits; i++)
-	{
-		BitState next_bit = bits[i];
-
-		//Exclusive or
-		if ((crc_result & 0x4000) != 0)
-		{
-			next_bit = Invert(next_bit);  //if the msb of crc_result is zero, then next_bit is not inverted; otherwise, it is.
-		}
-
-		crc_result <<= 1;
+		packed_bits.Append(bits[i] == mSettings->Recessive(), 1);
 
-		if (next_bit == mSettings->Recessive()) //normally bit high.
-			crc_result ^= 0x4599;
-	}
-
-	return crc_result & 0x7FFF;
+	return DeviceNetCrc::Compute(packed_bits.GetWords(), num_bits);
 }
 
 void DeviceNetSimulationDataGenerator::WriteFrame(bool error)
@@ -501,6 +613,13 @@ void DeviceNetSimulationDataGenerator::WriteFrame(bool error)
 		mDeviceNetSimulationData.TransitionIfNeeded(bit);
 	}
 
+	if ((error == false) && ((recessive_count == 5) || (dominant_count == 5)))
+	{
+		//the CRC SEQUENCE is stuffed as well, so five identical bits at its end still get a stuff bit.
+		mDeviceNetSimulationData.Advance(mClockGenerator.AdvanceByHalfPeriod(1.0));
+		mDeviceNetSimulationData.Transition();
+	}
+
 	if (error == true)
 	{
 		if (mDeviceNetSimulationData.GetCurrentBitState() != mSettings->Dominant())
@@ -4,6 +4,8 @@
 #include <SimulationChannelDescriptor.h>
 #include <AnalyzerHelpers.h>
 
+#include "DeviceNetProtocol.h"
+
 class DeviceNetAnalyzerSettings;
 
 class DeviceNetSimulationDataGenerator
@@ -15,15 +17,36 @@ public:
 	void Initialize( U32 simulation_sample_rate, DeviceNetAnalyzerSettings* settings );
 	U32 GenerateSimulationData( U64 newest_sample_requested, U32 sample_rate, SimulationChannelDescriptor** simulation_channel );
 
+	//what GenerateSimulationData sends.  Logic gets the defaults: 8 data bytes and 10 idle bits after every frame.
+	//A bus load of 0 keeps the 10 bits; the number of data bytes is picked at random from the range.
+	void SetTraffic( U32 bus_load_percent, U32 min_data_bytes, U32 max_data_bytes, U32 seed );
+
+	//and after every so many of those frames, a fragmented explicit request from the master with num_bytes of
+	//attribute data, the slave's acknowledgements and its response.  Logic gets one every 16 frames, with 24
+	//bytes; 0 sends none.  Before any of it, the master allocates the slave's connections.
+	void SetExplicitTraffic( U32 every_num_frames, U32 num_bytes );
+
 protected:
 	DeviceNetAnalyzerSettings* mSettings;
 	U32 mSimulationSampleRateHz;
+	U32 mBitRate;
+	U32 mBusLoadPercent;
+	U32 mMinDataBytes;
+	U32 mMaxDataBytes;
+	U32 mRandomState;
+	U32 mExplicitEvery;
+	U32 mExplicitBytes;
+	U32 mNumFrames;
+	bool mAllocated;
 
 protected: // fuctions
 	void CreateDataFrame(enum IdentifierType idType, U8 GroupMessageID, U8 MacID, std::vector<U8>& data, bool get_ack_in_response);
 	void AddCrc();
 	U16 ComputeCrc(std::vector<BitState>& bits, U32 num_bits);
 	void WriteFrame(bool error = false);
+	void WriteAllocateRequest();
+	void WriteExplicitRequest();
+	U32 GetRandomNumber();
 
 protected: //vars
 	ClockGenerator mClockGenerator;
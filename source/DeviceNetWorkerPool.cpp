@@ -0,0 +1,71 @@
+#include "DeviceNetWorkerPool.h"
+
+DeviceNetWorkerPool::DeviceNetWorkerPool()
+:	mJob( NULL ),
+	mNumJobThreads( 0 ),
+	mNumRunning( 0 ),
+	mGeneration( 0 ),
+	mStopping( false )
+{
+}
+
+DeviceNetWorkerPool::~DeviceNetWorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		mStopping = true;
+	}
+	mJobReady.notify_all();
+
+	for( U32 i = 0; i < mThreads.size(); i++ )
+		mThreads[ i ].join();
+}
+
+void DeviceNetWorkerPool::Run( DeviceNetWorkerJob* job, U32 num_threads )
+{
+	if( num_threads > 1 )
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+
+		//new workers start out having seen the job before this one.
+		while( mThreads.size() + 1 < num_threads )
+			mThreads.push_back( std::thread( &DeviceNetWorkerPool::WorkerThread, this, U32( mThreads.size() + 1 ), mGeneration ) );
+
+		mJob = job;
+		mNumJobThreads = num_threads;
+		mNumRunning = num_threads - 1;
+		mGeneration++;
+	}
+	mJobReady.notify_all();
+
+	job->RunJob( 0 );
+
+	std::unique_lock<std::mutex> lock( mMutex );
+	while( mNumRunning != 0 )
+		mJobDone.wait( lock );
+}
+
+void DeviceNetWorkerPool::WorkerThread( U32 worker, U64 generation )
+{
+	std::unique_lock<std::mutex> lock( mMutex );
+
+	for( ; ; )
+	{
+		while( ( mGeneration == generation ) && ( mStopping == false ) )
+			mJobReady.wait( lock );
+		if( mStopping == true )
+			return;
+
+		generation = mGeneration;
+		if( worker >= mNumJobThreads )
+			continue;
+
+		DeviceNetWorkerJob* job = mJob;
+		lock.unlock();
+		job->RunJob( worker );
+		lock.lock();
+
+		if( --mNumRunning == 0 )
+			mJobDone.notify_one();
+	}
+}
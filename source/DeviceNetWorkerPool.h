@@ -0,0 +1,51 @@
+#ifndef DEVICENET_WORKER_POOL
+#define DEVICENET_WORKER_POOL
+
+#include <LogicPublicTypes.h>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/*	Worker threads that stay up between jobs
+
+	The parallel decoder hands out a window of edges at a time and the export a round of packets at a time: far
+	too often to start a thread for each.  The pool's workers are started the first time a job needs them, and
+	sleep on a condition variable between jobs until the pool is destroyed.
+
+	Run hands a job to num_threads threads at once: worker 0 is the calling thread, 1 and up are the pool's.  It
+	returns once every one of them is done with it.
+*/
+
+class DeviceNetWorkerJob
+{
+public:
+	virtual ~DeviceNetWorkerJob() {}
+
+	virtual void RunJob( U32 worker ) = 0;
+};
+
+class DeviceNetWorkerPool
+{
+public:
+	DeviceNetWorkerPool();
+	~DeviceNetWorkerPool();
+
+	void Run( DeviceNetWorkerJob* job, U32 num_threads );
+
+protected:
+	void WorkerThread( U32 worker, U64 generation );
+
+	std::vector<std::thread> mThreads;	//worker i + 1
+	std::mutex mMutex;
+	std::condition_variable mJobReady;
+	std::condition_variable mJobDone;
+
+	DeviceNetWorkerJob* mJob;
+	U32 mNumJobThreads;
+	U32 mNumRunning;		//the pool's workers still on the job
+	U64 mGeneration;		//one up for every job, so a worker can tell a new one from the one it did
+	bool mStopping;
+};
+
+#endif //DEVICENET_WORKER_POOL
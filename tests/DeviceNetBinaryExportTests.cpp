@@ -0,0 +1,156 @@
+//The binary export read back: a known capture's header, the field descriptors in it, and the records at the offsets
+//those give -- the data bytes in the order they went out, and the frame an error frame cut short flagged as such.
+
+#include "DeviceNetTests.h"
+#include "DeviceNetAnalyzerResults.h"
+
+#include <cstdio>
+#include <cstring>
+
+struct BinaryField
+{
+	const char* mName;
+	U32 mOffset;
+	U32 mSize;
+	U32 mType;
+};
+
+static const BinaryField gBinaryFields[ BINARY_NUM_FIELDS ] =
+{
+	{ "sample", 0, 8, BINARY_FIELD_UNSIGNED },
+	{ "identifier", 8, 4, BINARY_FIELD_UNSIGNED },
+	{ "dlc", 12, 1, BINARY_FIELD_UNSIGNED },
+	{ "ack", 13, 1, BINARY_FIELD_UNSIGNED },
+	{ "crc", 14, 2, BINARY_FIELD_UNSIGNED },
+	{ "data", 16, 8, BINARY_FIELD_BYTE_ARRAY },
+	{ "flags", 24, 1, BINARY_FIELD_UNSIGNED },
+	{ "connection", 25, 1, BINARY_FIELD_UNSIGNED }
+};
+
+//their order in the header
+enum BinaryFieldIndex { BinarySample, BinaryIdentifier, BinaryDlc, BinaryAck, BinaryCrc, BinaryData, BinaryFlags, BinaryConnection };
+
+static U64 ReadLittleEndian( const std::string& bytes, size_t offset, U32 num_bytes )
+{
+	U64 value = 0;
+	for( U32 i = 0; ( i < num_bytes ) && ( offset + i < bytes.size() ); i++ )
+		value |= U64( U8( bytes[ offset + i ] ) ) << ( 8 * i );
+	return value;
+}
+
+static void CheckValue( U64 value, U64 expected, const std::string& what )
+{
+	Check( value == expected, "binary export", what + ": " + std::to_string( value ) + " instead of " + std::to_string( expected ) );
+}
+
+static std::string ExportBinary( const TestCapture& capture, ResultDetail result_detail )
+{
+	DeviceNetAnalyzer analyzer;
+	FillSettings( (DeviceNetAnalyzerSettings*)analyzer.GetAnalyzerSettings(), BitSampling_EdgeRuns, result_detail, Markers_StuffBitsAndErrors, 1 );
+	analyzer.SetSampleRate( TEST_SAMPLE_RATE );
+	Process( analyzer, capture, capture.mEdges.size() );
+
+	return ReadExport( analyzer, Export_Binary );
+}
+
+//the header up to the records, and where it says the fields are; false if it's not what the format says.
+static bool ReadBinaryHeader( const std::string& file, U32 num_records, U32* field_offsets )
+{
+	if( Check( file.size() == BINARY_HEADER_BYTES + num_records * BINARY_RECORD_BYTES, "binary export", "file size " + std::to_string( file.size() ) ) == false )
+		return false;
+
+	Check( file.compare( 0, 8, std::string( "DNETCAN\0", 8 ) ) == 0, "binary export", "magic" );
+	CheckValue( ReadLittleEndian( file, 8, 2 ), 1, "version" );
+	CheckValue( ReadLittleEndian( file, 10, 2 ), BINARY_NUM_FIELDS, "number of fields" );
+	CheckValue( ReadLittleEndian( file, 12, 4 ), 160, "header bytes" );
+	CheckValue( ReadLittleEndian( file, 16, 4 ), 32, "record bytes" );
+	CheckValue( ReadLittleEndian( file, 20, 4 ), TEST_SAMPLE_RATE, "sample rate" );
+	CheckValue( ReadLittleEndian( file, 24, 8 ), 0, "trigger sample" );
+
+	for( U32 i = 0; i < BINARY_NUM_FIELDS; i++ )
+	{
+		size_t descriptor = BINARY_FIXED_HEADER_BYTES + i * BINARY_FIELD_BYTES;
+		std::string name = file.substr( descriptor, 12 );
+		std::string what = std::string( "field " ) + gBinaryFields[ i ].mName;
+
+		Check( name == std::string( gBinaryFields[ i ].mName ).append( 12 - strlen( gBinaryFields[ i ].mName ), '\0' ), "binary export", what + ": name" );
+		CheckValue( ReadLittleEndian( file, descriptor + 12, 2 ), gBinaryFields[ i ].mOffset, what + ": offset" );
+		CheckValue( ReadLittleEndian( file, descriptor + 14, 1 ), gBinaryFields[ i ].mSize, what + ": size" );
+		CheckValue( ReadLittleEndian( file, descriptor + 15, 1 ), gBinaryFields[ i ].mType, what + ": type" );
+		field_offsets[ i ] = U32( ReadLittleEndian( file, descriptor + 12, 2 ) );
+	}
+
+	return true;
+}
+
+static U64 ReadBinaryField( const std::string& file, U32 record, const U32* field_offsets, U32 field )
+{
+	return ReadLittleEndian( file, BINARY_HEADER_BYTES + record * BINARY_RECORD_BYTES + field_offsets[ field ], gBinaryFields[ field ].mSize );
+}
+
+void TestBinaryExport()
+{
+	//an acknowledged standard frame, an extended one nobody acknowledged, and a frame an error frame cuts off in its
+	//third data byte
+	TestCapture capture;
+	StartCapture( capture );
+	U64 first = AddCanFrame( capture, 0x3A5, { 0x11, 0x22, 0x33, 0x44, 0x55 }, ACK_RECEIVED );
+	AddIdle( capture, 10 );
+	U64 second = AddCanFrame( capture, 0x1234567, { 0xAB }, EXTENDED_IDENTIFIER );
+	AddIdle( capture, 10 );
+
+	std::vector<U8> bits;
+	EncodeCanFrame( 0x155, { 0xC3, 0x3C, 0xA5 }, ACK_RECEIVED, bits );
+	bits.resize( 40 );
+	bits.insert( bits.end(), 6, 0 );
+	bits.insert( bits.end(), 8, 1 );
+	U64 third = capture.mNumSamples;
+	AddBits( capture, bits );
+	AddIdle( capture, 20 );
+
+	//compact results leave the cut frame out, and have a message's time where its start bit is
+	U32 offsets[ BINARY_NUM_FIELDS ];
+	std::string compact = ExportBinary( capture, Results_Compact );
+	if( ReadBinaryHeader( compact, 2, offsets ) == false )
+		return;
+	CheckValue( ReadBinaryField( compact, 0, offsets, BinarySample ), first, "compact sample" );
+	CheckValue( ReadBinaryField( compact, 1, offsets, BinarySample ), second, "compact sample of the extended frame" );
+
+	//field results time a message from its identifier, and have what the error frame left of the third
+	std::string fields = ExportBinary( capture, Results_Fields );
+	if( ReadBinaryHeader( fields, 3, offsets ) == false )
+		return;
+
+	const U64 starts[] = { first, second, third };
+	const U64 identifiers[] = { 0x3A5, 0x1234567, 0x155 };
+	const U64 dlcs[] = { 5, 1, 3 };
+	const U64 acks[] = { 1, 0, 0 };
+	const U64 crcs[] = { 0x4AC2, 0x0018, 0 };		//the CRCs EncodeCanFrame sent
+	const U64 flags[] = { ACK_RECEIVED, EXTENDED_IDENTIFIER, BINARY_INCOMPLETE };
+	const std::string data[] =
+	{
+		std::string( "\x11\x22\x33\x44\x55\0\0\0", 8 ),
+		std::string( "\xAB\0\0\0\0\0\0\0", 8 ),
+		std::string( "\xC3\x3C\0\0\0\0\0\0", 8 )		//what's missing is 0
+	};
+
+	for( U32 record = 0; record < 3; record++ )
+	{
+		std::string what = "record " + std::to_string( record );
+		U64 sample = ReadBinaryField( fields, record, offsets, BinarySample );
+		Check( ( sample > starts[ record ] ) && ( sample < starts[ record ] + 2 * TEST_SAMPLES_PER_BIT ), "binary export", what + ": sample " + std::to_string( sample ) );
+		CheckValue( ReadBinaryField( fields, record, offsets, BinaryIdentifier ), identifiers[ record ], what + ": identifier" );
+		CheckValue( ReadBinaryField( fields, record, offsets, BinaryDlc ), dlcs[ record ], what + ": DLC" );
+		CheckValue( ReadBinaryField( fields, record, offsets, BinaryAck ), acks[ record ], what + ": ack" );
+		CheckValue( ReadBinaryField( fields, record, offsets, BinaryCrc ), crcs[ record ], what + ": CRC" );
+		CheckValue( ReadBinaryField( fields, record, offsets, BinaryFlags ), flags[ record ], what + ": flags" );
+		CheckValue( ReadBinaryField( fields, record, offsets, BinaryConnection ), NoConnection, what + ": connection" );
+
+		//the data bytes in the order they went out, and the record's last bytes 0
+		size_t record_start = BINARY_HEADER_BYTES + record * BINARY_RECORD_BYTES;
+		Check( fields.compare( record_start + offsets[ BinaryData ], 8, data[ record ] ) == 0, "binary export", what + ": data bytes" );
+		Check( fields.compare( record_start + 26, BINARY_RECORD_BYTES - 26, std::string( BINARY_RECORD_BYTES - 26, '\0' ) ) == 0, "binary export", what + ": padding" );
+	}
+
+	printf( "binary export: header, field offsets, data byte order and an incomplete frame\n" );
+}
@@ -0,0 +1,184 @@
+//DeviceNetConnectionTracker: a master allocating and releasing its slaves' connections, as compact messages fed to
+//the tracker, and the connection each message's identifier is labelled with on the way through (CONNECTION_SHIFT)
+//-- the one allocated when the message went out, not the one it sets up.
+
+#include "DeviceNetTests.h"
+#include "DeviceNetCip.h"
+#include "DeviceNetConnectionTracker.h"
+
+#include <cstdio>
+
+#define MASTER_MAC_ID	1
+
+static U32 Group1( U32 message_id, U32 mac_id )
+{
+	return BITS_MESSAGE_GROUP_1 | ( message_id << SHIFT_GROUP_1_MESSAGE_ID ) | mac_id;
+}
+
+static U32 Group2( U32 mac_id, U32 message_id )
+{
+	return BITS_MESSAGE_GROUP_2 | ( mac_id << SHIFT_MAC_ID ) | message_id;
+}
+
+class ConnectionLabels : public DeviceNetDecoderListener
+{
+public:
+	virtual void OnRecord( const DeviceNetRecord& record )
+	{
+		mLabel = DeviceNetConnection( ( record.mData1 >> CONNECTION_SHIFT ) & CONNECTION_MASK );
+	}
+
+	virtual void OnMarker( U64 /*sample*/, DeviceNetMarkerType /*type*/ ) {}
+
+	DeviceNetConnection mLabel;
+};
+
+class ConnectionMaster
+{
+public:
+	ConnectionMaster()
+	:	mSample( 0 )
+	{
+		mTracker.Start( NULL, &mLabels );
+	}
+
+	//sends a message, and checks the label it got
+	void Expect( U32 identifier, const std::vector<U8>& data, DeviceNetConnection connection, const std::string& what )
+	{
+		mSample = SendMessage( &mTracker, mSample, identifier, data ) + 20 * TEST_SAMPLES_PER_BIT;
+		Check( mLabels.mLabel == connection, "connection tracker", what + ": connection " + std::to_string( mLabels.mLabel ) + " instead of " + std::to_string( connection ) );
+	}
+
+	//Allocate or Release to the slave's DeviceNet object (8/8 format), on Group 2 Message ID 6 or the explicit connection
+	void Request( U32 slave, U32 message_id, U8 service, U8 choice )
+	{
+		std::vector<U8> data = { MASTER_MAC_ID, service, CIP_CLASS_DEVICENET, 1, choice };
+		if( service == CIP_SERVICE_OPEN_CONNECTION )
+			data.push_back( MASTER_MAC_ID );
+
+		mSample = SendMessage( &mTracker, mSample, Group2( slave, message_id ), data ) + 20 * TEST_SAMPLES_PER_BIT;
+	}
+
+	//the slave's response on Group 2 Message ID 3
+	void Respond( U32 slave, U8 service )
+	{
+		std::vector<U8> data = { MASTER_MAC_ID, U8( service | CIP_SERVICE_RESPONSE ) };
+		if( service == CIP_SERVICE_OPEN_CONNECTION )
+			data.push_back( 0 );	//message body format 8/8
+		if( service == CIP_SERVICE_ERROR_RESPONSE )
+		{
+			data.push_back( 0x0C );	//object state conflict
+			data.push_back( CIP_NO_ADDITIONAL_CODE );
+		}
+
+		mSample = SendMessage( &mTracker, mSample, Group2( slave, 3 ), data ) + 20 * TEST_SAMPLES_PER_BIT;
+	}
+
+	void Allocate( U32 slave, U8 choice )
+	{
+		Request( slave, CHECK_GROUP_2_MSG_ID_IS_CONNECTION_MANAGEMENT, CIP_SERVICE_OPEN_CONNECTION, choice );
+		Respond( slave, CIP_SERVICE_OPEN_CONNECTION );
+	}
+
+	DeviceNetConnectionTracker mTracker;
+	ConnectionLabels mLabels;
+	U64 mSample;
+};
+
+static const std::vector<U8> gIOData = { 0x12, 0x34 };
+
+static void TestAllocateAndRelease()
+{
+	ConnectionMaster master;
+
+	master.Expect( Group2( 5, 5 ), gIOData, NoConnection, "poll command before the allocation" );
+	master.Expect( Group1( 0xF, 5 ), gIOData, NoConnection, "poll response before the allocation" );
+
+	//the request on the Group 2 only port, labelled as things were; nothing changes until the response
+	master.Request( 5, CHECK_GROUP_2_MSG_ID_IS_CONNECTION_MANAGEMENT, CIP_SERVICE_OPEN_CONNECTION, ALLOCATE_EXPLICIT | ALLOCATE_POLLED );
+	Check( master.mLabels.mLabel == NoConnection, "connection tracker", "allocate request" );
+	master.Expect( Group2( 5, 5 ), gIOData, NoConnection, "poll command before the response" );
+
+	master.Respond( 5, CIP_SERVICE_OPEN_CONNECTION );
+	Check( master.mLabels.mLabel == NoConnection, "connection tracker", "allocate response" );
+	master.Expect( Group2( 5, 5 ), gIOData, PollConnection, "poll command" );
+	master.Expect( Group1( 0xF, 5 ), gIOData, PollConnection, "poll response" );
+	master.Expect( Group2( 5, 4 ), { MASTER_MAC_ID, CIP_SERVICE_GET_ATTRIBUTE_SINGLE, 1, 1, 7 }, ExplicitConnection, "explicit request" );
+	master.Expect( Group2( 5, 3 ), { MASTER_MAC_ID, CIP_SERVICE_GET_ATTRIBUTE_SINGLE | CIP_SERVICE_RESPONSE, 0x2A }, ExplicitConnection, "explicit response" );
+	master.Expect( Group1( 0xD, 5 ), gIOData, NoConnection, "change of state message without the connection" );
+	master.Expect( Group2( 6, 5 ), gIOData, NoConnection, "poll command to another slave" );
+
+	//more on the explicit connection: both poll and change of state
+	master.Request( 5, 4, CIP_SERVICE_OPEN_CONNECTION, ALLOCATE_CHANGE_OF_STATE );
+	Check( master.mLabels.mLabel == ExplicitConnection, "connection tracker", "allocate request on the explicit connection" );
+	master.Respond( 5, CIP_SERVICE_OPEN_CONNECTION );
+	master.Expect( Group1( 0xD, 5 ), gIOData, ChangeOfStateConnection, "change of state message" );
+	master.Expect( Group2( 5, 2 ), gIOData, ChangeOfStateConnection, "change of state acknowledge" );
+	master.Expect( Group2( 5, 5 ), gIOData, PollConnection, "poll command with change of state too" );
+	master.Expect( Group1( 0xF, 5 ), gIOData, PollConnection, "poll response with change of state too" );
+
+	//without the poll connection, Group 2 Message ID 5 is the master's change of state message, and Group 1
+	//Message ID 15 the slave's acknowledgement
+	master.Request( 5, 4, CIP_SERVICE_CLOSE_CONNECTION, ALLOCATE_POLLED );
+	master.Respond( 5, CIP_SERVICE_CLOSE_CONNECTION );
+	master.Expect( Group2( 5, 5 ), gIOData, ChangeOfStateConnection, "change of state message from the master" );
+	master.Expect( Group1( 0xF, 5 ), gIOData, ChangeOfStateConnection, "change of state acknowledge from the slave" );
+	master.Expect( Group2( 5, 4 ), { MASTER_MAC_ID, CIP_SERVICE_GET_ATTRIBUTE_SINGLE, 1, 1, 7 }, ExplicitConnection, "explicit request after the release" );
+
+	//a slave that turns a request down keeps what it had, and a response after that is to nothing
+	master.Request( 5, 4, CIP_SERVICE_OPEN_CONNECTION, ALLOCATE_CYCLIC );
+	master.Respond( 5, CIP_SERVICE_ERROR_RESPONSE );
+	master.Expect( Group1( 0xD, 5 ), gIOData, ChangeOfStateConnection, "change of state message after an error response" );
+	master.Respond( 5, CIP_SERVICE_OPEN_CONNECTION );
+	master.Expect( Group1( 0xD, 5 ), gIOData, ChangeOfStateConnection, "change of state message after a response to nothing" );
+
+	//cyclic instead of change of state, on a slave with no poll connection
+	master.Allocate( 7, ALLOCATE_CYCLIC );
+	master.Expect( Group2( 7, 5 ), gIOData, CyclicConnection, "cyclic message from the master" );
+	master.Expect( Group1( 0xF, 7 ), gIOData, CyclicConnection, "cyclic acknowledge from the slave" );
+	master.Expect( Group1( 0xD, 7 ), gIOData, CyclicConnection, "cyclic message from the slave" );
+}
+
+static void TestDuplicateMacId()
+{
+	ConnectionMaster master;
+	master.Allocate( 5, ALLOCATE_EXPLICIT | ALLOCATE_POLLED );
+	master.Allocate( 6, ALLOCATE_BIT_STROBED );
+	master.Allocate( 7, ALLOCATE_MULTICAST_POLLED );
+
+	master.Expect( Group2( MASTER_MAC_ID, 0 ), gIOData, BitStrobeConnection, "bit strobe command, on the master's MAC ID" );
+	master.Expect( Group1( 0xE, 6 ), gIOData, BitStrobeConnection, "bit strobe response" );
+	master.Expect( Group2( MASTER_MAC_ID, 1 ), gIOData, MulticastPollConnection, "multicast poll command, on the master's MAC ID" );
+	master.Expect( Group1( 0xC, 7 ), gIOData, MulticastPollConnection, "multicast poll response" );
+
+	//the master answering someone else's check is still online
+	std::vector<U8> check = { 0x00, 0x34, 0x12, 0x78, 0x56, 0x34, 0x12 };		//port 0, vendor ID, serial number
+	std::vector<U8> check_response = check;
+	check_response[ 0 ] |= 0x80;
+	master.Expect( Group2( MASTER_MAC_ID, CHECK_GROUP_2_MSG_ID_IS_CHECK_MESSAGE ), check_response, NoConnection, "duplicate MAC ID check response" );
+	master.Expect( Group2( 5, 5 ), gIOData, PollConnection, "poll command after the check response" );
+
+	//the master's own check request: it has just come online, so its slaves' connections are gone
+	master.Expect( Group2( MASTER_MAC_ID, CHECK_GROUP_2_MSG_ID_IS_CHECK_MESSAGE ), check, NoConnection, "duplicate MAC ID check request" );
+	master.Expect( Group2( 5, 5 ), gIOData, NoConnection, "poll command after the master's check" );
+	master.Expect( Group1( 0xF, 5 ), gIOData, NoConnection, "poll response after the master's check" );
+	master.Expect( Group2( 5, 4 ), { MASTER_MAC_ID, CIP_SERVICE_GET_ATTRIBUTE_SINGLE, 1, 1, 7 }, NoConnection, "explicit request after the master's check" );
+	master.Expect( Group2( MASTER_MAC_ID, 0 ), gIOData, NoConnection, "bit strobe command after the master's check" );
+	master.Expect( Group1( 0xE, 6 ), gIOData, NoConnection, "bit strobe response after the master's check" );
+	master.Expect( Group2( MASTER_MAC_ID, 1 ), gIOData, NoConnection, "multicast poll command after the master's check" );
+
+	//and a slave's own check takes its connections only
+	master.Allocate( 5, ALLOCATE_POLLED );
+	master.Allocate( 6, ALLOCATE_POLLED );
+	master.Expect( Group2( 6, CHECK_GROUP_2_MSG_ID_IS_CHECK_MESSAGE ), check, NoConnection, "slave's duplicate MAC ID check request" );
+	master.Expect( Group2( 6, 5 ), gIOData, NoConnection, "poll command after the slave's check" );
+	master.Expect( Group2( 5, 5 ), gIOData, PollConnection, "poll command to the other slave" );
+}
+
+void TestConnectionTracker()
+{
+	TestAllocateAndRelease();
+	TestDuplicateMacId();
+
+	printf( "connection tracker: allocation, release and duplicate MAC ID checks\n" );
+}
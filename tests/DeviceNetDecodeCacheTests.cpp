@@ -0,0 +1,121 @@
+//DeviceNetDecodeCache: a rerun after switching the result detail or marker policy, and a rerun on a capture that
+//has grown since, have to give what a fresh analyzer does -- the frames that were encoded, for a capture of known
+//frames, and a fresh decode's results for a simulated capture with glitches in it.
+
+#include "DeviceNetTests.h"
+
+#include <cstdio>
+#include <random>
+
+static void TestKnownFrames()
+{
+	std::mt19937 random( 16 );
+	TestCapture capture;
+	StartCapture( capture );
+
+	std::vector<U64> expected;	//start of frame, identifier and data, three entries each
+	for( U32 i = 0; i < 2000; i++ )
+	{
+		U32 identifier = random() & ( NUM_IDENTIFIERS - 1 );
+		std::vector<U8> data( random() % 9 );
+		U64 data_bits = 0;
+		for( U32 j = 0; j < data.size(); j++ )
+		{
+			data[ j ] = U8( random() );
+			data_bits |= U64( data[ j ] ) << ( 56 - 8 * j );
+		}
+
+		expected.push_back( AddCanFrame( capture, identifier, data, ACK_RECEIVED ) );
+		expected.push_back( identifier );
+		expected.push_back( data_bits );
+		AddIdle( capture, random() % 20 );
+	}
+	AddIdle( capture, 20 );
+
+	//field results first, then compact ones out of the cache: after the same capture, and after the first half of it
+	for( U32 resume = 0; resume < 2; resume++ )
+	{
+		DeviceNetAnalyzer analyzer;
+		DeviceNetAnalyzerSettings* settings = (DeviceNetAnalyzerSettings*)analyzer.GetAnalyzerSettings();
+		FillSettings( settings, BitSampling_EdgeRuns, Results_Fields, Markers_StuffBitsAndErrors, 1 );
+		analyzer.SetSampleRate( TEST_SAMPLE_RATE );
+
+		Process( analyzer, capture, ( resume == 1 ) ? capture.mEdges.size() / 2 : capture.mEdges.size() );
+		settings->mResultDetail = Results_Compact;
+		Process( analyzer, capture, capture.mEdges.size() );
+
+		TestResults results;
+		CollectResults( analyzer, results );
+
+		std::vector<U64> messages;
+		for( U32 i = 0; i < results.mFrames.size(); i++ )
+		{
+			if( results.mFrames[ i ].mType != CanMessage )
+				continue;
+
+			messages.push_back( results.mFrames[ i ].mStartingSampleInclusive );
+			messages.push_back( results.mFrames[ i ].mData1 & COMPACT_IDENTIFIER_MASK );
+			messages.push_back( results.mFrames[ i ].mData2 );
+		}
+
+		Check( messages == expected, "decode cache", std::string( ( resume == 1 ) ? "resume" : "rerun" ) + " of known frames: " +
+			std::to_string( messages.size() / 3 ) + " messages, not the " + std::to_string( expected.size() / 3 ) + " encoded" );
+	}
+}
+
+static void TestSimulatedCapture( const TestCapture& capture )
+{
+	static const ResultDetail result_details[] = { Results_Fields, Results_Compact };
+	static const MarkerPolicy marker_policies[] = { Markers_None, Markers_StuffBitsAndErrors, Markers_EveryBit };
+	static const U32 decoder_threads[] = { 1, 4 };
+
+	for( U32 threads = 0; threads < 2; threads++ )
+	{
+		for( U32 first = 0; first < 2; first++ )
+		{
+			for( U32 second = 0; second < 2; second++ )
+			{
+				for( U32 markers = 0; markers < 3; markers++ )
+				{
+					TestResults expected;
+					Decode( capture, BitSampling_EdgeRuns, result_details[ second ], marker_policies[ markers ], decoder_threads[ threads ], expected );
+
+					//the same capture again, then one that has grown since the first run
+					for( U32 resume = 0; resume < 2; resume++ )
+					{
+						DeviceNetAnalyzer analyzer;
+						DeviceNetAnalyzerSettings* settings = (DeviceNetAnalyzerSettings*)analyzer.GetAnalyzerSettings();
+						FillSettings( settings, BitSampling_EdgeRuns, result_details[ first ], Markers_StuffBitsAndErrors, decoder_threads[ threads ] );
+						analyzer.SetSampleRate( TEST_SAMPLE_RATE );
+
+						Process( analyzer, capture, ( resume == 1 ) ? capture.mEdges.size() / 2 : capture.mEdges.size() );
+
+						settings->mResultDetail = result_details[ second ];
+						settings->mMarkerPolicy = marker_policies[ markers ];
+						Process( analyzer, capture, capture.mEdges.size() );
+
+						TestResults results;
+						CollectResults( analyzer, results );
+
+						std::string what = std::string( ( resume == 1 ) ? "resume" : "rerun" ) + ", " + std::to_string( decoder_threads[ threads ] ) + " threads, detail " +
+							std::to_string( first ) + " then " + std::to_string( second ) + ", markers " + std::to_string( markers );
+						std::string difference = CompareResults( expected, results );
+						Check( difference.empty(), "decode cache", what + ": " + difference );
+					}
+				}
+			}
+		}
+	}
+}
+
+
+void TestDecodeCache()
+{
+	TestKnownFrames();
+
+	TestCapture capture;
+	GenerateCapture( 1.0, 400, 16, capture );
+	TestSimulatedCapture( capture );
+
+	printf( "decode cache: reruns and resumes\n" );
+}
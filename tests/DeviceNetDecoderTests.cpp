@@ -0,0 +1,162 @@
+//DeviceNetDecoder on frames put together here: standard, extended and remote frames, with and without an ACK,
+//and data that needs a lot of stuff bits.  Each has to come out as exactly the frame that went in, in compact
+//results (one CanMessage each) and as fields.  With the bit rate on Auto, the analyzer has to find the rate and
+//still decode the capture from its first frame.
+
+#include "DeviceNetTests.h"
+#include "DeviceNetDecoder.h"
+
+#include <cstdio>
+
+struct KnownFrame
+{
+	U32 mIdentifier;
+	std::vector<U8> mData;
+	U32 mFlags;
+	U64 mStartOfFrame;
+};
+
+static void AddKnownFrames( TestCapture& capture, std::vector<KnownFrame>& frames )
+{
+	static const U8 counting[] = { 0x11, 0x22, 0x33 };
+	static const U8 mixed[] = { 0xDE, 0xAD, 0xBE, 0xEF, 0x00, 0xFF, 0x01, 0x80 };
+	static const U8 zeros[] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+	static const U8 ones[] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+	static const U8 remote_dlc[] = { 0, 0, 0, 0 };
+
+	frames.clear();
+	frames.push_back( { 0x123, std::vector<U8>( counting, counting + 3 ), ACK_RECEIVED, 0 } );
+	frames.push_back( { 0x1ABCDE12, std::vector<U8>( mixed, mixed + 8 ), EXTENDED_IDENTIFIER | ACK_RECEIVED, 0 } );
+	frames.push_back( { 0x5A1, std::vector<U8>( remote_dlc, remote_dlc + 4 ), REMOTE_FRAME | ACK_RECEIVED, 0 } );
+	frames.push_back( { 0x00000001, std::vector<U8>(), EXTENDED_IDENTIFIER | REMOTE_FRAME | ACK_RECEIVED, 0 } );
+	frames.push_back( { 0x000, std::vector<U8>( zeros, zeros + 8 ), 0, 0 } );
+	frames.push_back( { 0x7EF, std::vector<U8>( ones, ones + 8 ), ACK_RECEIVED, 0 } );
+	frames.push_back( { 0x400, std::vector<U8>(), ACK_RECEIVED, 0 } );
+
+	StartCapture( capture );
+	for( U32 i = 0; i < frames.size(); i++ )
+	{
+		frames[ i ].mStartOfFrame = AddCanFrame( capture, frames[ i ].mIdentifier, frames[ i ].mData, frames[ i ].mFlags );
+		AddIdle( capture, 5 );
+	}
+	AddIdle( capture, 20 );
+}
+
+static void TestCompactFrames( const TestCapture& capture, const std::vector<KnownFrame>& frames )
+{
+	TestResults results;
+	Decode( capture, BitSampling_EdgeRuns, Results_Compact, Markers_StuffBitsAndErrors, 1, results );
+
+	U32 num_messages = 0;
+	for( U32 i = 0; i < results.mFrames.size(); i++ )
+	{
+		const Frame& frame = results.mFrames[ i ];
+		if( frame.mType != CanMessage )
+			continue;
+
+		std::string what = "message " + std::to_string( num_messages );
+		if( Check( num_messages < frames.size(), "decoder", what + ": more messages than frames" ) == false )
+			return;
+
+		const KnownFrame& known = frames[ num_messages++ ];
+		U64 data = 0;
+		if( ( known.mFlags & REMOTE_FRAME ) == 0 )
+			for( U32 j = 0; j < known.mData.size(); j++ )
+				data |= U64( known.mData[ j ] ) << ( 56 - 8 * j );
+
+		Check( frame.mStartingSampleInclusive == S64( known.mStartOfFrame ), "decoder", what + ": starts somewhere else" );
+		Check( ( frame.mData1 & COMPACT_IDENTIFIER_MASK ) == known.mIdentifier, "decoder", what + ": identifier" );
+		Check( ( ( frame.mData1 >> COMPACT_DLC_SHIFT ) & COMPACT_DLC_MASK ) == known.mData.size(), "decoder", what + ": DLC" );
+		Check( ( ( frame.mData1 >> COMPACT_FLAGS_SHIFT ) & COMPACT_FLAGS_MASK ) == known.mFlags, "decoder", what + ": flags" );
+		Check( frame.mFlags == known.mFlags, "decoder", what + ": frame flags" );
+		Check( frame.mData2 == data, "decoder", what + ": data" );
+	}
+
+	Check( num_messages == frames.size(), "decoder", std::to_string( num_messages ) + " messages instead of " + std::to_string( frames.size() ) );
+}
+
+static void TestFieldFrames( const TestCapture& capture, const std::vector<KnownFrame>& frames )
+{
+	TestResults results;
+	Decode( capture, BitSampling_SamplePoints, Results_Fields, Markers_StuffBitsAndErrors, 1, results );
+
+	//the identifier fields, and the data bytes of every frame in a row
+	std::vector<U32> identifiers;
+	std::vector<U8> data;
+	U32 num_errors = 0;
+	for( U32 i = 0; i < results.mFrames.size(); i++ )
+	{
+		const Frame& frame = results.mFrames[ i ];
+		if( ( frame.mType == IdentifierField ) || ( frame.mType == IdentifierFieldEx ) )
+			identifiers.push_back( U32( frame.mData1 ) );
+		else if( frame.mType == DataField )
+			data.push_back( U8( frame.mData1 ) );
+		else if( ( frame.mType == DeviceNetError ) || ( ( frame.mType == CrcField ) && ( ( frame.mFlags & CRC_ERROR ) != 0 ) ) )
+			num_errors++;
+	}
+
+	std::vector<U32> expected_identifiers;
+	std::vector<U8> expected_data;
+	for( U32 i = 0; i < frames.size(); i++ )
+	{
+		expected_identifiers.push_back( frames[ i ].mIdentifier );
+		if( ( frames[ i ].mFlags & REMOTE_FRAME ) == 0 )
+			expected_data.insert( expected_data.end(), frames[ i ].mData.begin(), frames[ i ].mData.end() );
+	}
+
+	Check( identifiers == expected_identifiers, "decoder", "field results: identifiers" );
+	Check( data == expected_data, "decoder", "field results: data bytes" );
+	Check( num_errors == 0, "decoder", "field results: " + std::to_string( num_errors ) + " errors" );
+}
+
+static void TestBitRateDetection( const TestCapture& known_capture )
+{
+	//the same pulses at half and a quarter of the bit rate
+	static const U32 bit_rates[] = { BitRate_500K, BitRate_250K, BitRate_125K };
+	for( U32 i = 0; i < 3; i++ )
+	{
+		std::vector<U64> edges = known_capture.mEdges;
+		for( U32 j = 0; j < edges.size(); j++ )
+			edges[ j ] *= BitRate_500K / bit_rates[ i ];
+
+		U32 bit_rate = DeviceNetDecoder::DetectBitRate( edges.data(), U32( edges.size() ), TEST_SAMPLE_RATE );
+		Check( bit_rate == bit_rates[ i ], "bit rate detection", std::to_string( bit_rate ) + " instead of " + std::to_string( bit_rates[ i ] ) );
+	}
+
+	TestCapture capture;
+	GenerateCapture( 0.25, 0, 10, capture );
+
+	TestResults expected;
+	Decode( capture, BitSampling_EdgeRuns, Results_Compact, Markers_StuffBitsAndErrors, 1, expected );
+	Check( ( expected.mFrames.empty() == false ) && ( expected.mFrames[ 0 ].mStartingSampleInclusive == S64( capture.mEdges[ 0 ] ) ), "bit rate detection", "the first frame isn't at the first edge" );
+
+	static const U32 decoder_threads[] = { 1, 4 };
+	for( U32 threads = 0; threads < 2; threads++ )
+	{
+		DeviceNetAnalyzer analyzer;
+		DeviceNetAnalyzerSettings* settings = (DeviceNetAnalyzerSettings*)analyzer.GetAnalyzerSettings();
+		FillSettings( settings, BitSampling_EdgeRuns, Results_Compact, Markers_StuffBitsAndErrors, decoder_threads[ threads ] );
+		settings->mBitRate = BitRate_Auto;
+		analyzer.SetSampleRate( TEST_SAMPLE_RATE );
+		Process( analyzer, capture, capture.mEdges.size() );
+
+		TestResults results;
+		CollectResults( analyzer, results );
+
+		std::string difference = CompareResults( expected, results );
+		Check( difference.empty(), "bit rate detection", std::to_string( decoder_threads[ threads ] ) + " threads: " + difference );
+	}
+}
+
+void TestDecoder()
+{
+	TestCapture capture;
+	std::vector<KnownFrame> frames;
+	AddKnownFrames( capture, frames );
+
+	TestCompactFrames( capture, frames );
+	TestFieldFrames( capture, frames );
+	TestBitRateDetection( capture );
+
+	printf( "decoder: %u known frames, bit rate detection\n", U32( frames.size() ) );
+}
@@ -0,0 +1,189 @@
+//DeviceNetDestuffer, with and without BMI2: a few frames worked out by hand, then random ones fed a few bits at a
+//time against destuffing them one bit at a time.
+
+#include "DeviceNetTests.h"
+#include "DeviceNetDestuffer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+
+struct DestuffResult
+{
+	DeviceNetBitBuffer mBits;
+	DeviceNetBitBuffer mStuffBits;
+	U32 mErrorIndex;
+};
+
+//the stuffing rule a bit at a time: after five identical bits (stuff bits included) comes a stuff bit of the other
+//value, and a sixth identical one is an error.  The bus is idle in front of the start bit.
+static void DestuffBitByBit( const DeviceNetBitBuffer& raw_bits, DestuffResult& result )
+{
+	bool run_value = true;
+	U32 run_length = 1;
+	result.mErrorIndex = NO_STUFF_ERROR;
+
+	for( U32 i = 0; i < raw_bits.GetNumBits(); i++ )
+	{
+		bool bit = raw_bits.GetBit( i );
+
+		if( run_length == 5 )
+		{
+			if( bit == run_value )
+			{
+				result.mErrorIndex = i;
+				return;
+			}
+
+			result.mStuffBits.Append( true, 1 );
+			run_value = bit;
+			run_length = 1;
+			continue;
+		}
+
+		run_length = ( bit == run_value ) ? run_length + 1 : 1;
+		run_value = bit;
+		result.mBits.Append( bit, 1 );
+		result.mStuffBits.Append( false, 1 );
+	}
+}
+
+//through the destuffer a few raw bits at a time, the way the decoder samples them.
+static void DestuffInSteps( const DeviceNetBitBuffer& raw_bits, std::mt19937& random, DestuffResult& result )
+{
+	DeviceNetDestuffer destuffer;
+	DeviceNetBitBuffer sampled;
+	result.mErrorIndex = NO_STUFF_ERROR;
+
+	while( sampled.GetNumBits() < raw_bits.GetNumBits() )
+	{
+		U32 num_bits = std::min( 1 + U32( random() % 80 ), raw_bits.GetNumBits() - sampled.GetNumBits() );
+		for( U32 i = 0; i < num_bits; i++ )
+			sampled.Append( raw_bits.GetBit( sampled.GetNumBits() ), 1 );
+
+		result.mErrorIndex = destuffer.Destuff( sampled, result.mBits, result.mStuffBits );
+	}
+}
+
+static bool SameBits( const DeviceNetBitBuffer& a, const DeviceNetBitBuffer& b )
+{
+	if( a.GetNumBits() != b.GetNumBits() )
+		return false;
+
+	for( U32 i = 0; i < a.GetNumBits(); i++ )
+		if( a.GetBit( i ) != b.GetBit( i ) )
+			return false;
+
+	return true;
+}
+
+static bool SameDestuff( const DestuffResult& a, const DestuffResult& b )
+{
+	return ( a.mErrorIndex == b.mErrorIndex ) && ( SameBits( a.mBits, b.mBits ) == true ) && ( SameBits( a.mStuffBits, b.mStuffBits ) == true );
+}
+
+static void TestRandomFrames()
+{
+	std::mt19937 random( 14 );
+	U32 num_frames = 200000;
+	U32 num_errors = 0;
+
+	for( U32 frame = 0; frame < num_frames; frame++ )
+	{
+		//runs of 1 to 5 identical bits, now and then one of 6, up to a full buffer
+		DeviceNetBitBuffer raw_bits;
+		U32 num_bits = 1 + random() % BIT_BUFFER_MAX_BITS;
+		bool value = false;
+		while( raw_bits.GetNumBits() < num_bits )
+		{
+			U32 run_length = ( ( random() % 64 ) == 0 ) ? 6 : 1 + random() % 5;
+			raw_bits.Append( value, std::min( run_length, num_bits - raw_bits.GetNumBits() ) );
+			value = !value;
+		}
+
+		DestuffResult expected;
+		DestuffBitByBit( raw_bits, expected );
+		if( expected.mErrorIndex != NO_STUFF_ERROR )
+			num_errors++;
+
+		U32 seed = random();
+		for( U32 bmi2 = 0; bmi2 < 2; bmi2++ )
+		{
+			DeviceNetDestuffer::SetBmi2Enabled( bmi2 == 1 );
+
+			std::mt19937 steps( seed );
+			DestuffResult result;
+			DestuffInSteps( raw_bits, steps, result );
+
+			std::string what = std::string( ( bmi2 == 1 ) ? "BMI2" : "portable" ) + ", frame " + std::to_string( frame );
+			if( Check( SameDestuff( expected, result ), "destuffing", what ) == false )
+			{
+				DeviceNetDestuffer::SetBmi2Enabled( true );
+				return;
+			}
+		}
+	}
+
+	DeviceNetDestuffer::SetBmi2Enabled( true );
+	printf( "destuffing: %u frames, %u with stuff errors, BMI2 %s\n", num_frames, num_errors, ( DeviceNetDestuffer::IsBmi2Available() == true ) ? "and portable" : "not available, portable only" );
+}
+
+
+struct KnownDestuff
+{
+	const char* mRawBits;
+	const char* mBits;
+	const char* mStuffBits;
+	U32 mErrorIndex;
+};
+
+static void AppendText( DeviceNetBitBuffer& buffer, const char* text )
+{
+	for( ; *text != 0; text++ )
+		buffer.Append( *text == '1', 1 );
+}
+
+static void TestKnownFrames()
+{
+	static const KnownDestuff known[] =
+	{
+		{ "0101101", "0101101", "0000000", NO_STUFF_ERROR },
+		{ "0000011111010", "00000111110", "0000010000100", NO_STUFF_ERROR },	//the stuff bit starts the next run
+		{ "0111110", "011111", "0000001", NO_STUFF_ERROR },
+		{ "01111100000", "0111110000", "00000010000", NO_STUFF_ERROR },
+		{ "0000001", "00000", "00000", 5 },
+		{ "00000111111", "000001111", "0000010000", 10 },
+		{ "011111000000", "0111110000", "00000010000", 11 },
+	};
+
+	for( U32 bmi2 = 0; bmi2 < 2; bmi2++ )
+	{
+		DeviceNetDestuffer::SetBmi2Enabled( bmi2 == 1 );
+
+		for( U32 i = 0; i < sizeof( known ) / sizeof( known[ 0 ] ); i++ )
+		{
+			DeviceNetBitBuffer raw_bits;
+			AppendText( raw_bits, known[ i ].mRawBits );
+
+			DestuffResult expected;
+			AppendText( expected.mBits, known[ i ].mBits );
+			AppendText( expected.mStuffBits, known[ i ].mStuffBits );
+			expected.mErrorIndex = known[ i ].mErrorIndex;
+
+			DestuffResult result;
+			DeviceNetDestuffer destuffer;
+			result.mErrorIndex = destuffer.Destuff( raw_bits, result.mBits, result.mStuffBits );
+
+			std::string what = std::string( ( bmi2 == 1 ) ? "BMI2" : "portable" ) + ", " + known[ i ].mRawBits;
+			Check( SameDestuff( expected, result ), "destuffing", what );
+		}
+	}
+
+	DeviceNetDestuffer::SetBmi2Enabled( true );
+}
+
+void TestDestuffer()
+{
+	TestKnownFrames();
+	TestRandomFrames();
+}
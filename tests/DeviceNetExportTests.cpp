@@ -0,0 +1,115 @@
+//The exports, written by DeviceNetParallelExport: a candump log of known frames written on 4 threads has to say
+//exactly what was encoded, and every export type of a simulated capture with glitches in it has to come out byte
+//for byte the same with 1 decoder thread as with 4.
+
+#include "DeviceNetTests.h"
+#include "DeviceNetAnalyzerResults.h"
+#include "DeviceNetParallelExport.h"
+
+#include <cstdio>
+#include <random>
+
+//the ASC header carries the time of the export.
+static std::string StripAscHeader( const std::string& text )
+{
+	size_t header_end = text.find( "Start of measurement" );
+	if( header_end == std::string::npos )
+		return text;
+
+	return text.substr( header_end );
+}
+
+static void TestKnownCandump()
+{
+	//more frames than one export chunk per thread
+	std::mt19937 random( 25 );
+	TestCapture capture;
+	StartCapture( capture );
+
+	std::string expected;
+	for( U32 i = 0; i < 8 * EXPORT_CHUNK_PACKETS; i++ )
+	{
+		U32 flags = ACK_RECEIVED;
+		if( ( random() % 8 ) == 0 )
+			flags |= EXTENDED_IDENTIFIER;
+		if( ( random() % 8 ) == 0 )
+			flags |= REMOTE_FRAME;
+
+		U32 identifier = random() & ( ( ( flags & EXTENDED_IDENTIFIER ) != 0 ) ? COMPACT_IDENTIFIER_MASK : ( NUM_IDENTIFIERS - 1 ) );
+		std::vector<U8> data( random() % 9 );
+		for( U32 j = 0; j < data.size(); j++ )
+			data[ j ] = U8( random() );
+
+		U64 sample = AddCanFrame( capture, identifier, data, flags );
+		AddIdle( capture, random() % 20 );
+
+		char line[ 64 ];
+		snprintf( line, sizeof( line ), ( ( flags & EXTENDED_IDENTIFIER ) != 0 ) ? "(%010llu.%06llu) can0 %08X#" : "(%010llu.%06llu) can0 %03X#",
+			(unsigned long long)( sample / TEST_SAMPLE_RATE ), (unsigned long long)( ( sample % TEST_SAMPLE_RATE ) * 1000000 / TEST_SAMPLE_RATE ), identifier );
+		expected += line;
+
+		if( ( flags & REMOTE_FRAME ) != 0 )
+		{
+			expected += "R";
+			if( data.empty() == false )
+				expected += std::to_string( data.size() );
+		}
+		else
+		{
+			for( U32 j = 0; j < data.size(); j++ )
+			{
+				snprintf( line, sizeof( line ), "%02X", data[ j ] );
+				expected += line;
+			}
+		}
+		expected += "\n";
+	}
+	AddIdle( capture, 20 );
+
+	//compact results: in field results, a message's time is where its identifier starts
+	DeviceNetAnalyzer analyzer;
+	FillSettings( (DeviceNetAnalyzerSettings*)analyzer.GetAnalyzerSettings(), BitSampling_EdgeRuns, Results_Compact, Markers_StuffBitsAndErrors, 4 );
+	analyzer.SetSampleRate( TEST_SAMPLE_RATE );
+	Process( analyzer, capture, capture.mEdges.size() );
+
+	Check( ReadExport( analyzer, Export_Candump ) == expected, "export threads", "candump of known frames" );
+}
+
+static void TestSimulatedCapture( const TestCapture& capture )
+{
+	static const ResultDetail result_details[] = { Results_Fields, Results_Compact };
+	static const char* export_names[] = { "CSV", "latency", "binary", "candump", "Vector ASC", "PCAP" };
+
+	for( U32 detail = 0; detail < 2; detail++ )
+	{
+		DeviceNetAnalyzer analyzer;
+		DeviceNetAnalyzerSettings* settings = (DeviceNetAnalyzerSettings*)analyzer.GetAnalyzerSettings();
+		FillSettings( settings, BitSampling_EdgeRuns, result_details[ detail ], Markers_StuffBitsAndErrors, 1 );
+		analyzer.SetSampleRate( TEST_SAMPLE_RATE );
+		Process( analyzer, capture, capture.mEdges.size() );
+
+		for( U32 export_type = Export_Csv; export_type <= Export_Pcap; export_type++ )
+		{
+			settings->mDecoderThreads = 1;
+			std::string expected = StripAscHeader( ReadExport( analyzer, export_type ) );
+			settings->mDecoderThreads = 4;
+			std::string text = StripAscHeader( ReadExport( analyzer, export_type ) );
+
+			std::string what = std::string( export_names[ export_type ] ) + ", detail " + std::to_string( detail );
+			Check( expected.empty() == false, "export threads", what + ": nothing written" );
+			Check( text == expected, "export threads", what + ": 4 threads wrote something else" );
+		}
+	}
+}
+
+
+void TestExport()
+{
+	TestKnownCandump();
+
+	TestCapture capture;
+	GenerateCapture( 1.0, 400, 16, capture );
+	TestSimulatedCapture( capture );
+
+	printf( "export threads: known candump, %u export types\n", Export_Pcap + 1 );
+}
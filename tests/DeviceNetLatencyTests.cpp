@@ -0,0 +1,158 @@
+//DeviceNetLatencyHistogram's buckets and percentiles for known latencies, and the connection tracker timing poll
+//commands and explicit requests (TimeMessage) fed to it as compact messages.
+
+#include "DeviceNetTests.h"
+#include "DeviceNetCip.h"
+#include "DeviceNetConnectionTracker.h"
+#include "DeviceNetLatency.h"
+
+#include <cstdio>
+#include <random>
+
+//the buckets are the histogram's own business, but they set its resolution.
+class BucketedHistogram : public DeviceNetLatencyHistogram
+{
+public:
+	using DeviceNetLatencyHistogram::GetBucket;
+	using DeviceNetLatencyHistogram::GetBucketMax;
+};
+
+//the tracker's records go nowhere; it's the times it takes that count here.
+class LatencySink : public DeviceNetDecoderListener
+{
+public:
+	virtual void OnRecord( const DeviceNetRecord& /*record*/ ) {}
+	virtual void OnMarker( U64 /*sample*/, DeviceNetMarkerType /*type*/ ) {}
+};
+
+static void CheckValue( U64 value, U64 expected, const std::string& what )
+{
+	Check( value == expected, "latency", what + ": " + std::to_string( value ) + " instead of " + std::to_string( expected ) );
+}
+
+static void TestBuckets()
+{
+	//a bucket per value below 2 * LATENCY_SUB_BUCKETS
+	for( U32 samples = 0; samples < 2 * LATENCY_SUB_BUCKETS; samples++ )
+	{
+		CheckValue( BucketedHistogram::GetBucket( samples ), samples, "bucket of " + std::to_string( samples ) );
+		CheckValue( BucketedHistogram::GetBucketMax( samples ), samples, "top of bucket " + std::to_string( samples ) );
+	}
+
+	//then two values a bucket, four, ...
+	CheckValue( BucketedHistogram::GetBucket( 64 ), 64, "bucket of 64" );
+	CheckValue( BucketedHistogram::GetBucket( 65 ), 64, "bucket of 65" );
+	CheckValue( BucketedHistogram::GetBucketMax( 64 ), 65, "top of bucket 64" );
+	CheckValue( BucketedHistogram::GetBucket( 127 ), 95, "bucket of 127" );
+	CheckValue( BucketedHistogram::GetBucketMax( 95 ), 127, "top of bucket 95" );
+	CheckValue( BucketedHistogram::GetBucket( 128 ), 96, "bucket of 128" );
+	CheckValue( BucketedHistogram::GetBucketMax( 96 ), 131, "top of bucket 96" );
+
+	//the last bucket takes everything from 2^LATENCY_MAX_BITS on
+	U64 top = ( 1ull << LATENCY_MAX_BITS ) - 1;
+	CheckValue( BucketedHistogram::GetBucket( top ), LATENCY_NUM_BUCKETS - 1, "bucket of 2^36 - 1" );
+	CheckValue( BucketedHistogram::GetBucketMax( LATENCY_NUM_BUCKETS - 1 ), top, "top of the last bucket" );
+	CheckValue( BucketedHistogram::GetBucket( top + 1 ), LATENCY_NUM_BUCKETS - 1, "bucket of 2^36" );
+	CheckValue( BucketedHistogram::GetBucket( 1ull << 50 ), LATENCY_NUM_BUCKETS - 1, "bucket of 2^50" );
+
+	//and no bucket is wider than 1/32 of the values in it
+	std::mt19937_64 random( 21 );
+	for( U32 i = 0; i < 100000; i++ )
+	{
+		U64 samples = random() >> ( random() % 64 );
+		if( samples > top )
+			continue;
+
+		U32 bucket = BucketedHistogram::GetBucket( samples );
+		U64 bucket_max = BucketedHistogram::GetBucketMax( bucket );
+		bool fits = ( bucket_max >= samples ) && ( ( bucket_max - samples ) <= samples / LATENCY_SUB_BUCKETS ) &&
+					( ( bucket == 0 ) || ( BucketedHistogram::GetBucketMax( bucket - 1 ) < samples ) );
+		if( Check( fits, "latency", "bucket of " + std::to_string( samples ) ) == false )
+			break;
+	}
+}
+
+static void TestPercentiles()
+{
+	DeviceNetLatencyHistogram histogram;
+	CheckValue( histogram.GetPercentile( 50.0 ), 0, "empty p50" );
+
+	//1 to 100 samples: exact up to 63, then buckets of two
+	for( U64 samples = 1; samples <= 100; samples++ )
+		histogram.Add( samples );
+	CheckValue( histogram.GetCount(), 100, "count of 1..100" );
+	CheckValue( histogram.GetPercentile( 50.0 ), 50, "p50 of 1..100" );
+	CheckValue( histogram.GetPercentile( 63.0 ), 63, "p63 of 1..100" );
+	CheckValue( histogram.GetPercentile( 64.0 ), 65, "p64 of 1..100" );		//64 and 65 share a bucket
+	CheckValue( histogram.GetPercentile( 99.0 ), 99, "p99 of 1..100" );
+	CheckValue( histogram.GetPercentile( 100.0 ), 100, "p100 of 1..100" );		//the bucket goes to 101, the maximum doesn't
+	CheckValue( histogram.GetMax(), 100, "max of 1..100" );
+
+	//1000 times 10000 samples (bucket 10000..10239), 10 times 1000000 (bucket 999424..1015807)
+	histogram.Clear();
+	for( U32 i = 0; i < 1000; i++ )
+		histogram.Add( 10000 );
+	for( U32 i = 0; i < 10; i++ )
+		histogram.Add( 1000000 );
+	CheckValue( histogram.GetCount(), 1010, "count" );
+	CheckValue( histogram.GetPercentile( 50.0 ), 10239, "p50" );
+	CheckValue( histogram.GetPercentile( 99.0 ), 10239, "p99" );
+	CheckValue( histogram.GetPercentile( 99.5 ), 1000000, "p99.5" );
+	CheckValue( histogram.GetMax(), 1000000, "max" );
+
+	//past 2^LATENCY_MAX_BITS: the percentiles stop at the last bucket, the maximum is exact
+	histogram.Clear();
+	histogram.Add( 1ull << 40 );
+	CheckValue( histogram.GetPercentile( 99.0 ), ( 1ull << LATENCY_MAX_BITS ) - 1, "p99 of 2^40" );
+	CheckValue( histogram.GetMax(), 1ull << 40, "max of 2^40" );
+}
+
+static void TestTimeMessages()
+{
+	DeviceNetLatencyStats stats;
+	LatencySink sink;
+	DeviceNetConnectionTracker tracker;
+	tracker.Start( &stats, &sink );
+
+	//poll commands to MAC ID 5 and its responses, from start of frame to start of frame; the second command isn't
+	//answered before the third
+	std::vector<U8> data = { 0x12, 0x34 };
+	U32 poll_command = BITS_MESSAGE_GROUP_2 | ( 5 << SHIFT_MAC_ID ) | 5;
+	U32 poll_response = BITS_MESSAGE_GROUP_1 | ( 0xF << SHIFT_GROUP_1_MESSAGE_ID ) | 5;
+	SendMessage( &tracker, 1000, poll_command, data );
+	SendMessage( &tracker, 5200, poll_response, data );
+	SendMessage( &tracker, 10000, poll_command, data );
+	SendMessage( &tracker, 20000, poll_command, data );
+	SendMessage( &tracker, 23000, poll_response, data );
+	SendMessage( &tracker, 40000, poll_response, data );	//answers nothing
+
+	DeviceNetLatencyHistogram& poll = stats.GetHistogram( 5, PollLatency );
+	CheckValue( poll.GetCount(), 2, "poll count" );
+	CheckValue( poll.GetPercentile( 50.0 ), 3007, "poll p50" );		//3000 is in bucket 2944..3007
+	CheckValue( poll.GetMax(), 4200, "poll max" );
+	CheckValue( stats.GetNumUnanswered( 5, PollLatency ), 1, "unanswered polls" );
+
+	//an unconnected request from MAC ID 2 to MAC ID 9 in Group 3, from the requester with the responder in the
+	//header, and the response the other way round; a response to someone else doesn't end it
+	U32 request = BITS_MESSAGE_GROUP_3 | ( CHECK_GROUP_3_MSG_ID_IS_EXPLICIT_REQUEST << SHIFT_GROUP_3_MESSAGE_ID ) | 2;
+	U32 response = BITS_MESSAGE_GROUP_3 | ( CHECK_GROUP_3_MSG_ID_IS_EXPLICIT_RESPONSE << SHIFT_GROUP_3_MESSAGE_ID ) | 9;
+	SendMessage( &tracker, 100000, request, { 9, CIP_SERVICE_GET_ATTRIBUTE_SINGLE, 1, 1, 7 } );
+	SendMessage( &tracker, 104000, response, { 3, CIP_SERVICE_GET_ATTRIBUTE_SINGLE | CIP_SERVICE_RESPONSE, 0x2A } );
+	SendMessage( &tracker, 108000, response, { 2, CIP_SERVICE_GET_ATTRIBUTE_SINGLE | CIP_SERVICE_RESPONSE, 0x2A } );
+
+	DeviceNetLatencyHistogram& explicit_latency = stats.GetHistogram( 9, ExplicitLatency );
+	CheckValue( explicit_latency.GetCount(), 1, "explicit count" );
+	CheckValue( explicit_latency.GetMax(), 8000, "explicit latency" );
+	CheckValue( explicit_latency.GetPercentile( 50.0 ), 8000, "explicit p50" );		//not the bucket's 8063
+	CheckValue( stats.GetNumUnanswered( 9, ExplicitLatency ), 0, "unanswered explicit requests" );
+	CheckValue( stats.GetHistogram( 2, ExplicitLatency ).GetCount(), 0, "explicit count of the requester" );
+}
+
+void TestLatency()
+{
+	TestBuckets();
+	TestPercentiles();
+	TestTimeMessages();
+
+	printf( "latency: buckets, percentiles, poll and explicit timing\n" );
+}
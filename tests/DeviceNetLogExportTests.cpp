@@ -0,0 +1,92 @@
+//The CAN logs other tools read, written out for a standard, an extended and two remote frames at known times: the
+//candump lines, the Vector ASC header and lines, and the PCAP global header and SocketCAN records, byte for byte.
+
+#include "DeviceNetTests.h"
+#include "DeviceNetAnalyzerResults.h"
+
+#include <cstdio>
+
+//a frame's start bit at a whole number of bits into the capture.
+static void AddCanFrameAt( TestCapture& capture, U64 start_of_frame, U32 identifier, const std::vector<U8>& data, U32 flags )
+{
+	AddIdle( capture, U32( ( start_of_frame - capture.mNumSamples ) / TEST_SAMPLES_PER_BIT ) );
+	AddCanFrame( capture, identifier, data, flags );
+}
+
+static void CheckLog( const std::string& text, const std::string& expected, const std::string& what )
+{
+	if( text == expected )
+		return;
+
+	size_t i = 0;
+	while( ( i < text.size() ) && ( i < expected.size() ) && ( text[ i ] == expected[ i ] ) )
+		i++;
+	Check( false, "log export", what + ": differs at byte " + std::to_string( i ) );
+}
+
+static std::string Bytes( const std::vector<U8>& bytes )
+{
+	return std::string( bytes.begin(), bytes.end() );
+}
+
+void TestLogExport()
+{
+	//1 ms, 2 ms, 3.5 ms and 4 ms in; the remote frames ask for 4 bytes and none
+	TestCapture capture;
+	StartCapture( capture );
+	AddCanFrameAt( capture, TEST_SAMPLE_RATE / 1000, 0x32F, { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07 }, ACK_RECEIVED );
+	AddCanFrameAt( capture, TEST_SAMPLE_RATE / 500, 0x1ABCDE12, { 0xDE, 0xAD }, EXTENDED_IDENTIFIER | ACK_RECEIVED );
+	AddCanFrameAt( capture, TEST_SAMPLE_RATE * 7 / 2000, 0x123, { 0, 0, 0, 0 }, REMOTE_FRAME | ACK_RECEIVED );
+	AddCanFrameAt( capture, TEST_SAMPLE_RATE / 250, 0xABC, {}, EXTENDED_IDENTIFIER | REMOTE_FRAME | ACK_RECEIVED );
+	AddIdle( capture, 20 );
+
+	//compact results: in field results, a message's time is where its identifier starts
+	DeviceNetAnalyzer analyzer;
+	FillSettings( (DeviceNetAnalyzerSettings*)analyzer.GetAnalyzerSettings(), BitSampling_EdgeRuns, Results_Compact, Markers_StuffBitsAndErrors, 1 );
+	analyzer.SetSampleRate( TEST_SAMPLE_RATE );
+	Process( analyzer, capture, capture.mEdges.size() );
+
+	CheckLog( ReadExport( analyzer, Export_Candump ),
+		"(0000000000.001000) can0 32F#0001020304050607\n"
+		"(0000000000.002000) can0 1ABCDE12#DEAD\n"
+		"(0000000000.003500) can0 123#R4\n"
+		"(0000000000.004000) can0 00000ABC#R\n", "candump" );
+
+	//the ASC header has the time of the export in it, twice
+	std::string asc = ReadExport( analyzer, Export_VectorAsc );
+	std::string date = asc.substr( 0, asc.find( '\n' ) );
+	Check( date.compare( 0, 5, "date " ) == 0, "log export", "ASC: no date line" );
+	date = date.substr( 5 );
+	CheckLog( asc,
+		"date " + date + "\n"
+		"base hex  timestamps absolute\n"
+		"no internal events logged\n"
+		"Begin Triggerblock " + date + "\n"
+		"   0.000000 Start of measurement\n"
+		"   0.001000 1  32F             Rx   d 8 00 01 02 03 04 05 06 07\n"
+		"   0.002000 1  1ABCDE12x       Rx   d 2 DE AD\n"
+		"   0.003500 1  123             Rx   r 4\n"
+		"   0.004000 1  ABCx            Rx   r 0\n"
+		"End TriggerBlock\n", "ASC" );
+
+	//nanosecond PCAP for LINKTYPE_CAN_SOCKETCAN, little endian but for the CAN ID; each record is a 16 byte
+	//struct can_frame with the EFF and RTR flags in the ID, the length, 3 bytes padding and reserved, and 8 data bytes
+	std::string pcap = Bytes( {
+		0x4D, 0x3C, 0xB2, 0xA1, 0x02, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0xFF, 0xFF, 0x00, 0x00, 0xE3, 0x00, 0x00, 0x00 } );
+	pcap += Bytes( {
+		0x00, 0x00, 0x00, 0x00, 0x40, 0x42, 0x0F, 0x00, 0x10, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x03, 0x2F, 0x08, 0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07 } );
+	pcap += Bytes( {
+		0x00, 0x00, 0x00, 0x00, 0x80, 0x84, 0x1E, 0x00, 0x10, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00,
+		0x9A, 0xBC, 0xDE, 0x12, 0x02, 0x00, 0x00, 0x00, 0xDE, 0xAD, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } );
+	pcap += Bytes( {
+		0x00, 0x00, 0x00, 0x00, 0xE0, 0x67, 0x35, 0x00, 0x10, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00,
+		0x40, 0x00, 0x01, 0x23, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } );
+	pcap += Bytes( {
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x09, 0x3D, 0x00, 0x10, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00,
+		0xC0, 0x00, 0x0A, 0xBC, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } );
+	CheckLog( ReadExport( analyzer, Export_Pcap ), pcap, "PCAP" );
+
+	printf( "log export: candump, ASC and PCAP of known frames\n" );
+}
@@ -0,0 +1,103 @@
+//DeviceNetParallelDecoder: a capture of known frames long enough for more than one window has to decode to
+//exactly those frames on 4 threads, and the analyzer's results on a long simulated capture with glitches in it have
+//to be the same with 1 decoder thread as with 2 and 4, for both result details and bit samplings.
+
+#include "DeviceNetTests.h"
+#include "DeviceNetParallelDecoder.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+
+static void TestKnownFrames()
+{
+	//random standard and extended identifiers and data, more edges than a window holds
+	std::mt19937 random( 15 );
+	TestCapture capture;
+	StartCapture( capture );
+
+	std::vector<U64> expected;	//start of frame, identifier, DLC and data, four entries each
+	while( capture.mEdges.size() < PARALLEL_WINDOW_EDGES + PARALLEL_WINDOW_EDGES / 2 )
+	{
+		U32 flags = ( ( random() % 8 ) == 0 ) ? ( EXTENDED_IDENTIFIER | ACK_RECEIVED ) : ACK_RECEIVED;
+		U32 identifier = random() & ( ( ( flags & EXTENDED_IDENTIFIER ) != 0 ) ? COMPACT_IDENTIFIER_MASK : ( NUM_IDENTIFIERS - 1 ) );
+		std::vector<U8> data( random() % 9 );
+		U64 data_bits = 0;
+		for( U32 i = 0; i < data.size(); i++ )
+		{
+			data[ i ] = U8( random() );
+			data_bits |= U64( data[ i ] ) << ( 56 - 8 * i );
+		}
+
+		expected.push_back( AddCanFrame( capture, identifier, data, flags ) );
+		expected.push_back( identifier );
+		expected.push_back( data.size() );
+		expected.push_back( data_bits );
+		AddIdle( capture, random() % 20 );
+	}
+	AddIdle( capture, 20 );
+
+	TestResults results;
+	Decode( capture, BitSampling_EdgeRuns, Results_Compact, Markers_StuffBitsAndErrors, 4, results );
+
+	std::vector<U64> messages;
+	for( U32 i = 0; i < results.mFrames.size(); i++ )
+	{
+		const Frame& frame = results.mFrames[ i ];
+		if( frame.mType != CanMessage )
+			continue;
+
+		messages.push_back( frame.mStartingSampleInclusive );
+		messages.push_back( frame.mData1 & COMPACT_IDENTIFIER_MASK );
+		messages.push_back( ( frame.mData1 >> COMPACT_DLC_SHIFT ) & COMPACT_DLC_MASK );
+		messages.push_back( frame.mData2 );
+	}
+
+	Check( messages.size() == expected.size(), "decoder threads", std::to_string( messages.size() / 4 ) + " messages instead of " + std::to_string( expected.size() / 4 ) );
+	for( U32 i = 0; ( i < messages.size() ) && ( i < expected.size() ); i += 4 )
+	{
+		bool same = std::equal( expected.begin() + i, expected.begin() + i + 4, messages.begin() + i );
+		if( Check( same, "decoder threads", "known frame " + std::to_string( i / 4 ) + " differs" ) == false )
+			break;
+	}
+}
+
+static void TestGlitchedCapture( const TestCapture& capture )
+{
+	static const ResultDetail result_details[] = { Results_Fields, Results_Compact };
+	static const BitSampling bit_samplings[] = { BitSampling_EdgeRuns, BitSampling_SamplePoints };
+	static const U32 decoder_threads[] = { 2, 4 };
+
+	for( U32 detail = 0; detail < 2; detail++ )
+	{
+		for( U32 sampling = 0; sampling < 2; sampling++ )
+		{
+			TestResults expected;
+			Decode( capture, bit_samplings[ sampling ], result_details[ detail ], Markers_StuffBitsAndErrors, 1, expected );
+
+			for( U32 threads = 0; threads < 2; threads++ )
+			{
+				TestResults results;
+				Decode( capture, bit_samplings[ sampling ], result_details[ detail ], Markers_StuffBitsAndErrors, decoder_threads[ threads ], results );
+
+				std::string what = std::to_string( decoder_threads[ threads ] ) + " threads, detail " + std::to_string( detail ) + ", sampling " + std::to_string( sampling );
+				std::string difference = CompareResults( expected, results );
+				Check( difference.empty(), "decoder threads", what + ": " + difference );
+			}
+		}
+	}
+
+}
+
+
+void TestParallelDecoder()
+{
+	TestKnownFrames();
+
+	//long enough for two parallel decoder windows
+	TestCapture capture;
+	GenerateCapture( 8.0, 2000, 15, capture );
+	TestGlitchedCapture( capture );
+
+	printf( "decoder threads: known frames, %llu edges with glitches\n", (unsigned long long)capture.mEdges.size() );
+}
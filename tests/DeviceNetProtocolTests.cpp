@@ -0,0 +1,170 @@
+//DeviceNetProtocol's identifier table: a few identifiers from each message group worked out by hand, then
+//DecomposeArbitrationField for all 4096 arbitration fields against the range compares it replaced (on a fresh object
+//per field).
+
+#include "DeviceNetTests.h"
+
+#include <cstdio>
+
+struct KnownIdentifier
+{
+	U32 mIdentifier;
+	IdentifierType mGroup;
+	U32 mMessageID;
+	U32 mMacID;
+	DeviceNetMessageKind mKind;
+};
+
+static void TestKnownIdentifiers()
+{
+	static const KnownIdentifier known[] =
+	{
+		{ 0x000, MessageGroup1, 0, 0, OrdinaryMessage },
+		{ 0x3C5, MessageGroup1, 15, 5, OrdinaryMessage },				//poll response from MAC ID 5
+		{ 0x40D, MessageGroup2, 5, 1, OrdinaryMessage },				//poll command to MAC ID 1
+		{ 0x5FE, MessageGroup2, 6, 63, ConnectionManagementMessage },
+		{ 0x40F, MessageGroup2, 7, 1, DuplicateMacIdCheckMessage },
+		{ 0x76A, MessageGroup3, 5, 42, UnconnectedExplicitResponse },
+		{ 0x7AA, MessageGroup3, 6, 42, UnconnectedExplicitRequest },
+		{ 0x7BF, MessageGroup3, 6, 63, UnconnectedExplicitRequest },		//the last one in Group 3
+		{ 0x7C5, MessageGroup4, 5, 0, ReservedGroup4Message },
+		{ 0x7EC, MessageGroup4, 44, 0, CommunicationFaultedResponse },
+		{ 0x7EF, MessageGroup4, 47, 0, OfflineOwnershipRequest },
+		{ 0x7F3, InvalidCanIdentifiers, 0, 0, OrdinaryMessage },
+	};
+
+	DeviceNetProtocol protocol;
+	for( U32 i = 0; i < sizeof( known ) / sizeof( known[ 0 ] ); i++ )
+	{
+		const KnownIdentifier& k = known[ i ];
+		U32 identifier_class = DeviceNetProtocol::ClassifyIdentifier( k.mIdentifier );
+		bool same = ( DeviceNetProtocol::GetIdentifierGroup( identifier_class ) == k.mGroup ) &&
+					( DeviceNetProtocol::GetIdentifierMessageID( identifier_class ) == k.mMessageID ) &&
+					( DeviceNetProtocol::GetIdentifierMacID( identifier_class ) == k.mMacID ) &&
+					( DeviceNetProtocol::GetIdentifierMessageKind( identifier_class ) == k.mKind );
+		Check( same, "identifier table", "identifier " + std::to_string( k.mIdentifier ) );
+
+		//and the members the decoder reads, with a recessive RTR bit
+		protocol.DecomposeArbitrationField( ( k.mIdentifier << 1 ) | 1 );
+		bool group = ( protocol.mMessageGroup1 == ( k.mGroup == MessageGroup1 ) ) && ( protocol.mMessageGroup2 == ( k.mGroup == MessageGroup2 ) ) &&
+					 ( protocol.mMessageGroup3 == ( k.mGroup == MessageGroup3 ) ) && ( protocol.mMessageGroup4 == ( k.mGroup == MessageGroup4 ) ) &&
+					 ( protocol.mInvalidCanIdentifiers == ( k.mGroup == InvalidCanIdentifiers ) );
+		bool ids = ( k.mGroup != MessageGroup1 ) || ( ( protocol.mGroup1MessageID == k.mMessageID ) && ( protocol.mSourceMacID_MG1 == k.mMacID ) );
+		ids = ids && ( ( k.mGroup != MessageGroup2 ) || ( ( protocol.mGroup2MessageID == k.mMessageID ) && ( protocol.mMacID == k.mMacID ) ) );
+		ids = ids && ( ( k.mGroup != MessageGroup3 ) || ( ( protocol.mGroup3MessageID == k.mMessageID ) && ( protocol.mSourceMacID_MG3 == k.mMacID ) ) );
+		ids = ids && ( ( k.mGroup != MessageGroup4 ) || ( protocol.mGroup4MessageID == k.mMessageID ) );
+		bool specials = ( protocol.mReservedMacIdConnectionManagement == ( k.mKind == ConnectionManagementMessage ) ) &&
+						( protocol.mDuplicateMacIdCheckMessage == ( k.mKind == DuplicateMacIdCheckMessage ) ) &&
+						( protocol.mExplicitResponseMessage == ( k.mKind == UnconnectedExplicitResponse ) ) &&
+						( protocol.mExplicitRequestMessage == ( k.mKind == UnconnectedExplicitRequest ) ) &&
+						( protocol.mReservedGroup4MsgID == ( k.mKind == ReservedGroup4Message ) ) &&
+						( protocol.mCommunicationFaultedResponseMessage == ( k.mKind == CommunicationFaultedResponse ) ) &&
+						( protocol.mOfflineOwnershipRequestMessage == ( k.mKind == OfflineOwnershipRequest ) );
+		bool fields = ( protocol.mArbitrationFieldIdentifierBits == k.mIdentifier ) && ( protocol.mArbitrationFieldRtrBit == 1 ) && ( protocol.mRtrBitError == true );
+		Check( group && ids && specials && fields, "identifier table", "arbitration field of identifier " + std::to_string( k.mIdentifier ) );
+	}
+}
+
+//the range compares DecomposeArbitrationField had before the table, on a fresh object every time.
+class ReferenceProtocol : public DeviceNetProtocol
+{
+public:
+	void DecomposeArbitrationFieldByRanges( U32 arbitration_field )
+	{
+		mArbitrationFieldIdentifierBits = ( ( arbitration_field & 0x00000FFE ) >> 1 );
+		mArbitrationFieldRtrBit = ( ( arbitration_field & 0x00000001 ) >> 0 );
+
+		if( mArbitrationFieldIdentifierBits < START_ADDR_MESSAGE_GROUP_2 )
+		{
+			mMessageGroup1 = true;
+			mGroup1MessageID = ( ( mArbitrationFieldIdentifierBits & MASK_GROUP_1_MESSAGE_ID ) >> SHIFT_GROUP_1_MESSAGE_ID );
+			mSourceMacID_MG1 = ( ( mArbitrationFieldIdentifierBits & MASK_SOURCE_MAC_ID ) >> SHIFT_SOURCE_MAC_ID );
+		}
+		else if( ( mArbitrationFieldIdentifierBits >= START_ADDR_MESSAGE_GROUP_2 ) && ( mArbitrationFieldIdentifierBits < START_ADDR_MESSAGE_GROUP_3 ) )
+		{
+			mMessageGroup2 = true;
+			mMacID = ( ( mArbitrationFieldIdentifierBits & MASK_MAC_ID ) >> SHIFT_MAC_ID );
+			mGroup2MessageID = ( ( mArbitrationFieldIdentifierBits & MASK_GROUP_2_MESSAGE_ID ) >> SHIFT_GROUP_2_MESSAGE_ID );
+			mReservedMacIdConnectionManagement = ( mGroup2MessageID == CHECK_GROUP_2_MSG_ID_IS_CONNECTION_MANAGEMENT );
+			mDuplicateMacIdCheckMessage = ( mGroup2MessageID == CHECK_GROUP_2_MSG_ID_IS_CHECK_MESSAGE );
+		}
+		else if( ( mArbitrationFieldIdentifierBits >= START_ADDR_MESSAGE_GROUP_3 ) && ( mArbitrationFieldIdentifierBits < START_ADDR_MESSAGE_GROUP_4 ) )
+		{
+			mMessageGroup3 = true;
+			mGroup3MessageID = ( ( mArbitrationFieldIdentifierBits & MASK_GROUP_3_MESSAGE_ID ) >> SHIFT_GROUP_3_MESSAGE_ID );
+			mExplicitResponseMessage = ( mGroup3MessageID == CHECK_GROUP_3_MSG_ID_IS_EXPLICIT_RESPONSE );
+			mExplicitRequestMessage = ( mGroup3MessageID == CHECK_GROUP_3_MSG_ID_IS_EXPLICIT_REQUEST );
+			mReservedGroup3MsgID = ( mGroup3MessageID == CHECK_GROUP_3_MSG_ID_IS_RESERVED );
+			mSourceMacID_MG3 = ( ( mArbitrationFieldIdentifierBits & MASK_SOURCE_MAC_ID ) >> SHIFT_SOURCE_MAC_ID );
+		}
+		else if( ( mArbitrationFieldIdentifierBits >= START_ADDR_MESSAGE_GROUP_4 ) && ( mArbitrationFieldIdentifierBits < START_ADDR_INVALID_CAN_IDS ) )
+		{
+			mMessageGroup4 = true;
+			mGroup4MessageID = ( ( mArbitrationFieldIdentifierBits & MASK_GROUP_4_MESSAGE_ID ) >> SHIFT_GROUP_4_MESSAGE_ID );
+
+			if( mGroup4MessageID == CHECK_GROUP_4_MSG_ID_IS_COM_FAULTED_RESPONSE )
+				mCommunicationFaultedResponseMessage = true;
+			else if( mGroup4MessageID == CHECK_GROUP_4_MSG_ID_IS_COM_FAULTED_REQUEST )
+				mCommunicationFaultedRequestMessage = true;
+			else if( mGroup4MessageID == CHECK_GROUP_4_MSG_ID_IS_OFFLINE_OWNERSHIP_RESPONSE )
+				mOfflineOwnershipResponseMessage = true;
+			else if( mGroup4MessageID == CHECK_GROUP_4_MSG_ID_IS_OFFLINE_OWNERSHIP_REQUEST )
+				mOfflineOwnershipRequestMessage = true;
+			else
+				mReservedGroup4MsgID = true;
+		}
+		else if( ( mArbitrationFieldIdentifierBits >= START_ADDR_INVALID_CAN_IDS ) && ( mArbitrationFieldIdentifierBits < START_ADDR_INVALID_IDENTIFIER ) )
+		{
+			mInvalidCanIdentifiers = true;
+		}
+		else
+		{
+			mIdentifierError = true;
+		}
+
+		mRtrBitError = ( mArbitrationFieldRtrBit != BIT_RTR );
+	}
+};
+
+static void TestRangeCompares()
+{
+	//one object for all of them, the way the decoder uses it
+	DeviceNetProtocol protocol;
+
+	for( U32 arbitration_field = 0; arbitration_field < 2 * NUM_IDENTIFIERS; arbitration_field++ )
+	{
+		ReferenceProtocol reference;
+		reference.DecomposeArbitrationFieldByRanges( arbitration_field );
+		protocol.DecomposeArbitrationField( arbitration_field );
+
+		const DeviceNetProtocol& a = reference;
+		const DeviceNetProtocol& b = protocol;
+		bool same = ( a.mMessageGroup1 == b.mMessageGroup1 ) && ( a.mMessageGroup2 == b.mMessageGroup2 ) && ( a.mMessageGroup3 == b.mMessageGroup3 ) &&
+					( a.mMessageGroup4 == b.mMessageGroup4 ) && ( a.mInvalidCanIdentifiers == b.mInvalidCanIdentifiers ) &&
+					( a.mGroup1MessageID == b.mGroup1MessageID ) && ( a.mSourceMacID_MG1 == b.mSourceMacID_MG1 ) && ( a.mMacID == b.mMacID ) &&
+					( a.mGroup2MessageID == b.mGroup2MessageID ) && ( a.mGroup3MessageID == b.mGroup3MessageID ) &&
+					( a.mSourceMacID_MG3 == b.mSourceMacID_MG3 ) && ( a.mGroup4MessageID == b.mGroup4MessageID ) &&
+					( a.mIdentifierError == b.mIdentifierError ) && ( a.mRtrBitError == b.mRtrBitError ) &&
+					( a.mReservedMacIdConnectionManagement == b.mReservedMacIdConnectionManagement ) &&
+					( a.mDuplicateMacIdCheckMessage == b.mDuplicateMacIdCheckMessage ) &&
+					( a.mExplicitResponseMessage == b.mExplicitResponseMessage ) && ( a.mExplicitRequestMessage == b.mExplicitRequestMessage ) &&
+					( a.mReservedGroup3MsgID == b.mReservedGroup3MsgID ) && ( a.mReservedGroup4MsgID == b.mReservedGroup4MsgID ) &&
+					( a.mCommunicationFaultedResponseMessage == b.mCommunicationFaultedResponseMessage ) &&
+					( a.mCommunicationFaultedRequestMessage == b.mCommunicationFaultedRequestMessage ) &&
+					( a.mOfflineOwnershipResponseMessage == b.mOfflineOwnershipResponseMessage ) &&
+					( a.mOfflineOwnershipRequestMessage == b.mOfflineOwnershipRequestMessage ) &&
+					( a.mArbitrationFieldIdentifierBits == b.mArbitrationFieldIdentifierBits ) && ( a.mArbitrationFieldRtrBit == b.mArbitrationFieldRtrBit );
+
+		if( Check( same, "identifier table", "arbitration field " + std::to_string( arbitration_field ) ) == false )
+			return;
+	}
+}
+
+
+void TestIdentifierTable()
+{
+	TestKnownIdentifiers();
+	TestRangeCompares();
+
+	printf( "identifier table: known identifiers, %u arbitration fields\n", 2 * NUM_IDENTIFIERS );
+}
@@ -0,0 +1,212 @@
+//DeviceNetReassembler: fragment sequences fed in as compact messages, and the one ReassembledMessage record that has
+//to come out of each (or none) -- its identifier, header MAC ID, fragment and acknowledgement counts, warning flag
+//and payload.
+
+#include "DeviceNetTests.h"
+#include "DeviceNetReassembler.h"
+
+#include <cstdio>
+
+#define MASTER_MAC_ID			0
+#define SLAVE_MAC_ID			5
+#define EXPLICIT_REQUEST_ID		( BITS_MESSAGE_GROUP_2 | ( SLAVE_MAC_ID << SHIFT_MAC_ID ) | 4 )		//master to slave
+#define EXPLICIT_RESPONSE_ID	( BITS_MESSAGE_GROUP_2 | ( SLAVE_MAC_ID << SHIFT_MAC_ID ) | 3 )		//slave to master
+#define POLL_RESPONSE_ID		( BITS_MESSAGE_GROUP_1 | ( 15 << SHIFT_GROUP_1_MESSAGE_ID ) | SLAVE_MAC_ID )
+
+class ReassembledMessages : public DeviceNetDecoderListener
+{
+public:
+	virtual void OnRecord( const DeviceNetRecord& record )
+	{
+		if( record.mType == ReassembledMessage )
+			mMessages.push_back( record );
+	}
+
+	virtual void OnMarker( U64 /*sample*/, DeviceNetMarkerType /*type*/ ) {}
+
+	std::vector<DeviceNetRecord> mMessages;
+};
+
+class FragmentSender
+{
+public:
+	FragmentSender()
+	:	mSample( 0 )
+	{
+		mReassembler.Start( Reassembly_ExplicitAndIO, TEST_SAMPLE_RATE, TEST_BIT_RATE, &mPayloads, &mMessages );
+	}
+
+	void Send( U32 identifier, const std::vector<U8>& data )
+	{
+		mSample = SendMessage( &mReassembler, mSample, identifier, data ) + 20 * TEST_SAMPLES_PER_BIT;
+	}
+
+	//an explicit fragment from the master: the message header, the fragmentation byte and the data
+	void SendRequestFragment( U32 type, U32 count, const std::vector<U8>& data )
+	{
+		std::vector<U8> frame( 1, U8( EXPLICIT_HEADER_FRAG | MASTER_MAC_ID ) );
+		frame.push_back( U8( ( type << FRAGMENT_TYPE_SHIFT ) | count ) );
+		frame.insert( frame.end(), data.begin(), data.end() );
+		Send( EXPLICIT_REQUEST_ID, frame );
+	}
+
+	void SendAck( U32 count, U8 status )
+	{
+		std::vector<U8> frame( 1, U8( EXPLICIT_HEADER_FRAG | MASTER_MAC_ID ) );
+		frame.push_back( U8( ( FRAGMENT_TYPE_ACK << FRAGMENT_TYPE_SHIFT ) | count ) );
+		frame.push_back( status );
+		Send( EXPLICIT_RESPONSE_ID, frame );
+	}
+
+	//an I/O fragment: the fragmentation byte, then the data
+	void SendIOFragment( U32 type, U32 count, const std::vector<U8>& data )
+	{
+		std::vector<U8> frame( 1, U8( ( type << FRAGMENT_TYPE_SHIFT ) | count ) );
+		frame.insert( frame.end(), data.begin(), data.end() );
+		Send( POLL_RESPONSE_ID, frame );
+	}
+
+	DeviceNetPayloadArena mPayloads;
+	ReassembledMessages mMessages;
+	DeviceNetReassembler mReassembler;
+	U64 mSample;
+};
+
+static std::vector<U8> Bytes( U8 first, U32 num_bytes )
+{
+	std::vector<U8> bytes;
+	for( U32 i = 0; i < num_bytes; i++ )
+		bytes.push_back( U8( first + i ) );
+
+	return bytes;
+}
+
+static void CheckMessage( FragmentSender& sender, const char* what, U32 identifier, U32 header_mac_id, U32 num_fragments, U32 num_acks,
+	bool warning, bool explicit_message, const std::vector<U8>& payload )
+{
+	std::string test = std::string( "reassembler, " ) + what;
+	if( Check( sender.mMessages.mMessages.size() == 1, test.c_str(), std::to_string( sender.mMessages.mMessages.size() ) + " messages instead of 1" ) == false )
+		return;
+
+	const DeviceNetRecord& message = sender.mMessages.mMessages[ 0 ];
+	Check( ( message.mData1 & ( NUM_IDENTIFIERS - 1 ) ) == identifier, test.c_str(), "identifier" );
+	Check( ( ( message.mData1 >> REASSEMBLED_HEADER_MAC_ID_SHIFT ) & EXPLICIT_HEADER_MAC_ID_MASK ) == header_mac_id, test.c_str(), "header MAC ID" );
+	Check( ( ( message.mData1 >> REASSEMBLED_FRAGMENTS_SHIFT ) & REASSEMBLED_COUNT_MASK ) == num_fragments, test.c_str(), "fragment count" );
+	Check( ( ( message.mData1 >> REASSEMBLED_ACKS_SHIFT ) & REASSEMBLED_COUNT_MASK ) == num_acks, test.c_str(), "ack count" );
+	Check( ( ( message.mFlags & DISPLAY_AS_WARNING_FLAG ) != 0 ) == warning, test.c_str(), "warning flag" );
+	Check( ( ( message.mFlags & EXPLICIT_MESSAGE ) != 0 ) == explicit_message, test.c_str(), "explicit flag" );
+
+	U32 num_bytes = U32( message.mData2 & REASSEMBLED_LENGTH_MASK );
+	if( Check( num_bytes == payload.size(), test.c_str(), std::to_string( num_bytes ) + " payload bytes instead of " + std::to_string( payload.size() ) ) == false )
+		return;
+
+	const U8* bytes = sender.mPayloads.Get( message.mData2 >> REASSEMBLED_OFFSET_SHIFT );
+	Check( std::vector<U8>( bytes, bytes + num_bytes ) == payload, test.c_str(), "payload" );
+}
+
+static void CheckNoMessage( FragmentSender& sender, const char* what )
+{
+	Check( sender.mMessages.mMessages.empty(), ( std::string( "reassembler, " ) + what ).c_str(), "reported a message" );
+}
+
+static std::vector<U8> Join( const std::vector<U8>& a, const std::vector<U8>& b, const std::vector<U8>& c )
+{
+	std::vector<U8> joined = a;
+	joined.insert( joined.end(), b.begin(), b.end() );
+	joined.insert( joined.end(), c.begin(), c.end() );
+	return joined;
+}
+
+static void TestExplicitMessages()
+{
+	std::vector<U8> first = Bytes( 0x10, 6 );
+	std::vector<U8> middle = Bytes( 0x20, 6 );
+	std::vector<U8> last = Bytes( 0x30, 3 );
+	std::vector<U8> payload = Join( first, middle, last );
+
+	{
+		FragmentSender sender;
+		sender.SendRequestFragment( FRAGMENT_TYPE_FIRST, 0, first );
+		sender.SendAck( 0, 0 );
+		sender.SendRequestFragment( FRAGMENT_TYPE_MIDDLE, 1, middle );
+		sender.SendAck( 1, 0 );
+		sender.SendRequestFragment( FRAGMENT_TYPE_LAST, 2, last );
+		sender.SendAck( 2, 0 );
+		CheckMessage( sender, "first, middle and last", EXPLICIT_REQUEST_ID, MASTER_MAC_ID, 3, 2, false, true, payload );
+	}
+
+	{
+		FragmentSender sender;
+		sender.SendRequestFragment( FRAGMENT_TYPE_FIRST, 0, first );
+		sender.SendAck( 0, 0 );
+		sender.SendRequestFragment( FRAGMENT_TYPE_MIDDLE, 1, middle );
+		sender.SendRequestFragment( FRAGMENT_TYPE_LAST, 2, last );
+		CheckMessage( sender, "missing ack", EXPLICIT_REQUEST_ID, MASTER_MAC_ID, 3, 1, true, true, payload );
+	}
+
+	{
+		//the ack didn't come in time, so the middle fragment went out again; its ack counts once
+		FragmentSender sender;
+		sender.SendRequestFragment( FRAGMENT_TYPE_FIRST, 0, first );
+		sender.SendAck( 0, 0 );
+		sender.SendRequestFragment( FRAGMENT_TYPE_MIDDLE, 1, middle );
+		sender.SendRequestFragment( FRAGMENT_TYPE_MIDDLE, 1, middle );
+		sender.SendAck( 1, 0 );
+		sender.SendAck( 1, 0 );
+		sender.SendRequestFragment( FRAGMENT_TYPE_LAST, 2, last );
+		CheckMessage( sender, "retransmitted fragment", EXPLICIT_REQUEST_ID, MASTER_MAC_ID, 3, 2, false, true, payload );
+	}
+
+	{
+		FragmentSender sender;
+		sender.SendRequestFragment( FRAGMENT_TYPE_FIRST, 0, first );
+		sender.SendAck( 0, 0 );
+		sender.SendRequestFragment( FRAGMENT_TYPE_MIDDLE, 2, middle );
+		sender.SendAck( 2, 0 );
+		sender.SendRequestFragment( FRAGMENT_TYPE_LAST, 3, last );
+		CheckNoMessage( sender, "gap in the count" );
+	}
+
+	{
+		//"too much data": the receiver gives up on the message
+		FragmentSender sender;
+		sender.SendRequestFragment( FRAGMENT_TYPE_FIRST, 0, first );
+		sender.SendAck( 0, 1 );
+		sender.SendRequestFragment( FRAGMENT_TYPE_MIDDLE, 1, middle );
+		sender.SendRequestFragment( FRAGMENT_TYPE_LAST, 2, last );
+		CheckNoMessage( sender, "nonzero ack status" );
+	}
+}
+
+static void TestIOMessages()
+{
+	std::vector<U8> first = Bytes( 0x40, 7 );
+	std::vector<U8> middle = Bytes( 0x50, 7 );
+	std::vector<U8> last = Bytes( 0x60, 2 );
+
+	{
+		FragmentSender sender;
+		sender.SendIOFragment( FRAGMENT_TYPE_FIRST, 0, first );
+		sender.SendIOFragment( FRAGMENT_TYPE_MIDDLE, 1, middle );
+		sender.SendIOFragment( FRAGMENT_TYPE_LAST, 2, last );
+		CheckMessage( sender, "I/O first, middle and last", POLL_RESPONSE_ID, 0, 3, 0, false, false, Join( first, middle, last ) );
+	}
+
+	{
+		//8-byte poll responses that happen to start with 0x00 look like first fragments, but none is followed by
+		//the rest of a message: nothing to report
+		FragmentSender sender;
+		for( U32 i = 0; i < 4; i++ )
+			sender.SendIOFragment( FRAGMENT_TYPE_FIRST, 0, Bytes( U8( i ), 7 ) );
+		sender.Send( POLL_RESPONSE_ID, Bytes( 0x00, 4 ) );
+		CheckNoMessage( sender, "unfragmented I/O starting with 0x00" );
+	}
+}
+
+void TestReassembler()
+{
+	TestExplicitMessages();
+	TestIOMessages();
+
+	printf( "reassembler: explicit and I/O fragment sequences\n" );
+}
@@ -0,0 +1,343 @@
+#include "DeviceNetTests.h"
+#include "DeviceNetCrc.h"
+#include "DeviceNetSimulationDataGenerator.h"
+
+#include <AnalyzerChannelData.h>
+#include <SimulationChannelDescriptor.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+
+static U32 gNumFailures = 0;
+
+bool Check( bool passed, const char* test, const std::string& what )
+{
+	if( passed == false )
+	{
+		printf( "FAILED %s: %s\n", test, what.c_str() );
+		gNumFailures++;
+	}
+
+	return passed;
+}
+
+void GenerateCapture( double seconds, U32 num_glitches, U32 seed, TestCapture& capture )
+{
+	DeviceNetAnalyzerSettings settings;
+	settings.mDeviceNetChannel = Channel( 0, 0 );
+	settings.mBitRate = TEST_BIT_RATE;
+
+	DeviceNetSimulationDataGenerator generator;
+	generator.Initialize( TEST_SAMPLE_RATE, &settings );
+	generator.SetTraffic( 70, 0, 8, seed );
+	generator.SetExplicitTraffic( 16, 24 );
+
+	SimulationChannelDescriptor* channels = NULL;
+	generator.GenerateSimulationData( U64( seconds * TEST_SAMPLE_RATE ), TEST_SAMPLE_RATE, &channels );
+
+	capture.mInitialState = channels->GetInitialBitState();
+	capture.mEdges = channels->GetTransitions();
+	capture.mNumSamples = channels->GetCurrentSampleNumber() + TEST_SAMPLES_PER_BIT * 20;	//end on bus idle
+
+	//the glitches all go in at once: pairs of edges dropped, pulses added, then the edges sorted again.
+	std::mt19937 random( seed );
+	std::vector<bool> dropped( capture.mEdges.size(), false );
+	std::vector<U64> added;
+	for( U32 i = 0; i < num_glitches; i++ )
+	{
+		U64 sample = TEST_SAMPLES_PER_BIT + random() % ( capture.mNumSamples - TEST_SAMPLES_PER_BIT * 10 );
+		U32 kind = random() % 3;
+
+		if( kind == 1 )
+		{
+			U32 edge = random() % ( capture.mEdges.size() - 2 );
+			dropped[ edge ] = true;
+			dropped[ edge + 1 ] = true;
+			continue;
+		}
+
+		U64 length = ( kind == 0 ) ? TEST_SAMPLES_PER_BIT * ( 1 + random() % 8 ) : TEST_SAMPLES_PER_BIT * ( 6 + random() % 8 );
+		added.push_back( sample );
+		added.push_back( sample + length );
+	}
+
+	std::vector<U64> edges = added;
+	for( U32 i = 0; i < capture.mEdges.size(); i++ )
+		if( dropped[ i ] == false )
+			edges.push_back( capture.mEdges[ i ] );
+
+	//an edge twice is no edge at all
+	std::sort( edges.begin(), edges.end() );
+	capture.mEdges.clear();
+	for( U32 i = 0; i < edges.size(); i++ )
+	{
+		if( ( i + 1 < edges.size() ) && ( edges[ i ] == edges[ i + 1 ] ) )
+			i++;
+		else
+			capture.mEdges.push_back( edges[ i ] );
+	}
+
+	if( ( capture.mEdges.size() % 2 ) != 0 )
+		capture.mEdges.pop_back();
+}
+
+void StartCapture( TestCapture& capture )
+{
+	capture.mInitialState = BIT_HIGH;
+	capture.mEdges.clear();
+	capture.mNumSamples = 0;
+	AddIdle( capture, 20 );
+}
+
+void AddBits( TestCapture& capture, const std::vector<U8>& bits )
+{
+	for( U32 i = 0; i < bits.size(); i++ )
+	{
+		//the bus is recessive after an even number of edges
+		U8 bus = ( ( capture.mEdges.size() % 2 ) == 0 ) ? 1 : 0;
+		if( bits[ i ] != bus )
+			capture.mEdges.push_back( capture.mNumSamples );
+
+		capture.mNumSamples += TEST_SAMPLES_PER_BIT;
+	}
+}
+
+void AddIdle( TestCapture& capture, U32 num_bits )
+{
+	AddBits( capture, std::vector<U8>( num_bits, 1 ) );
+}
+
+static void AppendBits( std::vector<U8>& bits, U64 value, U32 num_bits )
+{
+	for( U32 i = num_bits; i > 0; i-- )
+		bits.push_back( U8( ( value >> ( i - 1 ) ) & 1 ) );
+}
+
+//CRC-15 a bit at a time, the way the CAN specification spells it out.
+static U32 ComputeCanCrc( const std::vector<U8>& bits )
+{
+	U32 crc = 0;
+	for( U32 i = 0; i < bits.size(); i++ )
+	{
+		U32 crc_next = bits[ i ] ^ ( ( crc >> 14 ) & 1 );
+		crc = ( crc << 1 ) & CRC_15_MASK;
+		if( crc_next != 0 )
+			crc ^= CRC_15_POLYNOMIAL;
+	}
+
+	return crc;
+}
+
+void EncodeCanFrame( U32 identifier, const std::vector<U8>& data, U32 flags, std::vector<U8>& bits )
+{
+	bool remote = ( ( flags & REMOTE_FRAME ) != 0 );
+
+	//start of frame to the CRC sequence, destuffed
+	std::vector<U8> frame_bits( 1, 0 );
+	if( ( flags & EXTENDED_IDENTIFIER ) != 0 )
+	{
+		AppendBits( frame_bits, identifier >> 18, LENGTH_IDENTIFIER );
+		AppendBits( frame_bits, 3, 2 );		//SRR and IDE
+		AppendBits( frame_bits, identifier & 0x3FFFF, 18 );
+		AppendBits( frame_bits, ( remote == true ) ? 1 : 0, 1 );
+		AppendBits( frame_bits, 0, 2 );		//r1 and r0
+	}
+	else
+	{
+		AppendBits( frame_bits, identifier, LENGTH_IDENTIFIER );
+		AppendBits( frame_bits, ( remote == true ) ? 1 : 0, 1 );
+		AppendBits( frame_bits, 0, 2 );		//IDE and r0
+	}
+
+	AppendBits( frame_bits, data.size(), LENGTH_DATA_LENGTH_CODE );
+	if( remote == false )
+		for( U32 i = 0; i < data.size(); i++ )
+			AppendBits( frame_bits, data[ i ], LENGTH_DATA_BYTE );
+
+	AppendBits( frame_bits, ComputeCanCrc( frame_bits ), LENGTH_CRC_SEQUENCE );
+
+	//a stuff bit after every five identical bits, stuff bits included
+	bits.clear();
+	U8 run_value = 1;
+	U32 run_length = 0;
+	for( U32 i = 0; i < frame_bits.size(); i++ )
+	{
+		bits.push_back( frame_bits[ i ] );
+		run_length = ( frame_bits[ i ] == run_value ) ? run_length + 1 : 1;
+		run_value = frame_bits[ i ];
+
+		if( run_length == 5 )
+		{
+			run_value = 1 - run_value;
+			run_length = 1;
+			bits.push_back( run_value );
+		}
+	}
+
+	bits.push_back( 1 );		//CRC delimiter
+	bits.push_back( ( ( flags & ACK_RECEIVED ) != 0 ) ? 0 : 1 );
+	bits.push_back( 1 );		//ACK delimiter
+	bits.insert( bits.end(), LENGTH_END_OF_FRAME + MIN_VAL_INTERFRAME_SPACE_BITS, 1 );
+}
+
+U64 AddCanFrame( TestCapture& capture, U32 identifier, const std::vector<U8>& data, U32 flags )
+{
+	std::vector<U8> bits;
+	EncodeCanFrame( identifier, data, flags, bits );
+
+	U64 start_of_frame = capture.mNumSamples;
+	AddBits( capture, bits );
+	return start_of_frame;
+}
+
+U64 SendMessage( DeviceNetDecoderListener* listener, U64 start_of_frame, U32 identifier, const std::vector<U8>& data )
+{
+	DeviceNetRecord record;
+	record.mStartingSampleInclusive = start_of_frame;
+	record.mEndingSampleInclusive = start_of_frame + ( 47 + LENGTH_DATA_BYTE * data.size() ) * TEST_SAMPLES_PER_BIT;
+	record.mType = CanMessage;
+	record.mFlags = ACK_RECEIVED;
+	record.mData1 = identifier | ( U64( data.size() ) << COMPACT_DLC_SHIFT ) | ( U64( ACK_RECEIVED ) << COMPACT_FLAGS_SHIFT );
+	record.mData2 = 0;
+	for( U32 i = 0; i < data.size(); i++ )
+		record.mData2 |= U64( data[ i ] ) << ( 56 - 8 * i );
+	listener->OnRecord( record );
+
+	DeviceNetEventInfo info;
+	info.mStartOfFrame = start_of_frame;
+	info.mFlagStart = END_OF_EDGES;
+	listener->OnEventEnd( info );
+
+	return record.mEndingSampleInclusive;
+}
+
+void FillSettings( DeviceNetAnalyzerSettings* settings, BitSampling bit_sampling, ResultDetail result_detail, MarkerPolicy marker_policy, U32 decoder_threads )
+{
+	settings->mDeviceNetChannel = Channel( 0, 0 );
+	settings->mBitRate = TEST_BIT_RATE;
+	settings->mBitSampling = bit_sampling;
+	settings->mResultDetail = result_detail;
+	settings->mMarkerPolicy = marker_policy;
+	settings->mDecoderThreads = decoder_threads;
+}
+
+void Process( DeviceNetAnalyzer& analyzer, const TestCapture& capture, U64 num_edges )
+{
+	std::vector<U64> edges( capture.mEdges.begin(), capture.mEdges.begin() + num_edges );
+	U64 num_samples = ( num_edges == capture.mEdges.size() ) ? capture.mNumSamples : edges.back() + 1;
+
+	AnalyzerChannelData channel_data( capture.mInitialState, edges, num_samples );
+	analyzer.SetAnalyzerChannelData( Channel( 0, 0 ), &channel_data );
+	analyzer.StartProcessing();
+}
+
+void CollectResults( DeviceNetAnalyzer& analyzer, TestResults& results )
+{
+	AnalyzerResults* analyzer_results = analyzer.GetAnalyzerResults();
+
+	results.mFrames.clear();
+	for( U64 i = 0; i < analyzer_results->GetNumFrames(); i++ )
+		results.mFrames.push_back( analyzer_results->GetFrame( i ) );
+
+	results.mPackets.clear();
+	for( U64 i = 0; i < analyzer_results->GetNumPackets(); i++ )
+	{
+		U64 first_frame_id;
+		U64 last_frame_id;
+		analyzer_results->GetFramesContainedInPacket( i, &first_frame_id, &last_frame_id );
+		results.mPackets.push_back( first_frame_id );
+	}
+
+	Channel channel( 0, 0 );
+	results.mMarkers.clear();
+	for( U32 i = 0; i < analyzer_results->GetNumMarkers( channel ); i++ )
+	{
+		results.mMarkers.push_back( analyzer_results->GetMarkerSampleNumber( channel, i ) );
+		results.mMarkers.push_back( analyzer_results->GetMarkerType( channel, i ) );
+	}
+}
+
+void Decode( const TestCapture& capture, BitSampling bit_sampling, ResultDetail result_detail, MarkerPolicy marker_policy, U32 decoder_threads, TestResults& results )
+{
+	DeviceNetAnalyzer analyzer;
+	FillSettings( (DeviceNetAnalyzerSettings*)analyzer.GetAnalyzerSettings(), bit_sampling, result_detail, marker_policy, decoder_threads );
+	analyzer.SetSampleRate( TEST_SAMPLE_RATE );
+
+	Process( analyzer, capture, capture.mEdges.size() );
+	CollectResults( analyzer, results );
+}
+
+std::string CompareResults( const TestResults& expected, const TestResults& results )
+{
+	char text[256];
+
+	for( U64 i = 0; ( i < expected.mFrames.size() ) && ( i < results.mFrames.size() ); i++ )
+	{
+		const Frame& a = expected.mFrames[ i ];
+		const Frame& b = results.mFrames[ i ];
+		if( ( a.mStartingSampleInclusive != b.mStartingSampleInclusive ) || ( a.mEndingSampleInclusive != b.mEndingSampleInclusive ) ||
+			( a.mData1 != b.mData1 ) || ( a.mData2 != b.mData2 ) || ( a.mType != b.mType ) || ( a.mFlags != b.mFlags ) )
+		{
+			snprintf( text, sizeof( text ), "frame %llu differs (sample %lld)", (unsigned long long)i, (long long)a.mStartingSampleInclusive );
+			return text;
+		}
+	}
+
+	if( expected.mFrames.size() != results.mFrames.size() )
+	{
+		snprintf( text, sizeof( text ), "%llu frames instead of %llu", (unsigned long long)results.mFrames.size(), (unsigned long long)expected.mFrames.size() );
+		return text;
+	}
+
+	if( expected.mPackets != results.mPackets )
+		return "packets differ";
+
+	if( expected.mMarkers != results.mMarkers )
+		return "markers differ";
+
+	return "";
+}
+
+std::string ReadExport( DeviceNetAnalyzer& analyzer, U32 export_type )
+{
+	analyzer.GetAnalyzerResults()->GenerateExportFile( TEST_EXPORT_FILE, Hexadecimal, export_type );
+
+	std::string text;
+	FILE* file = fopen( TEST_EXPORT_FILE, "rb" );
+	if( file == NULL )
+		return text;
+
+	char buffer[ 1 << 16 ];
+	size_t num_bytes;
+	while( ( num_bytes = fread( buffer, 1, sizeof( buffer ), file ) ) != 0 )
+		text.append( buffer, num_bytes );
+	fclose( file );
+	remove( TEST_EXPORT_FILE );
+
+	return text;
+}
+
+int main()
+{
+	TestDecoder();
+	TestDestuffer();
+	TestParallelDecoder();
+	TestDecodeCache();
+	TestIdentifierTable();
+	TestExport();
+	TestBinaryExport();
+	TestReassembler();
+	TestConnectionTracker();
+	TestLatency();
+	TestLogExport();
+
+	if( gNumFailures != 0 )
+	{
+		printf( "%u checks failed\n", gNumFailures );
+		return int( std::min( gNumFailures, U32( 255 ) ) );
+	}
+
+	printf( "all tests passed\n" );
+	return 0;
+}
@@ -0,0 +1,82 @@
+#ifndef DEVICENET_TESTS
+#define DEVICENET_TESTS
+
+#include "DeviceNetAnalyzer.h"
+#include "DeviceNetAnalyzerSettings.h"
+#include "DeviceNetDecoder.h"
+#include "DeviceNetProtocol.h"
+
+#include <AnalyzerResults.h>
+
+#include <string>
+#include <vector>
+
+/*	Tests, run headless on the SDK stand-in
+
+	A file per part of the analyzer, each with its Test function below; main (DeviceNetTests.cpp) runs them in turn,
+	and the exit code is the number of failed checks.  The captures come from the simulation data generator, or are
+	put together a CAN frame at a time, with the bits, stuff bits and CRC worked out here rather than by the code
+	under test.  Build and run with build_tests.py.
+*/
+
+#define TEST_SAMPLE_RATE	16000000
+#define TEST_BIT_RATE		BitRate_500K
+#define TEST_SAMPLES_PER_BIT	( TEST_SAMPLE_RATE / TEST_BIT_RATE )
+#define TEST_EXPORT_FILE	"release/DeviceNetTests.export"
+
+//counts a failure, and says what failed, if passed is false.
+bool Check( bool passed, const char* test, const std::string& what );
+
+struct TestCapture
+{
+	BitState mInitialState;
+	std::vector<U64> mEdges;
+	U64 mNumSamples;
+};
+
+struct TestResults
+{
+	std::vector<Frame> mFrames;
+	std::vector<U64> mPackets;		//the first frame of each
+	std::vector<U64> mMarkers;		//sample and type, two entries each
+};
+
+//simulated traffic with explicit messages in fragments, and num_glitches short pulses, dropped edges and error
+//flag length disturbances on top.
+void GenerateCapture( double seconds, U32 num_glitches, U32 seed, TestCapture& capture );
+
+//a capture put together bit by bit: bus idle, then whatever is added, at TEST_BIT_RATE.  Bits are 1 for recessive.
+void StartCapture( TestCapture& capture );
+void AddBits( TestCapture& capture, const std::vector<U8>& bits );
+void AddIdle( TestCapture& capture, U32 num_bits );
+
+//the bits of a CAN frame from the start bit to the end of the intermission, stuffed.  flags are the CanMessage
+//ones: EXTENDED_IDENTIFIER, REMOTE_FRAME (sends data.size() as the DLC, but not the data) and ACK_RECEIVED.
+void EncodeCanFrame( U32 identifier, const std::vector<U8>& data, U32 flags, std::vector<U8>& bits );
+U64 AddCanFrame( TestCapture& capture, U32 identifier, const std::vector<U8>& data, U32 flags );	//returns where the start bit is
+
+//an acknowledged compact message, and the end of its event, to a listener the way the decoder reports them.  Returns
+//where the message ends.
+U64 SendMessage( DeviceNetDecoderListener* listener, U64 start_of_frame, U32 identifier, const std::vector<U8>& data );
+
+void FillSettings( DeviceNetAnalyzerSettings* settings, BitSampling bit_sampling, ResultDetail result_detail, MarkerPolicy marker_policy, U32 decoder_threads );
+void Process( DeviceNetAnalyzer& analyzer, const TestCapture& capture, U64 num_edges );
+void CollectResults( DeviceNetAnalyzer& analyzer, TestResults& results );
+void Decode( const TestCapture& capture, BitSampling bit_sampling, ResultDetail result_detail, MarkerPolicy marker_policy, U32 decoder_threads, TestResults& results );
+std::string CompareResults( const TestResults& expected, const TestResults& results );	//what differs first, or an empty string
+std::string ReadExport( DeviceNetAnalyzer& analyzer, U32 export_type );
+
+//the tests
+void TestDecoder();				//DeviceNetDecoderTests.cpp
+void TestDestuffer();			//DeviceNetDestufferTests.cpp
+void TestParallelDecoder();		//DeviceNetParallelDecoderTests.cpp
+void TestDecodeCache();			//DeviceNetDecodeCacheTests.cpp
+void TestIdentifierTable();		//DeviceNetProtocolTests.cpp
+void TestExport();				//DeviceNetExportTests.cpp
+void TestBinaryExport();		//DeviceNetBinaryExportTests.cpp
+void TestReassembler();			//DeviceNetReassemblerTests.cpp
+void TestConnectionTracker();	//DeviceNetConnectionTrackerTests.cpp
+void TestLatency();				//DeviceNetLatencyTests.cpp
+void TestLogExport();			//DeviceNetLogExportTests.cpp
+
+#endif //DEVICENET_TESTS